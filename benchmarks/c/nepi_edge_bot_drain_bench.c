@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+
+/* Export -> bot drain throughput against nepi_edge_bot_sim (built alongside this benchmark and found next to it).
+ * A throwaway bot tree is created under work_dir (default /tmp) with the simulator as its botmain and a config with
+ * one LB link (ip or iridium) and HB over IP, both modeled without sleeping. The benchmark exports statuses with
+ * snippets and attached files, general DO messages and HB files, runs the bot once and reads the execution status
+ * back through the SDK. Usage: nepi_edge_bot_drain_bench [exports] [ip|iridium] [work_dir] */
+#define _XOPEN_SOURCE 700 // nftw(), realpath()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ftw.h>
+#include <libgen.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "nepi_edge_sdk_link.h"
+#include "nepi_edge_lb_interface.h"
+#include "nepi_edge_hb_interface.h"
+
+#define ATTACHMENT_SIZE       (4 * 1024)
+#define GENERAL_PAYLOAD_SIZE  1024
+#define HB_FILE_SIZE          (64 * 1024)
+#define BENCH_EPOCH_NS        1704067200000000000LL // 2024-01-01T00:00:00Z
+#define BOT_TIMEOUT_S         86400 // Long enough that the modeled link never cuts a run short
+
+static const char *bench_config =
+  "{\n"
+  "    \"sim_time_scale\": 0,\n"
+  "    \"lb_iridium\": {\"enabled\": 1, \"type\": \"iridium\", \"open_tout\": 1, \"packet_size\": 340},\n"
+  "    \"lb_ip\": {\"enabled\": 1, \"type\": \"ethernet\", \"open_tout\": 1, \"packet_size\": 1500},\n"
+  "    \"hb_ip\": {\"enabled\": 1, \"type\": \"ethernet\", \"open_tout\": 1, \"packet_size\": 1500},\n"
+  "    \"lb_conn_order\": [\"%s\"],\n"
+  "    \"hb_conn_order\": [\"hb_ip\"]\n"
+  "}\n";
+
+static double elapsed_s(const struct timespec *start, const struct timespec *stop)
+{
+  return (stop->tv_sec - start->tv_sec) + ((stop->tv_nsec - start->tv_nsec) / 1e9);
+}
+
+// Paths under the bench tree. The work dir comes from the command line, so one too long for them ends the run
+// rather than being silently truncated.
+static void tree_path(char *path, size_t size, const char *dir, const char *name)
+{
+  if (snprintf(path, size, "%s/%s", dir, name) >= (int)size)
+  {
+    printf("Path too long: %s/%s\n", dir, name);
+    exit(1);
+  }
+}
+
+static int write_file(const char *path, const void *contents, size_t len)
+{
+  FILE *f = fopen(path, "w");
+  if (NULL == f) return -1;
+  const size_t written = fwrite(contents, 1, len, f);
+  return ((0 == fclose(f)) && (written == len))? 0 : -1;
+}
+
+// nftw() has no user data argument
+static size_t tree_bytes;
+static size_t tree_files;
+
+static int count_entry(const char *path, const struct stat *sb, int type, struct FTW *ftwbuf)
+{
+  (void)path; (void)ftwbuf;
+  if (FTW_F == type)
+  {
+    tree_bytes += (size_t)sb->st_size;
+    ++tree_files;
+  }
+  return 0;
+}
+
+static void count_tree(const char *base, const char *sub)
+{
+  char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s/%s", base, sub);
+  nftw(path, count_entry, 16, 0); // Follows the hb/do/data link
+}
+
+static int remove_entry(const char *path, const struct stat *sb, int type, struct FTW *ftwbuf)
+{
+  (void)sb; (void)type; (void)ftwbuf;
+  return remove(path);
+}
+
+int main(int argc, char **argv)
+{
+  const long exports = (argc > 1)? atol(argv[1]) : 1000;
+  const char *link = (argc > 2)? argv[2] : "ip";
+  const char *work_dir = (argc > 3)? argv[3] : "/tmp";
+  if ((exports <= 0) || ((0 != strcmp(link, "ip")) && (0 != strcmp(link, "iridium"))))
+  {
+    printf("Usage: %s [exports] [ip|iridium] [work_dir]\n", argv[0]);
+    return 1;
+  }
+
+  char sim_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  char self_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  snprintf(self_path, sizeof(self_path), "%s", argv[0]);
+  snprintf(sim_path, sizeof(sim_path), "%s/nepi_edge_bot_sim", dirname(self_path));
+  char sim_real_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  if (NULL == realpath(sim_path, sim_real_path))
+  {
+    printf("Can't find the simulator at %s\n", sim_path);
+    return 1;
+  }
+
+  // Bot tree: SetBotBaseFilePath creates the lb/hb folders but needs a NUID; the rest is for the simulator
+  char base[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  tree_path(base, sizeof(base), work_dir, "nepi_bot_drain_XXXXXX");
+  if (NULL == mkdtemp(base))
+  {
+    printf("Can't create a folder under %s\n", work_dir);
+    return 1;
+  }
+  const char *folders[] = {"devinfo", "cfg", "cfg/bot", "bin", "bin/botmain", "log", "hb_source"};
+  char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  for (size_t i = 0; i < sizeof(folders) / sizeof(folders[0]); ++i)
+  {
+    tree_path(path, sizeof(path), base, folders[i]);
+    mkdir(path, S_IRWXU);
+  }
+  tree_path(path, sizeof(path), base, "devinfo/devnuid.txt");
+  write_file(path, "0000000001\n", 11);
+  char config[1024];
+  const int config_len = snprintf(config, sizeof(config), bench_config, (0 == strcmp(link, "ip"))? "lb_ip" : "lb_iridium");
+  tree_path(path, sizeof(path), base, "cfg/bot/config.json");
+  write_file(path, config, config_len);
+  tree_path(path, sizeof(path), base, "bin/botmain/botmain");
+  if (0 != symlink(sim_real_path, path))
+  {
+    printf("Can't link the simulator into %s\n", base);
+    return 1;
+  }
+  if (NEPI_EDGE_RET_OK != NEPI_EDGE_SetBotBaseFilePath(base))
+  {
+    printf("Can't set up a bot tree in %s\n", base);
+    return 1;
+  }
+  char hb_source[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  tree_path(hb_source, sizeof(hb_source), base, "hb_source");
+  NEPI_EDGE_HBLinkDataFolder(hb_source);
+
+  uint8_t *payload = malloc(HB_FILE_SIZE);
+  for (size_t i = 0; i < HB_FILE_SIZE; ++i) payload[i] = (uint8_t)(i * 131);
+  char attachment[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  tree_path(attachment, sizeof(attachment), base, "attachment.bin");
+  write_file(attachment, payload, ATTACHMENT_SIZE);
+
+  struct timespec start, stop;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_RET_OK;
+  for (long i = 0; (i < exports) && (NEPI_EDGE_RET_OK == ret); ++i)
+  {
+    NEPI_EDGE_LB_Status_t status;
+    NEPI_EDGE_LBStatusCreateNs(&status, BENCH_EPOCH_NS + (i * 1000000000LL));
+    NEPI_EDGE_LBStatusSetLatitude(status, 47.6f);
+    NEPI_EDGE_LBStatusSetLongitude(status, -122.3f);
+
+    NEPI_EDGE_LB_Data_Snippet_t snippets[2];
+    NEPI_EDGE_LBDataSnippetCreate(&snippets[0], "cam", 0);
+    NEPI_EDGE_LBDataSnippetSetScores(snippets[0], 0.9f, 0.8f, 0.7f);
+    NEPI_EDGE_LBDataSnippetSetDataFile(snippets[0], attachment, 0);
+    NEPI_EDGE_LBDataSnippetCreate(&snippets[1], "det", 0);
+    NEPI_EDGE_LBDataSnippetSetScores(snippets[1], 0.6f, 0.5f, 0.4f);
+    ret = NEPI_EDGE_LBExportData(status, snippets, 2);
+    NEPI_EDGE_LBDataSnippetDestroy(snippets[0]);
+    NEPI_EDGE_LBDataSnippetDestroy(snippets[1]);
+    NEPI_EDGE_LBStatusDestroy(status);
+
+    if ((NEPI_EDGE_RET_OK == ret) && (0 == (i % 4)))
+    {
+      NEPI_EDGE_LB_General_t general;
+      NEPI_EDGE_LBGeneralCreate(&general);
+      NEPI_EDGE_LBGeneralSetPayloadIntBytes(general, (uint32_t)i, payload, GENERAL_PAYLOAD_SIZE);
+      ret = NEPI_EDGE_LBExportGeneral(general);
+      NEPI_EDGE_LBGeneralDestroy(general);
+    }
+    if ((NEPI_EDGE_RET_OK == ret) && (0 == (i % 16)))
+    {
+      char hb_name[32];
+      snprintf(hb_name, sizeof(hb_name), "hb_%06ld.bin", i);
+      tree_path(path, sizeof(path), hb_source, hb_name);
+      if (0 != write_file(path, payload, HB_FILE_SIZE)) ret = NEPI_EDGE_RET_FILE_WRITE_ERROR;
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  if (NEPI_EDGE_RET_OK != ret)
+  {
+    printf("Export failed with %d\n", ret);
+    return 1;
+  }
+  const double export_s = elapsed_s(&start, &stop);
+
+  tree_bytes = tree_files = 0;
+  count_tree(base, NEPI_EDGE_LB_DATA_FOLDER_PATH);
+  count_tree(base, NEPI_EDGE_LB_GENERAL_DO_FOLDER_PATH);
+  count_tree(base, NEPI_EDGE_HB_DO_DATA_FOLDER_PATH);
+  const size_t queued_bytes = tree_bytes;
+  const size_t queued_files = tree_files;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  ret = NEPI_EDGE_StartBot(1, BOT_TIMEOUT_S, 1, BOT_TIMEOUT_S);
+  if (NEPI_EDGE_RET_OK == ret) ret = NEPI_EDGE_WaitBot(-1);
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  if (NEPI_EDGE_RET_OK != ret)
+  {
+    printf("Bot run failed with %d\n", ret);
+    return 1;
+  }
+  const double drain_s = elapsed_s(&start, &stop);
+
+  tree_bytes = tree_files = 0;
+  count_tree(base, NEPI_EDGE_LB_DATA_FOLDER_PATH);
+  count_tree(base, NEPI_EDGE_LB_GENERAL_DO_FOLDER_PATH);
+  count_tree(base, NEPI_EDGE_HB_DO_DATA_FOLDER_PATH);
+
+  NEPI_EDGE_Exec_Status_t exec_status;
+  NEPI_EDGE_ExecStatusCreate(&exec_status);
+  NEPI_EDGE_ImportExecStatus(exec_status);
+  size_t lb_counts = 0, hb_counts = 0;
+  size_t msgs_sent = 0, pkts_sent = 0, msgs_rcvd = 0, hb_sent_kB = 0, hb_rcvd_kB = 0;
+  NEPI_EDGE_ExecStatusGetCounts(exec_status, &lb_counts, &hb_counts);
+  if (lb_counts > 0) NEPI_EDGE_ExecStatusGetLBCommsStatistics(exec_status, 0, &msgs_sent, &pkts_sent, &msgs_rcvd);
+  if (hb_counts > 0) NEPI_EDGE_ExecStatusGetHBCommsStatistics(exec_status, 0, &hb_sent_kB, &hb_rcvd_kB);
+  NEPI_EDGE_ExecStatusDestroy(exec_status);
+
+  printf("%ld exports over lb_%s, bot tree in %s\n", exports, link, base);
+  printf("export:  %zu files, %.1f KiB in %.3f s (%.0f exports/s)\n", queued_files, queued_bytes / 1024.0, export_s,
+         exports / export_s);
+  printf("drain:   %.3f s including bot startup (%.1f MiB/s, %.0f files/s)\n", drain_s, queued_bytes / drain_s / (1024.0 * 1024.0),
+         (queued_files - tree_files) / drain_s);
+  printf("status:  LB %zu msgs / %zu pkts sent, %zu msgs received; HB %zu kB sent\n", msgs_sent, pkts_sent, msgs_rcvd,
+         hb_sent_kB);
+
+  int status = 0;
+  if ((0 != tree_files) || (0 == lb_counts) || (0 == hb_counts))
+  {
+    printf("Expected a complete drain with LB and HB status, found %zu files left and %zu/%zu status entries\n", tree_files,
+           lb_counts, hb_counts);
+    status = 1;
+  }
+
+  NEPI_EDGE_HBUnlinkDataFolder();
+  nftw(base, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+  free(payload);
+  return status;
+}
@@ -0,0 +1,631 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+
+/* NEPI-BOT stand-in for benchmarking the SDK end to end without link hardware. Install (or symlink) it as
+ * <bot base>/bin/botmain/botmain; the SDK runs it from that folder.
+ *
+ * Each run drains what the SDK exported over a modeled link:
+ *   LB: lb/data (status folders, oldest first) then lb/do-msg, uplink; lb/cfg and lb/dt-msg files, downlink
+ *   HB: everything under hb/do/data, uplink
+ * Sent files are deleted. Links are tried in lb_conn_order / hb_conn_order from cfg/bot/config.json, skipping
+ * disabled ones, and each costs open_tout seconds to connect plus ceil(bytes / packet_size) packets per file at the
+ * link's rate. A file that doesn't fit in the rest of the LB/HB_PROC_TIMEOUT window stays for the next run. The
+ * counts, bytes and the modeled session times are written to log/lb_execution_status.json and
+ * log/hb_execution_status.json in the format the real bot uses, so NEPI_EDGE_ImportExecStatus reads them back.
+ *
+ * Optional config.json keys, all ignored by the real bot:
+ *   per link:  "sim_rate_bps" (default by "type": iridium 2400, ethernet 10e6, rs232 "baud"),
+ *              "sim_fail_ratio" (0-1, chance each connection attempt fails; default 0)
+ *   top level: "sim_time_scale" (real seconds slept per modeled second; default 0, i.e. no sleeping),
+ *              "sim_cfg_per_run" / "sim_dt_per_run" (downlink files per LB session; default 1 each),
+ *              "sim_dt_bytes" (payload bytes per dt-msg; default 32)
+ *
+ * Launched with NEPI_BOT_RESIDENT=1, it serves runs triggered over NEPI_BOT_TRIGGER_FD as described for the SDK's
+ * resident bot API. SIGINT ends the current session early (reported as an error in its status), and the process. */
+#define _GNU_SOURCE // nftw() FTW_ACTIONRETVAL, realpath()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <ftw.h>
+#include <errno.h>
+#include <signal.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+
+#include "nepi_edge_sdk_link.h"
+#include "frozen/frozen.h"
+
+#define SIM_BASE_PATH          "../.." // The SDK launches the bot in <bot base>/bin/botmain
+#define SIM_BOT_CONFIG_PATH    SIM_BASE_PATH "/cfg/bot/config.json"
+#define SIM_MAX_LINKS          8
+#define SIM_MAX_NAME_LENGTH    32
+#define SIM_MAX_ERRORS         2
+#define SIM_RESIDENT_MSG_SIZE  256
+
+typedef struct
+{
+  char name[SIM_MAX_NAME_LENGTH]; // e.g., lb_iridium
+  int enabled;
+  int packet_size;
+  double rate_bps;
+  double open_s;
+  double fail_ratio;
+} Sim_Link_t;
+
+typedef struct
+{
+  double time_scale;
+  int cfg_per_run;
+  int dt_per_run;
+  int dt_bytes;
+  Sim_Link_t lb_links[SIM_MAX_LINKS];
+  int lb_link_count;
+  Sim_Link_t hb_links[SIM_MAX_LINKS];
+  int hb_link_count;
+} Sim_Config_t;
+
+// One connection attempt, as it goes into the execution status
+typedef struct
+{
+  const Sim_Link_t *link;
+  const char *status; // "success", "connfailed" or "disabled"
+  struct timespec start_time;
+  double session_s; // Modeled
+  double timeout_s;
+  uint64_t packets_sent;
+  uint64_t bytes_sent;
+  uint64_t bytes_received;
+  uint32_t stat_sent;
+  uint32_t data_sent;
+  uint32_t gen_sent;
+  uint32_t cfg_received;
+  uint32_t gen_received;
+  uint32_t dirs_sent;
+  uint32_t files_sent;
+  const char *errors[SIM_MAX_ERRORS];
+  int error_count;
+} Sim_Session_t;
+
+static volatile sig_atomic_t stop_requested = 0;
+static unsigned int rand_state;
+static uint32_t downlink_sequence = 0;
+
+static void handle_stop_signal(int sig)
+{
+  (void)sig;
+  stop_requested = 1;
+}
+
+static double default_rate_bps(const char *type, int baud)
+{
+  if (0 == strcmp(type, "iridium")) return 2400.0; // SBD throughput, well below the modem's serial rate
+  if (0 == strcmp(type, "rs232")) return (baud > 0)? baud : 9600.0;
+  return 10e6;
+}
+
+static void read_link(const char *json, int json_len, const char *name, Sim_Link_t *link)
+{
+  memset(link, 0, sizeof(Sim_Link_t));
+  snprintf(link->name, SIM_MAX_NAME_LENGTH, "%s", name);
+  link->packet_size = 1500;
+  link->open_s = 1.0;
+
+  char fmt[64];
+  struct json_token block = {NULL, 0, JSON_TYPE_INVALID};
+  snprintf(fmt, sizeof(fmt), "{%s: %%T}", name);
+  json_scanf(json, json_len, fmt, &block);
+  if (NULL == block.ptr) return; // Listed in the order but not configured: stays disabled
+
+  char *type = NULL;
+  int baud = 0;
+  int open_tout = 1;
+  link->rate_bps = -1.0;
+  json_scanf(block.ptr, block.len, "{enabled: %d, type: %Q, baud: %d, packet_size: %d, open_tout: %d, sim_rate_bps: %lf, "
+             "sim_fail_ratio: %lf}", &(link->enabled), &type, &baud, &(link->packet_size), &open_tout, &(link->rate_bps),
+             &(link->fail_ratio));
+  if (link->rate_bps <= 0.0) link->rate_bps = default_rate_bps((NULL != type)? type : "", baud);
+  if (link->packet_size <= 0) link->packet_size = 1500;
+  link->open_s = (open_tout > 0)? open_tout : 0.0;
+  free(type);
+}
+
+static int read_link_order(const char *json, int json_len, const char *order_path, Sim_Link_t *links)
+{
+  int count = 0;
+  struct json_token name_token;
+  while ((count < SIM_MAX_LINKS) && (json_scanf_array_elem(json, json_len, order_path, count, &name_token) > 0))
+  {
+    char name[SIM_MAX_NAME_LENGTH];
+    const int name_len = (name_token.len < SIM_MAX_NAME_LENGTH)? name_token.len : (SIM_MAX_NAME_LENGTH - 1);
+    memcpy(name, name_token.ptr, name_len);
+    name[name_len] = '\0';
+    read_link(json, json_len, name, &links[count++]);
+  }
+  return count;
+}
+
+static int read_config(Sim_Config_t *config)
+{
+  memset(config, 0, sizeof(Sim_Config_t));
+  config->cfg_per_run = 1;
+  config->dt_per_run = 1;
+  config->dt_bytes = 32;
+
+  char *json = json_fread(SIM_BOT_CONFIG_PATH);
+  if (NULL == json)
+  {
+    fprintf(stderr, "*** NEPI-BOT Simulator: can't read %s ***\n", SIM_BOT_CONFIG_PATH);
+    return -1;
+  }
+  const int json_len = (int)strlen(json);
+  json_scanf(json, json_len, "{sim_time_scale: %lf, sim_cfg_per_run: %d, sim_dt_per_run: %d, sim_dt_bytes: %d}",
+             &(config->time_scale), &(config->cfg_per_run), &(config->dt_per_run), &(config->dt_bytes));
+  config->lb_link_count = read_link_order(json, json_len, ".lb_conn_order", config->lb_links);
+  config->hb_link_count = read_link_order(json, json_len, ".hb_conn_order", config->hb_links);
+  free(json);
+  return 0;
+}
+
+// Let modeled time pass in real time too, if configured; 0 if a stop signal cut it short
+static int model_delay(const Sim_Config_t *config, double modeled_s)
+{
+  if (config->time_scale > 0.0)
+  {
+    const double sleep_s = modeled_s * config->time_scale;
+    struct timespec nap = {(time_t)sleep_s, (long)(fmod(sleep_s, 1.0) * 1e9)};
+    while ((0 != nanosleep(&nap, &nap)) && (EINTR == errno) && (0 == stop_requested)) {}
+  }
+  return (0 == stop_requested)? 1 : 0;
+}
+
+// Charge one transfer to the session; 0 if it doesn't fit in what's left of the window
+static int spend(const Sim_Config_t *config, Sim_Session_t *session, uint64_t bytes, uint8_t uplink)
+{
+  if (0 != stop_requested) return 0;
+
+  const uint64_t packet_size = (uint64_t)session->link->packet_size;
+  const uint64_t packets = (0 == bytes)? 1 : ((bytes + packet_size - 1) / packet_size);
+  const double transfer_s = (packets * packet_size * 8.0) / session->link->rate_bps;
+  if (session->session_s + transfer_s > session->timeout_s) return 0;
+  if (0 == model_delay(config, transfer_s)) return 0;
+
+  session->session_s += transfer_s;
+  if (0 != uplink)
+  {
+    session->packets_sent += packets;
+    session->bytes_sent += bytes;
+  }
+  else
+  {
+    session->bytes_received += bytes;
+  }
+  return 1;
+}
+
+static int compare_names(const void *a, const void *b)
+{
+  return strcmp(*(char *const*)a, *(char *const*)b);
+}
+
+// Sorted names of the visible entries of a folder; the SDK stages exports under dot-prefixed names
+static char** list_folder(const char *path, size_t *count)
+{
+  *count = 0;
+  DIR *dir = opendir(path);
+  if (NULL == dir) return NULL;
+
+  char **names = NULL;
+  size_t capacity = 0;
+  struct dirent *entry;
+  while (NULL != (entry = readdir(dir)))
+  {
+    if ('.' == entry->d_name[0]) continue;
+    if (*count == capacity)
+    {
+      capacity = (0 == capacity)? 64 : (2 * capacity);
+      char **grown = realloc(names, capacity * sizeof(char*));
+      if (NULL == grown) break;
+      names = grown;
+    }
+    names[(*count)++] = strdup(entry->d_name);
+  }
+  closedir(dir);
+
+  if (*count > 1) qsort(names, *count, sizeof(char*), compare_names);
+  return names;
+}
+
+static void free_list(char **names, size_t count)
+{
+  for (size_t i = 0; i < count; ++i) free(names[i]);
+  free(names);
+}
+
+// Send and delete one file; 0 once the window is used up
+static int send_file(const Sim_Config_t *config, Sim_Session_t *session, const char *path, uint32_t *counter)
+{
+  struct stat st;
+  if ((0 != stat(path, &st)) || !S_ISREG(st.st_mode)) return 1; // Gone or not a file; nothing to send
+  if (0 == spend(config, session, (uint64_t)st.st_size, 1)) return 0;
+
+  unlink(path);
+  ++(*counter);
+  return 1;
+}
+
+static int send_lb_data(const Sim_Config_t *config, Sim_Session_t *session)
+{
+  const char *data_path = SIM_BASE_PATH "/" NEPI_EDGE_LB_DATA_FOLDER_PATH;
+  size_t export_count;
+  char **exports = list_folder(data_path, &export_count);
+  int more_time = 1;
+  for (size_t i = 0; (1 == more_time) && (i < export_count); ++i)
+  {
+    char export_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+    snprintf(export_path, sizeof(export_path), "%s/%s", data_path, exports[i]);
+
+    // Status first, then its data snippets and attached files
+    size_t file_count;
+    char **files = list_folder(export_path, &file_count);
+    char file_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+    if (snprintf(file_path, sizeof(file_path), "%s/%s", export_path, NEPI_EDGE_LB_STATUS_FILENAME) < (int)sizeof(file_path))
+    {
+      more_time = send_file(config, session, file_path, &(session->stat_sent));
+    }
+    for (size_t j = 0; (1 == more_time) && (j < file_count); ++j)
+    {
+      if (0 == strcmp(files[j], NEPI_EDGE_LB_STATUS_FILENAME)) continue;
+      // Nothing the SDK exports has a path this long
+      if (snprintf(file_path, sizeof(file_path), "%s/%s", export_path, files[j]) >= (int)sizeof(file_path)) continue;
+      more_time = send_file(config, session, file_path, &(session->data_sent));
+    }
+    free_list(files, file_count);
+
+    if (1 == more_time) rmdir(export_path);
+  }
+  free_list(exports, export_count);
+  return more_time;
+}
+
+static int send_lb_general(const Sim_Config_t *config, Sim_Session_t *session)
+{
+  const char *do_path = SIM_BASE_PATH "/" NEPI_EDGE_LB_GENERAL_DO_FOLDER_PATH;
+  size_t file_count;
+  char **files = list_folder(do_path, &file_count);
+  int more_time = 1;
+  for (size_t i = 0; (1 == more_time) && (i < file_count); ++i)
+  {
+    char file_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+    snprintf(file_path, sizeof(file_path), "%s/%s", do_path, files[i]);
+    more_time = send_file(config, session, file_path, &(session->gen_sent));
+  }
+  free_list(files, file_count);
+  return more_time;
+}
+
+// Write a downlink file the way the real bot does: complete under a hidden name, then renamed into place
+static int receive_file(const Sim_Config_t *config, Sim_Session_t *session, const char *folder, const char *prefix,
+                        const char *contents, uint32_t *counter)
+{
+  const size_t len = strlen(contents);
+  if (0 == spend(config, session, len, 0)) return 0;
+
+  char tmp_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  snprintf(tmp_path, sizeof(tmp_path), "%s/%s/.%s_%d_%u.json", SIM_BASE_PATH, folder, prefix, (int)getpid(), downlink_sequence);
+  snprintf(path, sizeof(path), "%s/%s/%s_%d_%u.json", SIM_BASE_PATH, folder, prefix, (int)getpid(), downlink_sequence);
+  ++downlink_sequence;
+
+  FILE *f = fopen(tmp_path, "w");
+  if (NULL == f) return 1;
+  const int written = (len == fwrite(contents, 1, len, f));
+  if ((0 != fclose(f)) || !written || (0 != rename(tmp_path, path)))
+  {
+    unlink(tmp_path);
+    return 1;
+  }
+  ++(*counter);
+  return 1;
+}
+
+static int receive_lb(const Sim_Config_t *config, Sim_Session_t *session)
+{
+  char contents[4096];
+  int more_time = 1;
+  for (int i = 0; (1 == more_time) && (i < config->cfg_per_run); ++i)
+  {
+    snprintf(contents, sizeof(contents),
+             "{\n   \"params\":[\n"
+             "      {\"identifier\":\"sim_packet_size\",\"value\":%d},\n"
+             "      {\"identifier\":\"sim_rate_bps\",\"value\":%.1f},\n"
+             "      {\"identifier\":\"sim_downlink_seq\",\"value\":%u},\n"
+             "      {\"identifier\":\"sim_throttle\",\"value\":%s}\n"
+             "   ]\n}\n",
+             session->link->packet_size, session->link->rate_bps, downlink_sequence,
+             (session->link->rate_bps < 1e5)? "true" : "false");
+    more_time = receive_file(config, session, NEPI_EDGE_LB_CONFIG_FOLDER_PATH, "sim_cfg", contents, &(session->cfg_received));
+  }
+  for (int i = 0; (1 == more_time) && (i < config->dt_per_run); ++i)
+  {
+    int pos = snprintf(contents, sizeof(contents), "{\n    \"identifier\":\"sim_dt\",\n    \"value\":[");
+    const int dt_bytes = (config->dt_bytes < 512)? config->dt_bytes : 512;
+    for (int b = 0; b < dt_bytes; ++b)
+    {
+      pos += snprintf(contents + pos, sizeof(contents) - pos, "%s%u", (0 == b)? "" : ", ", (unsigned)((downlink_sequence + b) & 0xFF));
+    }
+    snprintf(contents + pos, sizeof(contents) - pos, "]\n}\n");
+    more_time = receive_file(config, session, NEPI_EDGE_LB_GENERAL_DT_FOLDER_PATH, "sim_dt_msg", contents,
+                             &(session->gen_received));
+  }
+  return more_time;
+}
+
+// nftw() has no user data argument
+static const Sim_Config_t *hb_walk_config;
+static Sim_Session_t *hb_walk_session;
+
+static int send_hb_entry(const char *path, const struct stat *st, int type, struct FTW *ftw)
+{
+  if (0 == ftw->level) return FTW_CONTINUE; // The linked folder itself stays
+
+  if (FTW_F == type)
+  {
+    if (0 == spend(hb_walk_config, hb_walk_session, (uint64_t)st->st_size, 1)) return FTW_STOP;
+    unlink(path);
+    ++(hb_walk_session->files_sent);
+  }
+  else if ((FTW_DP == type) && (0 == rmdir(path)))
+  {
+    ++(hb_walk_session->dirs_sent);
+  }
+  return FTW_CONTINUE;
+}
+
+static int send_hb_data(const Sim_Config_t *config, Sim_Session_t *session)
+{
+  // hb/do/data is normally a symlink to the host's folder
+  char data_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  if (NULL == realpath(SIM_BASE_PATH "/" NEPI_EDGE_HB_DO_DATA_FOLDER_PATH, data_path)) return 1;
+
+  hb_walk_config = config;
+  hb_walk_session = session;
+  return (FTW_STOP == nftw(data_path, send_hb_entry, 16, FTW_DEPTH | FTW_PHYS | FTW_ACTIONRETVAL))? 0 : 1;
+}
+
+// Try each link in order until one connects, then run the whole session over it
+static int run_link(const Sim_Config_t *config, const Sim_Link_t *links, int link_count, double timeout_s,
+                    int (*transfer)(const Sim_Config_t*, Sim_Session_t*), Sim_Session_t *sessions)
+{
+  int session_count = 0;
+  double used_s = 0.0;
+  for (int i = 0; i < link_count; ++i)
+  {
+    Sim_Session_t *session = &sessions[session_count++];
+    memset(session, 0, sizeof(Sim_Session_t));
+    session->link = &links[i];
+    clock_gettime(CLOCK_REALTIME, &(session->start_time));
+    if (0 == links[i].enabled)
+    {
+      session->status = "disabled";
+      continue;
+    }
+
+    session->timeout_s = timeout_s - used_s;
+    session->session_s = (links[i].open_s < session->timeout_s)? links[i].open_s : session->timeout_s;
+    const int connected = model_delay(config, session->session_s) && (links[i].open_s <= session->timeout_s) &&
+                          ((double)rand_r(&rand_state) / RAND_MAX >= links[i].fail_ratio);
+    if (0 == connected)
+    {
+      session->status = "connfailed";
+      used_s += session->session_s;
+      if ((used_s >= timeout_s) || (0 != stop_requested)) break;
+      continue;
+    }
+
+    session->status = "success";
+    if (0 == transfer(config, session))
+    {
+      session->errors[session->error_count++] = (0 != stop_requested)? "connection terminated by signal" :
+                                                                        "timed out with data remaining";
+    }
+    break;
+  }
+  return session_count;
+}
+
+static int transfer_lb(const Sim_Config_t *config, Sim_Session_t *session)
+{
+  return send_lb_data(config, session) && send_lb_general(config, session) && receive_lb(config, session);
+}
+
+static int transfer_hb(const Sim_Config_t *config, Sim_Session_t *session)
+{
+  return send_hb_data(config, session);
+}
+
+static void format_time(const struct timespec *base, double offset_s, char *buf, size_t buf_size)
+{
+  const double t = base->tv_sec + (base->tv_nsec / 1e9) + offset_s;
+  const time_t seconds = (time_t)t;
+  struct tm utc;
+  gmtime_r(&seconds, &utc);
+  const size_t len = strftime(buf, buf_size, "%Y-%m-%dT%H:%M:%S", &utc);
+  snprintf(buf + len, buf_size - len, ".%06ld", (long)((t - seconds) * 1e6));
+}
+
+static void write_errors(FILE *f, const Sim_Session_t *session)
+{
+  if (0 == session->error_count) return;
+  fprintf(f, ",\n         \"errors\":[\n");
+  for (int e = 0; e < session->error_count; ++e)
+  {
+    fprintf(f, "            \"%s\"%s\n", session->errors[e], (e + 1 < session->error_count)? "," : "");
+  }
+  fprintf(f, "         ]");
+}
+
+static void write_status_file(const char *file_path, const Sim_Session_t *sessions, int session_count, uint8_t hb)
+{
+  char tmp_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  snprintf(tmp_path, sizeof(tmp_path), "%s/%s.tmp", SIM_BASE_PATH, file_path);
+  snprintf(path, sizeof(path), "%s/%s", SIM_BASE_PATH, file_path);
+  FILE *f = fopen(tmp_path, "w");
+  if (NULL == f) return;
+
+  fprintf(f, "{\n   \"connections\":[");
+  for (int i = 0; i < session_count; ++i)
+  {
+    const Sim_Session_t *s = &sessions[i];
+    fprintf(f, "%s\n      {\n         \"comms_type\":\"%s\",\n         \"status\":\"%s\"", (0 == i)? "" : ",",
+            s->link->name, s->status);
+    if (0 == strcmp(s->status, "disabled"))
+    {
+      fprintf(f, "\n      }");
+      continue;
+    }
+
+    char time_start[NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH];
+    char time_stop[NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH];
+    format_time(&(s->start_time), 0.0, time_start, sizeof(time_start));
+    format_time(&(s->start_time), s->session_s, time_stop, sizeof(time_stop));
+    if (0 != hb) fprintf(f, ",\n         \"dtype\":\"do\"");
+    fprintf(f, ",\n         \"timestart\":\"%s\",\n         \"timestop\":\"%s\"", time_start, time_stop);
+    if (0 == hb)
+    {
+      fprintf(f, ",\n         \"msgsent\":%u,\n         \"pktsent\":%llu,\n         \"statsent\":%u,\n         \"datasent\":%u,"
+              "\n         \"gensent\":%u,\n         \"msgrecv\":%u,\n         \"cfgrecv\":%u,\n         \"genrecv\":%u",
+              s->stat_sent + s->data_sent + s->gen_sent, (unsigned long long)s->packets_sent, s->stat_sent, s->data_sent,
+              s->gen_sent, s->cfg_received + s->gen_received, s->cfg_received, s->gen_received);
+    }
+    else
+    {
+      fprintf(f, ",\n         \"datasent_kB\":%llu,\n         \"datarecv_kB\":%llu,\n         \"numdirs\":%u,\n"
+              "         \"numfiles\":%u", (unsigned long long)((s->bytes_sent + 1023) / 1024),
+              (unsigned long long)((s->bytes_received + 1023) / 1024), s->dirs_sent, s->files_sent);
+    }
+    write_errors(f, s);
+    fprintf(f, "\n      }");
+  }
+  fprintf(f, "\n   ]\n}\n");
+
+  if (0 == fclose(f)) rename(tmp_path, path);
+  else unlink(tmp_path);
+}
+
+static void print_summary(const char *label, const Sim_Session_t *sessions, int session_count)
+{
+  for (int i = 0; i < session_count; ++i)
+  {
+    const Sim_Session_t *s = &sessions[i];
+    if (0 != strcmp(s->status, "success")) continue;
+    printf("***   %s over %s: %llu B up, %llu B down in %.2f modeled s%s ***\n", label, s->link->name,
+           (unsigned long long)s->bytes_sent, (unsigned long long)s->bytes_received, s->session_s,
+           (s->error_count > 0)? " (incomplete)" : "");
+  }
+}
+
+static void run_once(const Sim_Config_t *config, unsigned run_lb, unsigned lb_timeout_s, unsigned run_hb, unsigned hb_timeout_s)
+{
+  char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s/%s", SIM_BASE_PATH, NEPI_EDGE_LB_EXEC_STAT_FILE_PATH);
+  unlink(path);
+  snprintf(path, sizeof(path), "%s/%s", SIM_BASE_PATH, NEPI_EDGE_HB_EXEC_STAT_FILE_PATH);
+  unlink(path);
+
+  Sim_Session_t sessions[SIM_MAX_LINKS];
+  if (0 != run_lb)
+  {
+    const int count = run_link(config, config->lb_links, config->lb_link_count, lb_timeout_s, transfer_lb, sessions);
+    write_status_file(NEPI_EDGE_LB_EXEC_STAT_FILE_PATH, sessions, count, 0);
+    print_summary("LB", sessions, count);
+  }
+  if (0 != run_hb)
+  {
+    const int count = run_link(config, config->hb_links, config->hb_link_count, hb_timeout_s, transfer_hb, sessions);
+    write_status_file(NEPI_EDGE_HB_EXEC_STAT_FILE_PATH, sessions, count, 1);
+    print_summary("HB", sessions, count);
+  }
+}
+
+static unsigned env_unsigned(const char *name)
+{
+  const char *value = getenv(name);
+  return (NULL != value)? (unsigned)strtoul(value, NULL, 10) : 0;
+}
+
+// Same assignments as the one-shot environment, one per line
+static unsigned message_unsigned(const char *msg, const char *name)
+{
+  const size_t name_len = strlen(name);
+  for (const char *line = msg; NULL != line; line = strchr(line, '\n'))
+  {
+    if ('\n' == *line) ++line;
+    if ((0 == strncmp(line, name, name_len)) && ('=' == line[name_len])) return (unsigned)strtoul(line + name_len + 1, NULL, 10);
+  }
+  return 0;
+}
+
+static int serve_resident(const Sim_Config_t *config, int trigger_fd)
+{
+  char msg[SIM_RESIDENT_MSG_SIZE];
+  while (0 == stop_requested)
+  {
+    const ssize_t len = recv(trigger_fd, msg, sizeof(msg) - 1, 0);
+    if (len < 0)
+    {
+      if (EINTR == errno) continue;
+      return 1;
+    }
+    if (0 == len) break; // The SDK closed its end
+
+    msg[len] = '\0';
+    run_once(config, message_unsigned(msg, "RUN_LB_LINK"), message_unsigned(msg, "LB_PROC_TIMEOUT"),
+             message_unsigned(msg, "RUN_HB_LINK"), message_unsigned(msg, "HB_PROC_TIMEOUT"));
+    fflush(stdout);
+    if (0 == stop_requested) send(trigger_fd, "RUN_COMPLETE", 12, MSG_NOSIGNAL);
+  }
+  return 0;
+}
+
+int main(void)
+{
+  // No SA_RESTART, so a signal also interrupts a resident bot waiting for its next trigger
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = handle_stop_signal;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  rand_state = (unsigned)time(NULL) ^ (unsigned)getpid();
+
+  Sim_Config_t config;
+  if (0 != read_config(&config)) return 1;
+
+  if (1 == env_unsigned("NEPI_BOT_RESIDENT"))
+  {
+    const char *trigger_fd = getenv("NEPI_BOT_TRIGGER_FD");
+    if (NULL == trigger_fd) return 1;
+    printf("*** NEPI-BOT Simulator: resident ***\n");
+    fflush(stdout);
+    return serve_resident(&config, atoi(trigger_fd));
+  }
+
+  printf("*** NEPI-BOT Simulator: LB %u (%u s), HB %u (%u s) ***\n", env_unsigned("RUN_LB_LINK"), env_unsigned("LB_PROC_TIMEOUT"),
+         env_unsigned("RUN_HB_LINK"), env_unsigned("HB_PROC_TIMEOUT"));
+  run_once(&config, env_unsigned("RUN_LB_LINK"), env_unsigned("LB_PROC_TIMEOUT"), env_unsigned("RUN_HB_LINK"),
+           env_unsigned("HB_PROC_TIMEOUT"));
+  return 0;
+}
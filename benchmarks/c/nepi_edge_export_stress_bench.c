@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+
+/* Concurrent producer throughput: 1..max_threads threads each call NEPI_EDGE_LBExportData (a status plus two snippets)
+ * and, every fourth iteration, NEPI_EDGE_LBExportGeneral with a byte payload large enough to leave the stack buffer.
+ * All threads share the default context. A throwaway bot tree is created under work_dir (default /tmp) and emptied
+ * between rounds. Usage: nepi_edge_export_stress_bench [max_threads] [exports_per_thread] [work_dir] */
+#define _XOPEN_SOURCE 700 // nftw()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ftw.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "nepi_edge_sdk_link.h"
+#include "nepi_edge_lb_interface.h"
+
+#define GENERAL_PAYLOAD_SIZE  (16 * 1024)
+#define BENCH_EPOCH_NS        1704067200000000000LL // 2024-01-01T00:00:00Z
+
+typedef struct
+{
+  unsigned thread_index;
+  long exports;
+  const uint8_t *payload;
+  NEPI_EDGE_RET_t first_error;
+} Bench_Producer_t;
+
+static double elapsed_s(const struct timespec *start, const struct timespec *stop)
+{
+  return (stop->tv_sec - start->tv_sec) + ((stop->tv_nsec - start->tv_nsec) / 1e9);
+}
+
+// Paths under the bench tree. The work dir comes from the command line, so one too long for them ends the run
+// rather than being silently truncated.
+static void tree_path(char *path, size_t size, const char *dir, const char *name)
+{
+  if (snprintf(path, size, "%s/%s", dir, name) >= (int)size)
+  {
+    printf("Path too long: %s/%s\n", dir, name);
+    exit(1);
+  }
+}
+
+static void* producer_main(void *arg)
+{
+  Bench_Producer_t *producer = (Bench_Producer_t*)arg;
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_RET_OK;
+
+  for (long i = 0; (i < producer->exports) && (NEPI_EDGE_RET_OK == ret); ++i)
+  {
+    // A distinct timestamp per export (one second apart per thread), so each one publishes its own folder
+    NEPI_EDGE_LB_Status_t status;
+    NEPI_EDGE_LBStatusCreateNs(&status, BENCH_EPOCH_NS + (producer->thread_index * 1000000000LL) + i);
+    NEPI_EDGE_LBStatusSetLatitude(status, 47.6f);
+    NEPI_EDGE_LBStatusSetLongitude(status, -122.3f);
+    NEPI_EDGE_LBStatusSetHeading(status, NEPI_EDGE_HEADING_REF_TRUE_NORTH, 90.0f);
+    NEPI_EDGE_LBStatusSetTemperature(status, 20.0f);
+
+    NEPI_EDGE_LB_Data_Snippet_t snippets[2];
+    NEPI_EDGE_LBDataSnippetCreate(&snippets[0], "cam", producer->thread_index);
+    NEPI_EDGE_LBDataSnippetSetScores(snippets[0], 0.9f, 0.8f, 0.7f);
+    NEPI_EDGE_LBDataSnippetCreate(&snippets[1], "cam", producer->thread_index); // Same type and instance on purpose
+    NEPI_EDGE_LBDataSnippetSetScores(snippets[1], 0.6f, 0.5f, 0.4f);
+
+    ret = NEPI_EDGE_LBExportData(status, snippets, 2);
+
+    NEPI_EDGE_LBDataSnippetDestroy(snippets[0]);
+    NEPI_EDGE_LBDataSnippetDestroy(snippets[1]);
+    NEPI_EDGE_LBStatusDestroy(status);
+
+    if ((NEPI_EDGE_RET_OK == ret) && (0 == (i % 4)))
+    {
+      NEPI_EDGE_LB_General_t general;
+      NEPI_EDGE_LBGeneralCreate(&general);
+      NEPI_EDGE_LBGeneralSetPayloadIntBytes(general, producer->thread_index, producer->payload, GENERAL_PAYLOAD_SIZE);
+      ret = NEPI_EDGE_LBExportGeneral(general);
+      NEPI_EDGE_LBGeneralDestroy(general);
+    }
+  }
+
+  producer->first_error = ret;
+  return NULL;
+}
+
+static int remove_entry(const char *path, const struct stat *sb, int type, struct FTW *ftwbuf)
+{
+  (void)sb; (void)type;
+  return (0 == ftwbuf->level)? 0 : remove(path); // Keep the folder itself
+}
+
+static void empty_folder(const char *base, const char *sub)
+{
+  char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s/%s", base, sub);
+  nftw(path, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+static size_t count_entries(const char *base, const char *sub, const char *suffix)
+{
+  char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s/%s", base, sub);
+  DIR *dir = opendir(path);
+  if (NULL == dir) return 0;
+
+  size_t count = 0;
+  struct dirent *entry;
+  while (NULL != (entry = readdir(dir)))
+  {
+    if ('.' == entry->d_name[0]) continue;
+    if ((NULL != suffix) && (NULL == strstr(entry->d_name, suffix))) continue;
+    ++count;
+  }
+  closedir(dir);
+  return count;
+}
+
+int main(int argc, char **argv)
+{
+  const unsigned max_threads = (argc > 1)? (unsigned)atoi(argv[1]) : 8;
+  const long exports_per_thread = (argc > 2)? atol(argv[2]) : 500;
+  const char *work_dir = (argc > 3)? argv[3] : "/tmp";
+  if ((0 == max_threads) || (exports_per_thread <= 0) || (exports_per_thread >= 1000000000L))
+  {
+    printf("Usage: %s [max_threads] [exports_per_thread < 1e9] [work_dir]\n", argv[0]);
+    return 1;
+  }
+
+  // Minimal bot tree: SetBotBaseFilePath creates the lb/hb folders but needs a NUID
+  char base[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  tree_path(base, sizeof(base), work_dir, "nepi_export_stress_XXXXXX");
+  if (NULL == mkdtemp(base))
+  {
+    printf("Can't create a folder under %s\n", work_dir);
+    return 1;
+  }
+  char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  tree_path(path, sizeof(path), base, "devinfo");
+  mkdir(path, S_IRWXU);
+  tree_path(path, sizeof(path), base, "devinfo/devnuid.txt");
+  FILE *nuid_file = fopen(path, "w");
+  if (NULL != nuid_file)
+  {
+    fputs("0000000001\n", nuid_file);
+    fclose(nuid_file);
+  }
+  if (NEPI_EDGE_RET_OK != NEPI_EDGE_SetBotBaseFilePath(base))
+  {
+    printf("Can't set up a bot tree in %s\n", base);
+    return 1;
+  }
+
+  uint8_t *payload = malloc(GENERAL_PAYLOAD_SIZE);
+  for (size_t i = 0; i < GENERAL_PAYLOAD_SIZE; ++i) payload[i] = (uint8_t)(i * 131);
+
+  Bench_Producer_t *producers = malloc(max_threads * sizeof(Bench_Producer_t));
+  pthread_t *threads = malloc(max_threads * sizeof(pthread_t));
+
+  printf("%ld exports per thread, bot tree in %s\n", exports_per_thread, base);
+  printf("threads  exports/s  speedup\n");
+
+  int status = 0;
+  double single_thread_rate = 0.0;
+  for (unsigned thread_count = 1; thread_count <= max_threads; thread_count = (thread_count == max_threads)? thread_count + 1 :
+       ((2 * thread_count > max_threads)? max_threads : 2 * thread_count))
+  {
+    empty_folder(base, NEPI_EDGE_LB_DATA_FOLDER_PATH);
+    empty_folder(base, NEPI_EDGE_LB_GENERAL_DO_FOLDER_PATH);
+
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned t = 0; t < thread_count; ++t)
+    {
+      producers[t].thread_index = t;
+      producers[t].exports = exports_per_thread;
+      producers[t].payload = payload;
+      producers[t].first_error = NEPI_EDGE_RET_OK;
+      pthread_create(&threads[t], NULL, producer_main, &producers[t]);
+    }
+    for (unsigned t = 0; t < thread_count; ++t)
+    {
+      pthread_join(threads[t], NULL);
+      if (NEPI_EDGE_RET_OK != producers[t].first_error)
+      {
+        printf("Thread %u failed with %d\n", t, producers[t].first_error);
+        status = 1;
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    // Every export and every snippet must have landed under its own name
+    const size_t expected_exports = thread_count * (size_t)exports_per_thread;
+    const size_t expected_generals = thread_count * (size_t)((exports_per_thread + 3) / 4);
+    const size_t published = count_entries(base, NEPI_EDGE_LB_DATA_FOLDER_PATH, NULL);
+    const size_t generals = count_entries(base, NEPI_EDGE_LB_GENERAL_DO_FOLDER_PATH, ".json");
+    if ((published != expected_exports) || (generals != expected_generals))
+    {
+      printf("Expected %zu exports and %zu general files, found %zu and %zu\n", expected_exports, expected_generals, published, generals);
+      status = 1;
+    }
+
+    const double rate = expected_exports / elapsed_s(&start, &stop);
+    if (1 == thread_count) single_thread_rate = rate;
+    printf("%7u  %9.0f  %6.2fx\n", thread_count, rate, rate / single_thread_rate);
+  }
+
+  empty_folder(base, "");
+  rmdir(base);
+  free(threads);
+  free(producers);
+  free(payload);
+  return status;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+
+/* Per-token cost of classifying json_walk key names: the original copy-then-strcmp-chain approach
+ * versus NEPI_EDGE_JsonKeyLookup. Usage: nepi_edge_json_keys_bench [iterations] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "nepi_edge_json_keys_impl.h"
+
+typedef struct
+{
+  const char *name;
+  size_t name_len;
+} Bench_Token_t;
+
+/* Key names in the order json_walk reports them for a two-connection lb_exec file plus a config file, including the
+ * unnamed array elements that every callback also sees */
+static const char *token_names[] = {
+  "connections",
+  "comms_type", "status", "timestart", "timestop", "warnings", NULL, NULL, "errors", NULL,
+  "msgsent", "pktsent", "msgrecv", "statsent", "datasent", "gensent", "cfgrecv", "genrecv",
+  "comms_type", "status", "timestart", "timestop", "warnings", "errors", NULL,
+  "msgsent", "pktsent", "msgrecv", "statsent", "datasent", "gensent", "cfgrecv", "genrecv",
+  "params",
+  "identifier", "value", "identifier", "value", NULL, NULL, NULL, NULL, "identifier", "value",
+  "unrecognized_key"
+};
+#define TOKEN_COUNT (sizeof(token_names) / sizeof(token_names[0]))
+
+/* The pre-keyword-table classification, as the LB exec status callback did it */
+static NEPI_EDGE_Json_Key_t strcmp_chain_lookup(const char *name, size_t name_len)
+{
+  char tmp_name[1024];
+  size_t tmp_len = (name_len < (sizeof(tmp_name) - 1))? name_len : (sizeof(tmp_name) - 1);
+  if (NULL != name) strncpy(tmp_name, name, tmp_len);
+  tmp_name[tmp_len] = '\0';
+
+  if (0 == strcmp(tmp_name, "connections")) return NEPI_EDGE_JSON_KEY_CONNECTIONS;
+  else if (0 == strcmp(tmp_name, "comms_type")) return NEPI_EDGE_JSON_KEY_COMMS_TYPE;
+  else if (0 == strcmp(tmp_name, "status")) return NEPI_EDGE_JSON_KEY_STATUS;
+  else if (0 == strcmp(tmp_name, "timestart")) return NEPI_EDGE_JSON_KEY_TIMESTART;
+  else if (0 == strcmp(tmp_name, "timestop")) return NEPI_EDGE_JSON_KEY_TIMESTOP;
+  else if (0 == strcmp(tmp_name, "warnings")) return NEPI_EDGE_JSON_KEY_WARNINGS;
+  else if (0 == strcmp(tmp_name, "errors")) return NEPI_EDGE_JSON_KEY_ERRORS;
+  else if (0 == strcmp(tmp_name, "msgsent")) return NEPI_EDGE_JSON_KEY_MSGSENT;
+  else if (0 == strcmp(tmp_name, "pktsent")) return NEPI_EDGE_JSON_KEY_PKTSENT;
+  else if (0 == strcmp(tmp_name, "msgrecv")) return NEPI_EDGE_JSON_KEY_MSGRECV;
+  else if (0 == strcmp(tmp_name, "statsent")) return NEPI_EDGE_JSON_KEY_STATSENT;
+  else if (0 == strcmp(tmp_name, "datasent")) return NEPI_EDGE_JSON_KEY_DATASENT;
+  else if (0 == strcmp(tmp_name, "gensent")) return NEPI_EDGE_JSON_KEY_GENSENT;
+  else if (0 == strcmp(tmp_name, "cfgrecv")) return NEPI_EDGE_JSON_KEY_CFGRECV;
+  else if (0 == strcmp(tmp_name, "genrecv")) return NEPI_EDGE_JSON_KEY_GENRECV;
+  else if (0 == strcmp(tmp_name, "params")) return NEPI_EDGE_JSON_KEY_PARAMS;
+  else if (0 == strcmp(tmp_name, "identifier")) return NEPI_EDGE_JSON_KEY_IDENTIFIER;
+  else if (0 == strcmp(tmp_name, "value")) return NEPI_EDGE_JSON_KEY_VALUE;
+  return NEPI_EDGE_JSON_KEY_UNKNOWN;
+}
+
+static double elapsed_ns(const struct timespec *start, const struct timespec *stop)
+{
+  return ((stop->tv_sec - start->tv_sec) * 1e9) + (stop->tv_nsec - start->tv_nsec);
+}
+
+int main(int argc, char **argv)
+{
+  const long iterations = (argc > 1)? atol(argv[1]) : 200000;
+
+  Bench_Token_t tokens[TOKEN_COUNT];
+  for (size_t i = 0; i < TOKEN_COUNT; ++i)
+  {
+    tokens[i].name = token_names[i];
+    tokens[i].name_len = (NULL == token_names[i])? 0 : strlen(token_names[i]);
+
+    // Both approaches must agree before their timings mean anything
+    if (strcmp_chain_lookup(tokens[i].name, tokens[i].name_len) != NEPI_EDGE_JsonKeyLookup(tokens[i].name, tokens[i].name_len))
+    {
+      printf("Mismatch on key \"%s\"\n", (NULL == tokens[i].name)? "(null)" : tokens[i].name);
+      return 1;
+    }
+  }
+
+  volatile unsigned sink = 0; // Keeps the loops from being optimized away
+  struct timespec start, stop;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long n = 0; n < iterations; ++n)
+  {
+    for (size_t i = 0; i < TOKEN_COUNT; ++i) sink += strcmp_chain_lookup(tokens[i].name, tokens[i].name_len);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  const double chain_ns = elapsed_ns(&start, &stop) / ((double)iterations * TOKEN_COUNT);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long n = 0; n < iterations; ++n)
+  {
+    for (size_t i = 0; i < TOKEN_COUNT; ++i) sink += NEPI_EDGE_JsonKeyLookup(tokens[i].name, tokens[i].name_len);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  const double table_ns = elapsed_ns(&start, &stop) / ((double)iterations * TOKEN_COUNT);
+
+  printf("%zu tokens x %ld iterations\n", (size_t)TOKEN_COUNT, iterations);
+  printf("copy + strcmp chain: %8.2f ns/token\n", chain_ns);
+  printf("keyword table:       %8.2f ns/token (%.1fx)\n", table_ns, chain_ns / table_ns);
+  return 0;
+}
@@ -197,29 +197,27 @@ int main(int argc, char **argv)
   printf("\tHB is %s, HB Timeout is %u seconds\n", (run_lb != 0)? "Enabled" : "Disabled", hb_timeout_s);
   NEPI_EDGE_StartBot(run_lb, lb_timeout_s, run_hb, hb_timeout_s);
 
-  uint8_t bot_still_running = 1;
-  int bot_kill_timer = 0; // seconds
-  while (bot_still_running)
+  /* Block until BOT exits -- no polling needed. NEPI_EDGE_GetBotFd() offers the same notification for your own
+     poll/epoll loop */
+  if (NEPI_EDGE_RET_TIMED_OUT == NEPI_EDGE_WaitBot((hb_timeout_s + 1) * 1000))
   {
-    ++bot_kill_timer;
-    printf("%d\n", bot_kill_timer);
-    sleep(1);
-    NEPI_EDGE_CheckBotRunning(&bot_still_running);
-
     /* Here is how to kill BOT before it terminates on its own -- this is an error-path fallback for a hung NEPI-BOT process, not a part
        of normal execution... BOT _should_ manage its own timeouts properly */
-    if (hb_timeout_s + 1 == bot_kill_timer)
-    {
-      printf("Signaling BOT to shut down gracefully\n");
-      NEPI_EDGE_StopBot(0); // Soft kill
-    }
-    else if (hb_timeout_s + 5 == bot_kill_timer)
-    {
-      printf("Killing BOT forcefully\n");
-      NEPI_EDGE_StopBot(1); // Hard kill
-    }
+    printf("Signaling BOT to shut down gracefully, killing it forcefully if still running after 4 seconds\n");
+    NEPI_EDGE_StopBotGraceful(4000);
+  }
+  printf("BOT has exited\n");
+
+  /* Resource usage of the run, as recorded when BOT was reaped */
+  NEPI_EDGE_Bot_Run_Stats_t bot_run;
+  if (NEPI_EDGE_RET_OK == NEPI_EDGE_GetBotLastRun(&bot_run))
+  {
+    printf("\t%s %d after %llu ms, %llu ms CPU, %llu KiB max RSS\n",
+           (NEPI_EDGE_BOT_EXIT_CAUSE_SIGNALED == bot_run.exit_cause)? "Signal" : "Exit code", bot_run.exit_value,
+           (unsigned long long)bot_run.wall_time_ms,
+           (unsigned long long)((bot_run.user_cpu_us + bot_run.system_cpu_us) / 1000),
+           (unsigned long long)bot_run.max_rss_kb);
   }
-  printf("\n");
 
   /* Optional -- you can unlink the HB Data Folder if you want, or just leave it linked */
   NEPI_EDGE_HBUnlinkDataFolder();
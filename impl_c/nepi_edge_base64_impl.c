@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#include "nepi_edge_base64_impl.h"
+
+// Vector paths: SSSE3 on x86, selected at run time so the library still runs on older CPUs; NEON on AArch64,
+// where it is always present. Everything else, and the tail of every buffer, goes through the scalar code.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+  #define NEPI_EDGE_BASE64_SSSE3
+  #include <tmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  #define NEPI_EDGE_BASE64_NEON
+  #include <arm_neon.h>
+#endif
+
+static const uint8_t encode_table[64] = {
+  'A','B','C','D','E','F','G','H','I','J','K','L','M','N','O','P','Q','R','S','T','U','V','W','X','Y','Z',
+  'a','b','c','d','e','f','g','h','i','j','k','l','m','n','o','p','q','r','s','t','u','v','w','x','y','z',
+  '0','1','2','3','4','5','6','7','8','9','+','/'
+};
+
+// 255 marks chars outside the alphabet; anything >= 128 is rejected before lookup
+static const uint8_t decode_table[128] = {
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,  62, 255, 255, 255,  63,
+   52,  53,  54,  55,  56,  57,  58,  59,  60,  61, 255, 255, 255, 255, 255, 255,
+  255,   0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,
+   15,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25, 255, 255, 255, 255, 255,
+  255,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  36,  37,  38,  39,  40,
+   41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  51, 255, 255, 255, 255, 255
+};
+
+static inline uint8_t decode_char(char c)
+{
+  const unsigned char u = (unsigned char)c;
+  return (u < 128)? decode_table[u] : 255;
+}
+
+#if defined(NEPI_EDGE_BASE64_SSSE3)
+
+// SSSE3 kernels after W. Mula and D. Lemire, "Faster Base64 Encoding and Decoding Using AVX2 Instructions", 2018
+
+// 12 input bytes -> 16 output chars; reads 16 input bytes, so the caller must leave at least that many
+__attribute__((target("ssse3")))
+static size_t encode_ssse3(const uint8_t *src, size_t len, char *dest)
+{
+  size_t i = 0;
+  char *d = dest;
+  for (; (len - i) >= 16; i += 12, d += 16)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i*)(src + i));
+
+    // Spread each 3-byte group over a 32-bit lane as [b1, b0, b2, b1] and pull out the four 6-bit indices
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(t1, t3);
+
+    // Map each index range (A-Z, a-z, 0-9, +, /) to the offset that turns it into its ASCII char
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i is_upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    range = _mm_or_si128(range, _mm_and_si128(is_upper, _mm_set1_epi8(13)));
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    const __m128i out = _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+
+    _mm_storeu_si128((__m128i*)d, out);
+  }
+  return i;
+}
+
+// 16 input chars -> 12 output bytes; writes 16 output bytes, so the caller must leave room for that many.
+// Returns the number of chars consumed, stopping early at the first block containing a char outside the alphabet.
+__attribute__((target("ssse3")))
+static size_t decode_ssse3(const char *src, size_t len, uint8_t *dest)
+{
+  const __m128i shift_lut = _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  // Bit n of entry l is set when the char (n << 4) | l is in the alphabet
+  const __m128i valid_lut = _mm_setr_epi8((char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+                                          (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50,
+                                          0x50, 0x50, 0x54);
+  const __m128i bit_lut = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80,
+                                        0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+  const __m128i slash = _mm_set1_epi8('/');
+
+  size_t i = 0;
+  uint8_t *d = dest;
+  for (; (len - i) >= 16; i += 16, d += 12)
+  {
+    const __m128i in = _mm_loadu_si128((const __m128i*)(src + i));
+    const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), nibble_mask);
+    const __m128i lo_nibbles = _mm_and_si128(in, nibble_mask);
+
+    const __m128i valid_bits = _mm_and_si128(_mm_shuffle_epi8(valid_lut, lo_nibbles), _mm_shuffle_epi8(bit_lut, hi_nibbles));
+    if (0 != _mm_movemask_epi8(_mm_cmpeq_epi8(valid_bits, _mm_setzero_si128()))) break;
+
+    // '+' and '/' share a high nibble; '/' needs 16 rather than 19
+    const __m128i is_slash = _mm_cmpeq_epi8(in, slash);
+    __m128i shift = _mm_shuffle_epi8(shift_lut, hi_nibbles);
+    shift = _mm_or_si128(_mm_andnot_si128(is_slash, shift), _mm_and_si128(is_slash, _mm_set1_epi8(16)));
+    const __m128i values = _mm_add_epi8(in, shift);
+
+    // Pack four 6-bit values per 32-bit lane into 24 bits, then squeeze the lanes together
+    const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i lanes = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    const __m128i out = _mm_shuffle_epi8(lanes, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+    _mm_storeu_si128((__m128i*)d, out);
+  }
+  return i;
+}
+
+static int have_ssse3(void)
+{
+#if defined(__SSSE3__)
+  return 1;
+#else
+  return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+#elif defined(NEPI_EDGE_BASE64_NEON)
+
+// 48 input bytes -> 64 output chars; the de-interleaving load and interleaving store do all the shuffling
+static size_t encode_neon(const uint8_t *src, size_t len, char *dest)
+{
+  uint8x16x4_t table;
+  table.val[0] = vld1q_u8(encode_table);
+  table.val[1] = vld1q_u8(encode_table + 16);
+  table.val[2] = vld1q_u8(encode_table + 32);
+  table.val[3] = vld1q_u8(encode_table + 48);
+  const uint8x16_t mask6 = vdupq_n_u8(0x3f);
+
+  size_t i = 0;
+  char *d = dest;
+  for (; (len - i) >= 48; i += 48, d += 64)
+  {
+    const uint8x16x3_t in = vld3q_u8(src + i);
+    uint8x16x4_t out;
+    out.val[0] = vshrq_n_u8(in.val[0], 2);
+    out.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask6);
+    out.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask6);
+    out.val[3] = vandq_u8(in.val[2], mask6);
+
+    out.val[0] = vqtbl4q_u8(table, out.val[0]);
+    out.val[1] = vqtbl4q_u8(table, out.val[1]);
+    out.val[2] = vqtbl4q_u8(table, out.val[2]);
+    out.val[3] = vqtbl4q_u8(table, out.val[3]);
+    vst4q_u8((uint8_t*)d, out);
+  }
+  return i;
+}
+
+// 64 input chars -> 48 output bytes. Returns the number of chars consumed, stopping early at the first block
+// containing a char outside the alphabet.
+static size_t decode_neon(const char *src, size_t len, uint8_t *dest)
+{
+  uint8x16x4_t table_lo, table_hi;
+  table_lo.val[0] = vld1q_u8(decode_table);
+  table_lo.val[1] = vld1q_u8(decode_table + 16);
+  table_lo.val[2] = vld1q_u8(decode_table + 32);
+  table_lo.val[3] = vld1q_u8(decode_table + 48);
+  table_hi.val[0] = vld1q_u8(decode_table + 64);
+  table_hi.val[1] = vld1q_u8(decode_table + 80);
+  table_hi.val[2] = vld1q_u8(decode_table + 96);
+  table_hi.val[3] = vld1q_u8(decode_table + 112);
+  const uint8x16_t offset = vdupq_n_u8(64);
+
+  size_t i = 0;
+  uint8_t *d = dest;
+  for (; (len - i) >= 64; i += 64, d += 48)
+  {
+    const uint8x16x4_t in = vld4q_u8((const uint8_t*)(src + i));
+    uint8x16x4_t values;
+    uint8x16_t chars_or = vdupq_n_u8(0);
+    uint8x16_t values_or = vdupq_n_u8(0);
+    for (int k = 0; k < 4; ++k)
+    {
+      // Chars below 64 come from the low table; the second lookup only overrides lanes whose char - 64 is in range
+      values.val[k] = vqtbx4q_u8(vqtbl4q_u8(table_lo, in.val[k]), table_hi, vsubq_u8(in.val[k], offset));
+      chars_or = vorrq_u8(chars_or, in.val[k]);
+      values_or = vorrq_u8(values_or, values.val[k]);
+    }
+    if ((vmaxvq_u8(chars_or) >= 128) || (vmaxvq_u8(values_or) > 63)) break;
+
+    uint8x16x3_t out;
+    out.val[0] = vorrq_u8(vshlq_n_u8(values.val[0], 2), vshrq_n_u8(values.val[1], 4));
+    out.val[1] = vorrq_u8(vshlq_n_u8(values.val[1], 4), vshrq_n_u8(values.val[2], 2));
+    out.val[2] = vorrq_u8(vshlq_n_u8(values.val[2], 6), values.val[3]);
+    vst3q_u8(d, out);
+  }
+  return i;
+}
+
+#endif
+
+size_t NEPI_EDGE_Base64Encode(const uint8_t *src, size_t len, char *dest)
+{
+  size_t i = 0;
+  char *d = dest;
+
+#if defined(NEPI_EDGE_BASE64_SSSE3)
+  if (have_ssse3())
+  {
+    i = encode_ssse3(src, len, dest);
+    d += (i / 3) * 4;
+  }
+#elif defined(NEPI_EDGE_BASE64_NEON)
+  i = encode_neon(src, len, dest);
+  d += (i / 3) * 4;
+#endif
+
+  for (; (len - i) >= 3; i += 3, d += 4)
+  {
+    const uint32_t group = ((uint32_t)src[i] << 16) | ((uint32_t)src[i + 1] << 8) | src[i + 2];
+    d[0] = encode_table[group >> 18];
+    d[1] = encode_table[(group >> 12) & 0x3f];
+    d[2] = encode_table[(group >> 6) & 0x3f];
+    d[3] = encode_table[group & 0x3f];
+  }
+
+  const size_t remaining = len - i;
+  if (remaining > 0)
+  {
+    const uint32_t group = ((uint32_t)src[i] << 16) | ((2 == remaining)? ((uint32_t)src[i + 1] << 8) : 0);
+    d[0] = encode_table[group >> 18];
+    d[1] = encode_table[(group >> 12) & 0x3f];
+    d[2] = (2 == remaining)? encode_table[(group >> 6) & 0x3f] : '=';
+    d[3] = '=';
+    d += 4;
+  }
+
+  return d - dest;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_Base64Decode(const char *src, size_t len, uint8_t *dest, size_t *decoded_len)
+{
+  if (0 != (len % 4)) return NEPI_EDGE_RET_BAD_PARAM;
+
+  // The final group may carry padding, so it always takes the scalar path
+  size_t padding = 0;
+  if ((len > 0) && ('=' == src[len - 1])) padding = ('=' == src[len - 2])? 2 : 1;
+  const size_t body_len = (0 == padding)? len : (len - 4);
+
+  size_t i = 0;
+  uint8_t *d = dest;
+
+#if defined(NEPI_EDGE_BASE64_SSSE3)
+  // Each block stores 16 bytes for 12 decoded, so stop while at least 8 more chars (6 more bytes) follow it
+  if ((body_len >= 24) && have_ssse3())
+  {
+    i = decode_ssse3(src, body_len - 8, dest);
+    d += (i / 4) * 3;
+  }
+#elif defined(NEPI_EDGE_BASE64_NEON)
+  i = decode_neon(src, body_len, dest);
+  d += (i / 4) * 3;
+#endif
+
+  for (; i < body_len; i += 4, d += 3)
+  {
+    const uint8_t a = decode_char(src[i]);
+    const uint8_t b = decode_char(src[i + 1]);
+    const uint8_t c = decode_char(src[i + 2]);
+    const uint8_t e = decode_char(src[i + 3]);
+    if ((a | b | c | e) > 63) return NEPI_EDGE_RET_BAD_PARAM;
+
+    const uint32_t group = ((uint32_t)a << 18) | ((uint32_t)b << 12) | ((uint32_t)c << 6) | e;
+    d[0] = (uint8_t)(group >> 16);
+    d[1] = (uint8_t)(group >> 8);
+    d[2] = (uint8_t)group;
+  }
+
+  if (0 != padding)
+  {
+    const uint8_t a = decode_char(src[i]);
+    const uint8_t b = decode_char(src[i + 1]);
+    const uint8_t c = (1 == padding)? decode_char(src[i + 2]) : 0;
+    if ((a | b | c) > 63) return NEPI_EDGE_RET_BAD_PARAM;
+
+    const uint32_t group = ((uint32_t)a << 18) | ((uint32_t)b << 12) | ((uint32_t)c << 6);
+    *d++ = (uint8_t)(group >> 16);
+    if (1 == padding) *d++ = (uint8_t)(group >> 8);
+  }
+
+  *decoded_len = d - dest;
+  return NEPI_EDGE_RET_OK;
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#ifndef __NEPI_EDGE_BASE64_IMPL_H
+#define __NEPI_EDGE_BASE64_IMPL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "nepi_edge_errors.h"
+
+// Standard alphabet (RFC 4648 section 4) with '=' padding
+#define NEPI_EDGE_BASE64_ENCODED_LENGTH(n)     ((((n) + 2) / 3) * 4)
+#define NEPI_EDGE_BASE64_DECODED_MAX_LENGTH(n) (((n) / 4) * 3)
+
+// Encode len bytes into dest, which must hold NEPI_EDGE_BASE64_ENCODED_LENGTH(len) chars. No terminator is written.
+// Returns the number of chars written.
+size_t NEPI_EDGE_Base64Encode(const uint8_t *src, size_t len, char *dest);
+
+// Decode len chars into dest, which must hold NEPI_EDGE_BASE64_DECODED_MAX_LENGTH(len) bytes. The input must be
+// padded to a multiple of 4 and contain no whitespace. Returns NEPI_EDGE_RET_BAD_PARAM for anything else.
+NEPI_EDGE_RET_t NEPI_EDGE_Base64Decode(const char *src, size_t len, uint8_t *dest, size_t *decoded_len);
+
+#endif //__NEPI_EDGE_BASE64_IMPL_H
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "nepi_edge_sdk_link.h"
+#include "nepi_edge_sdk_link_impl.h"
+#include "nepi_edge_bot_config_impl.h"
+#include "nepi_edge_lb_consts.h"
+#include "nepi_edge_hb_consts.h"
+
+#define BACKLOG_MAX_FOLDER_DEPTH    16
+// As the bot falls back to for a link that leaves them out
+#define DEFAULT_LINK_PACKET_SIZE    1500
+#define DEFAULT_LINK_OPEN_ATTEMPTS  1
+#define DEFAULT_LINK_OPEN_TIMEOUT_S 1
+
+static uint32_t linkPacketSize(const NEPI_EDGE_Bot_Config_Link_t *link)
+{
+  return (0 != link->packet_size)? link->packet_size : DEFAULT_LINK_PACKET_SIZE;
+}
+
+static uint32_t linkMaxMsgSize(const NEPI_EDGE_Bot_Config_Link_t *link)
+{
+  return (0 != link->max_msg_size)? link->max_msg_size : linkPacketSize(link);
+}
+
+static uint32_t linkOpenTimeout(const NEPI_EDGE_Bot_Config_Link_t *link)
+{
+  return (0 != link->open_tout_s)? link->open_tout_s : DEFAULT_LINK_OPEN_TIMEOUT_S;
+}
+
+static uint32_t linkOpenAttempts(const NEPI_EDGE_Bot_Config_Link_t *link)
+{
+  return (0 != link->open_attm)? link->open_attm : DEFAULT_LINK_OPEN_ATTEMPTS;
+}
+
+// Regular files below the folder, not following symlinks within it. Dot entries are skipped: they include the export
+// staging folders, whose files aren't published yet.
+static NEPI_EDGE_RET_t addFolderBacklog(int dir_fd, uint32_t depth, uint64_t *bytes, uint32_t *files)
+{
+  DIR *dir = fdopendir(dir_fd);
+  if (NULL == dir)
+  {
+    close(dir_fd);
+    return NEPI_EDGE_RET_FILE_OPEN_ERR;
+  }
+
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_RET_OK;
+  struct dirent *de;
+  while ((NEPI_EDGE_RET_OK == ret) && (NULL != (de = readdir(dir))))
+  {
+    if ('.' == de->d_name[0]) continue;
+
+    struct stat sb;
+    if (0 != fstatat(dirfd(dir), de->d_name, &sb, AT_SYMLINK_NOFOLLOW)) continue; // Sent and deleted meanwhile
+    if (S_ISREG(sb.st_mode))
+    {
+      *bytes += (uint64_t)sb.st_size;
+      ++(*files);
+    }
+    else if (S_ISDIR(sb.st_mode) && (depth < BACKLOG_MAX_FOLDER_DEPTH))
+    {
+      const int sub_fd = openat(dirfd(dir), de->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+      if (sub_fd >= 0) ret = addFolderBacklog(sub_fd, depth + 1, bytes, files);
+    }
+  }
+  closedir(dir);
+  return ret;
+}
+
+// A missing folder is an empty backlog. The folder itself may be a symlink, as for a linked HB data folder.
+static NEPI_EDGE_RET_t addBacklog(const char *bot_base_path, const char *folder, uint64_t *bytes, uint32_t *files)
+{
+  char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s/%s", bot_base_path, folder);
+  const int dir_fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir_fd < 0) return (ENOENT == errno)? NEPI_EDGE_RET_OK : NEPI_EDGE_RET_FILE_OPEN_ERR;
+  return addFolderBacklog(dir_fd, 0, bytes, files);
+}
+
+static uint32_t secondsUp(double seconds)
+{
+  const uint32_t whole = (uint32_t)seconds;
+  return ((double)whole < seconds)? (whole + 1) : whole;
+}
+
+static const NEPI_EDGE_Exec_History_Link_Stats_t* findLinkStats(const NEPI_EDGE_Exec_History_Link_Stats_t *stats,
+                                                                size_t stats_count, NEPI_EDGE_LINK_TYPE_t link_type,
+                                                                const char *comms_type)
+{
+  for (size_t i = 0; i < stats_count; ++i)
+  {
+    if ((stats[i].link_type == link_type) && (0 == strcmp(stats[i].comms_type, comms_type))) return &(stats[i]);
+  }
+  return NULL;
+}
+
+// LB runs are counted in packets, each carrying at most this much of a message
+static double lbPacketPayload(const NEPI_EDGE_Bot_Config_Link_t *link)
+{
+  const uint32_t max_msg_size = linkMaxMsgSize(link);
+  const uint32_t packets_per_msg = (max_msg_size + linkPacketSize(link) - 1) / linkPacketSize(link);
+  return (double)max_msg_size / (double)packets_per_msg;
+}
+
+static double linkBytesPerSecond(NEPI_EDGE_LINK_TYPE_t link_type, const NEPI_EDGE_Bot_Config_Link_t *link,
+                                 const NEPI_EDGE_Exec_History_Link_Stats_t *stats)
+{
+  if (NULL == stats) return 0.0;
+  return (NEPI_EDGE_LINK_TYPE_LB == link_type)? (stats->pkts_per_s * lbPacketPayload(link)) : stats->bytes_per_s;
+}
+
+// Fills in everything but the timeout and budget, or just the backlog if there's no link to advise for. Returns the
+// chosen link, with its failover and connect time in overhead_s.
+static const NEPI_EDGE_Bot_Config_Link_t* adviseLink(NEPI_EDGE_LINK_TYPE_t link_type, const NEPI_EDGE_Bot_Config_Link_t *links,
+                                               size_t link_count, const NEPI_EDGE_Exec_History_Link_Stats_t *stats,
+                                               size_t stats_count, NEPI_EDGE_Link_Run_Advice_t *advice,
+                                               double *overhead_s)
+{
+  // Prefer a link that is believed to be up, but advise for a down one rather than for none
+  for (int allow_down = 0; allow_down <= 1; ++allow_down)
+  {
+    *overhead_s = 0.0;
+    for (size_t i = 0; i < link_count; ++i)
+    {
+      const NEPI_EDGE_Bot_Config_Link_t *link = &(links[i]);
+      if (0 == link->enabled) continue;
+
+      const NEPI_EDGE_Exec_History_Link_Stats_t *link_stats = findLinkStats(stats, stats_count, link_type, link->name);
+      const double bytes_per_s = linkBytesPerSecond(link_type, link, link_stats);
+      if ((bytes_per_s > 0.0) && ((1 == allow_down) || (NEPI_EDGE_LINK_STATE_DOWN != link_stats->state)))
+      {
+        *overhead_s += linkOpenTimeout(link);
+        advice->estimated = 1;
+        memcpy(advice->comms_type, link->name, sizeof(advice->comms_type));
+        advice->success_ratio = link_stats->success_ratio;
+        advice->bytes_per_s = bytes_per_s;
+        advice->overhead_s = secondsUp(*overhead_s);
+        return link;
+      }
+      *overhead_s += (double)linkOpenAttempts(link) * linkOpenTimeout(link);
+    }
+  }
+  return NULL;
+}
+
+// What each LB run sends besides the backlog (a status message), and the part full last packet of each file
+static double perRunBytes(NEPI_EDGE_LINK_TYPE_t link_type, const NEPI_EDGE_Bot_Config_Link_t *link)
+{
+  return (NEPI_EDGE_LINK_TYPE_LB == link_type)? lbPacketPayload(link) : 0.0;
+}
+
+// Seconds for the whole backlog, connecting included
+static double backlogSeconds(NEPI_EDGE_LINK_TYPE_t link_type, const NEPI_EDGE_Bot_Config_Link_t *link, double overhead_s,
+                             double headroom, const NEPI_EDGE_Link_Run_Advice_t *advice)
+{
+  const double packet_bytes = perRunBytes(link_type, link);
+  const double bytes = (double)advice->backlog_bytes + packet_bytes + (packet_bytes * advice->backlog_files);
+  return overhead_s + (bytes / advice->bytes_per_s * headroom);
+}
+
+static uint64_t budgetBytes(NEPI_EDGE_LINK_TYPE_t link_type, const NEPI_EDGE_Bot_Config_Link_t *link, double overhead_s,
+                            double headroom, uint32_t timeout_s, const NEPI_EDGE_Link_Run_Advice_t *advice)
+{
+  const double budget = (((double)timeout_s - overhead_s) * advice->bytes_per_s / headroom) - perRunBytes(link_type, link);
+  return (budget > 0.0)? (uint64_t)budget : 0;
+}
+
+typedef struct
+{
+  uint8_t recommend; // Else budget for the timeout given
+  uint8_t headroom_pct;
+  uint32_t max_timeout_s;
+  uint32_t timeout_s[2]; // By NEPI_EDGE_LINK_TYPE_t
+} Advisor_Request_t;
+
+static NEPI_EDGE_RET_t adviseBotRun(struct NEPI_EDGE_Context *ctx, NEPI_EDGE_Exec_History_t history,
+                                    const Advisor_Request_t *request, NEPI_EDGE_Bot_Run_Advice_t *advice)
+{
+  memset(advice, 0, sizeof(*advice));
+
+  NEPI_EDGE_Exec_History_Link_Stats_t stats[NEPI_EDGE_EXEC_HISTORY_MAX_LINKS];
+  size_t stats_count;
+  // The percentile isn't used here
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_ExecHistoryGetLinkStats(history, 50, stats, NEPI_EDGE_EXEC_HISTORY_MAX_LINKS,
+                                                          &stats_count);
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+
+  ret = addBacklog(ctx->bot_base_file_path, NEPI_EDGE_LB_DATA_FOLDER_PATH, &(advice->lb.backlog_bytes),
+                   &(advice->lb.backlog_files));
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+  ret = addBacklog(ctx->bot_base_file_path, NEPI_EDGE_LB_GENERAL_DO_FOLDER_PATH, &(advice->lb.backlog_bytes),
+                   &(advice->lb.backlog_files));
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+  ret = addBacklog(ctx->bot_base_file_path, NEPI_EDGE_HB_DO_DATA_FOLDER_PATH, &(advice->hb.backlog_bytes),
+                   &(advice->hb.backlog_files));
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+
+  const NEPI_EDGE_Bot_Config_t *config;
+  ret = NEPI_EDGE_BotConfigCacheAcquire(&(ctx->bot_config), ctx->bot_base_file_path, &config);
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+
+  const NEPI_EDGE_LINK_TYPE_t link_types[2] = {NEPI_EDGE_LINK_TYPE_LB, NEPI_EDGE_LINK_TYPE_HB};
+  for (size_t i = 0; i < 2; ++i)
+  {
+    const NEPI_EDGE_LINK_TYPE_t link_type = link_types[i];
+    NEPI_EDGE_Link_Run_Advice_t *link_advice = (NEPI_EDGE_LINK_TYPE_LB == link_type)? &(advice->lb) : &(advice->hb);
+    const NEPI_EDGE_Bot_Config_Link_t *links = (NEPI_EDGE_LINK_TYPE_LB == link_type)? config->lb_links : config->hb_links;
+    const size_t link_count = (NEPI_EDGE_LINK_TYPE_LB == link_type)? config->lb_link_count : config->hb_link_count;
+
+    double overhead_s;
+    const NEPI_EDGE_Bot_Config_Link_t *link = adviseLink(link_type, links, link_count, stats, stats_count, link_advice,
+                                                   &overhead_s);
+    if (NULL == link) continue;
+
+    const double headroom = 1.0 + (request->headroom_pct / 100.0);
+    const double needed_s = backlogSeconds(link_type, link, overhead_s, headroom, link_advice);
+    uint32_t timeout_s = request->timeout_s[link_type];
+    if (1 == request->recommend)
+    {
+      timeout_s = (needed_s < (double)UINT32_MAX)? secondsUp(needed_s) : UINT32_MAX;
+      if (0 == timeout_s) timeout_s = 1;
+      if ((0 != request->max_timeout_s) && (timeout_s > request->max_timeout_s)) timeout_s = request->max_timeout_s;
+    }
+    link_advice->timeout_s = timeout_s;
+    link_advice->backlog_fits = (needed_s <= (double)timeout_s)? 1 : 0;
+    link_advice->budget_bytes = budgetBytes(link_type, link, overhead_s, headroom, timeout_s, link_advice);
+  }
+  return NEPI_EDGE_ReleaseBotConfig(config);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_AdviseBotTimeouts(NEPI_EDGE_Exec_History_t history, uint8_t headroom_pct,
+                                            uint32_t max_timeout_s, NEPI_EDGE_Bot_Run_Advice_t *advice)
+{
+  return NEPI_EDGE_AdviseBotTimeoutsCtx(NEPI_EDGE_GetDefaultContext(), history, headroom_pct, max_timeout_s, advice);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_AdviseBotTimeoutsCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Exec_History_t history,
+                                               uint8_t headroom_pct, uint32_t max_timeout_s,
+                                               NEPI_EDGE_Bot_Run_Advice_t *advice)
+{
+  VALIDATE_CONTEXT(context)
+
+  const Advisor_Request_t request = {.recommend = 1, .headroom_pct = headroom_pct, .max_timeout_s = max_timeout_s};
+  return adviseBotRun(ctx, history, &request, advice);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_AdviseExportBudget(NEPI_EDGE_Exec_History_t history, uint8_t headroom_pct,
+                                             uint32_t lb_timeout_s, uint32_t hb_timeout_s,
+                                             NEPI_EDGE_Bot_Run_Advice_t *advice)
+{
+  return NEPI_EDGE_AdviseExportBudgetCtx(NEPI_EDGE_GetDefaultContext(), history, headroom_pct, lb_timeout_s,
+                                         hb_timeout_s, advice);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_AdviseExportBudgetCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Exec_History_t history,
+                                                uint8_t headroom_pct, uint32_t lb_timeout_s, uint32_t hb_timeout_s,
+                                                NEPI_EDGE_Bot_Run_Advice_t *advice)
+{
+  VALIDATE_CONTEXT(context)
+
+  Advisor_Request_t request = {.recommend = 0, .headroom_pct = headroom_pct};
+  request.timeout_s[NEPI_EDGE_LINK_TYPE_LB] = lb_timeout_s;
+  request.timeout_s[NEPI_EDGE_LINK_TYPE_HB] = hb_timeout_s;
+  return adviseBotRun(ctx, history, &request, advice);
+}
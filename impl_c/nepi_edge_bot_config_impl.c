@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+#include "nepi_edge_sdk_link.h"
+#include "nepi_edge_sdk_link_impl.h"
+#include "nepi_edge_bot_config_impl.h"
+#include "nepi_edge_file_map_impl.h"
+
+#include "frozen/frozen.h"
+
+// config first, so the pointers handed out convert back
+struct NEPI_EDGE_Bot_Config_Snapshot
+{
+  NEPI_EDGE_Bot_Config_t config;
+  atomic_uint refs;
+
+  NEPI_EDGE_Opaque_Helper_t opaque_helper;
+};
+
+static void releaseSnapshot(struct NEPI_EDGE_Bot_Config_Snapshot *snapshot)
+{
+  if (1 == atomic_fetch_sub(&(snapshot->refs), 1)) NEPI_EDGE_FREE(snapshot);
+}
+
+static void readPipo(const char *json, int json_len, NEPI_EDGE_Bot_Config_Pipo_t *pipo)
+{
+  json_scanf(json, json_len, "{pipo_scor_wt: %f, pipo_qual_wt: %f, pipo_size_wt: %f, pipo_time_wt: %f, pipo_trig_wt: %f, "
+             "purge_rating: %f}", &(pipo->scor_wt), &(pipo->qual_wt), &(pipo->size_wt), &(pipo->time_wt),
+             &(pipo->trig_wt), &(pipo->purge_rating));
+}
+
+static void readLink(const char *json, int json_len, const struct json_token *name, NEPI_EDGE_LINK_TYPE_t link_type,
+                     const NEPI_EDGE_Bot_Config_Pipo_t *pipo, NEPI_EDGE_Bot_Config_Link_t *link)
+{
+  memcpy(link->name, name->ptr, name->len);
+  if (NEPI_EDGE_LINK_TYPE_LB == link_type) link->pipo = *pipo;
+
+  char fmt[NEPI_EDGE_MAX_COMMS_TYPE_LENGTH + 16];
+  snprintf(fmt, sizeof(fmt), "{%s: %%T}", link->name);
+  struct json_token block = {NULL, 0, JSON_TYPE_INVALID};
+  json_scanf(json, json_len, fmt, &block);
+  if (JSON_TYPE_OBJECT_END != block.type) return; // In the order but not configured
+
+  int enabled = 0;
+  struct json_token type = {NULL, 0, JSON_TYPE_INVALID};
+  json_scanf(block.ptr, block.len, "{enabled: %d, type: %T, tout: %u, open_attm: %u, open_tout: %u, max_msg_size: %u, "
+             "packet_size: %u}", &enabled, &type, &(link->tout_s), &(link->open_attm), &(link->open_tout_s),
+             &(link->max_msg_size), &(link->packet_size));
+  link->enabled = (0 != enabled)? 1 : 0;
+  if ((JSON_TYPE_STRING == type.type) && (type.len < NEPI_EDGE_BOT_CONFIG_MAX_TYPE_LENGTH))
+  {
+    memcpy(link->type, type.ptr, type.len);
+  }
+  if (NEPI_EDGE_LINK_TYPE_LB == link_type) readPipo(block.ptr, block.len, &(link->pipo));
+}
+
+static size_t readLinkOrder(const char *json, int json_len, const char *order_path, NEPI_EDGE_LINK_TYPE_t link_type,
+                            const NEPI_EDGE_Bot_Config_Pipo_t *pipo, NEPI_EDGE_Bot_Config_Link_t *links)
+{
+  size_t count = 0;
+  struct json_token name;
+  for (int i = 0; (count < NEPI_EDGE_BOT_CONFIG_MAX_LINKS) &&
+                  (json_scanf_array_elem(json, json_len, order_path, i, &name) > 0); ++i)
+  {
+    // Longer names couldn't be matched against an exec status comms_type anyway
+    if ((JSON_TYPE_STRING != name.type) || (name.len >= NEPI_EDGE_MAX_COMMS_TYPE_LENGTH)) continue;
+    readLink(json, json_len, &name, link_type, pipo, &(links[count++]));
+  }
+  return count;
+}
+
+static NEPI_EDGE_RET_t parseConfig(const char *path, struct NEPI_EDGE_Bot_Config_Snapshot **snapshot)
+{
+  NEPI_EDGE_File_Map_t *map = NULL;
+  const NEPI_EDGE_RET_t ret = NEPI_EDGE_FileMapOpen(path, &map);
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+
+  const char *json = map->data;
+  const int json_len = (int)map->length;
+  if (json_walk(json, json_len, NULL, NULL) <= 0)
+  {
+    NEPI_EDGE_FileMapCloseAll(map);
+    return NEPI_EDGE_RET_INVALID_FILE_FORMAT;
+  }
+
+  struct NEPI_EDGE_Bot_Config_Snapshot *s = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_Bot_Config_Snapshot));
+  if (NULL == s)
+  {
+    NEPI_EDGE_FileMapCloseAll(map);
+    return NEPI_EDGE_RET_MALLOC_ERR;
+  }
+  memset(s, 0, sizeof(*s));
+  s->opaque_helper.msg_id = NEPI_EDGE_OPAQUE_TYPE_ID_BOT_CONFIG;
+  atomic_init(&(s->refs), 1);
+
+  NEPI_EDGE_Bot_Config_t *config = &(s->config);
+  int data_zlib = 0, data_msgpack = 0, lb_encrypted = 0;
+  json_scanf(json, json_len, "{data_zlib: %d, data_msgpack: %d, lb_encrypted: %d, fs_pct_used_warning: %u}",
+             &data_zlib, &data_msgpack, &lb_encrypted, &(config->fs_pct_used_warning));
+  config->data_zlib = (0 != data_zlib)? 1 : 0;
+  config->data_msgpack = (0 != data_msgpack)? 1 : 0;
+  config->lb_encrypted = (0 != lb_encrypted)? 1 : 0;
+  readPipo(json, json_len, &(config->pipo));
+
+  config->lb_link_count = readLinkOrder(json, json_len, ".lb_conn_order", NEPI_EDGE_LINK_TYPE_LB, &(config->pipo),
+                                        config->lb_links);
+  config->hb_link_count = readLinkOrder(json, json_len, ".hb_conn_order", NEPI_EDGE_LINK_TYPE_HB, &(config->pipo),
+                                        config->hb_links);
+  NEPI_EDGE_FileMapCloseAll(map);
+
+  *snapshot = s;
+  return NEPI_EDGE_RET_OK;
+}
+
+void NEPI_EDGE_BotConfigCacheInit(NEPI_EDGE_Bot_Config_Cache_t *cache)
+{
+  const NEPI_EDGE_Bot_Config_Cache_t empty = NEPI_EDGE_BOT_CONFIG_CACHE_INITIALIZER;
+  *cache = empty;
+  pthread_mutex_init(&(cache->lock), NULL);
+}
+
+void NEPI_EDGE_BotConfigCacheDestroy(NEPI_EDGE_Bot_Config_Cache_t *cache)
+{
+  if (NULL != cache->current) releaseSnapshot(cache->current);
+  cache->current = NULL;
+  pthread_mutex_destroy(&(cache->lock));
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_BotConfigCacheAcquire(NEPI_EDGE_Bot_Config_Cache_t *cache, const char *bot_base_path,
+                                                const NEPI_EDGE_Bot_Config_t **config)
+{
+  char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s/%s", bot_base_path, NEPI_EDGE_BOT_CONFIG_FILE_PATH);
+
+  // Identified before reading, so a change that races the read is picked up by the next acquire
+  struct stat sb;
+  if (0 != stat(path, &sb)) return NEPI_EDGE_RET_FILE_OPEN_ERR;
+
+  pthread_mutex_lock(&(cache->lock));
+  if ((NULL == cache->current) || (0 != strcmp(path, cache->path)) || (sb.st_dev != cache->dev) ||
+      (sb.st_ino != cache->ino) || (sb.st_size != cache->size) || (sb.st_mtim.tv_sec != cache->mtime.tv_sec) ||
+      (sb.st_mtim.tv_nsec != cache->mtime.tv_nsec))
+  {
+    struct NEPI_EDGE_Bot_Config_Snapshot *snapshot;
+    const NEPI_EDGE_RET_t ret = parseConfig(path, &snapshot);
+    if (NEPI_EDGE_RET_OK != ret)
+    {
+      pthread_mutex_unlock(&(cache->lock));
+      return ret;
+    }
+
+    if (NULL != cache->current) releaseSnapshot(cache->current);
+    cache->current = snapshot;
+    memcpy(cache->path, path, sizeof(cache->path));
+    cache->dev = sb.st_dev;
+    cache->ino = sb.st_ino;
+    cache->size = sb.st_size;
+    cache->mtime = sb.st_mtim;
+  }
+
+  atomic_fetch_add(&(cache->current->refs), 1);
+  *config = &(cache->current->config);
+  pthread_mutex_unlock(&(cache->lock));
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_AcquireBotConfig(const NEPI_EDGE_Bot_Config_t **config)
+{
+  return NEPI_EDGE_AcquireBotConfigCtx(NEPI_EDGE_GetDefaultContext(), config);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_AcquireBotConfigCtx(NEPI_EDGE_Context_t context, const NEPI_EDGE_Bot_Config_t **config)
+{
+  VALIDATE_CONTEXT(context)
+  return NEPI_EDGE_BotConfigCacheAcquire(&(ctx->bot_config), ctx->bot_base_file_path, config);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_ReleaseBotConfig(const NEPI_EDGE_Bot_Config_t *config)
+{
+  VALIDATE_OPAQUE_TYPE(config, NEPI_EDGE_OPAQUE_TYPE_ID_BOT_CONFIG, NEPI_EDGE_Bot_Config_Snapshot)
+  releaseSnapshot(p);
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_BotConfigGetLink(const NEPI_EDGE_Bot_Config_t *config, NEPI_EDGE_LINK_TYPE_t link_type,
+                                           const char *name, const NEPI_EDGE_Bot_Config_Link_t **link)
+{
+  VALIDATE_OPAQUE_TYPE(config, NEPI_EDGE_OPAQUE_TYPE_ID_BOT_CONFIG, NEPI_EDGE_Bot_Config_Snapshot)
+
+  const NEPI_EDGE_Bot_Config_Link_t *links = (NEPI_EDGE_LINK_TYPE_LB == link_type)? p->config.lb_links : p->config.hb_links;
+  const size_t link_count = (NEPI_EDGE_LINK_TYPE_LB == link_type)? p->config.lb_link_count : p->config.hb_link_count;
+  for (size_t i = 0; i < link_count; ++i)
+  {
+    if (0 == strcmp(links[i].name, name))
+    {
+      *link = &(links[i]);
+      return NEPI_EDGE_RET_OK;
+    }
+  }
+  return NEPI_EDGE_RET_PARAM_NOT_FOUND;
+}
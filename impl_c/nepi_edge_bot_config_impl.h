@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#ifndef __NEPI_EDGE_BOT_CONFIG_IMPL_H
+#define __NEPI_EDGE_BOT_CONFIG_IMPL_H
+
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "nepi_edge_sdk_link.h"
+
+#define NEPI_EDGE_BOT_CONFIG_FILE_PATH  "cfg/bot/config.json"
+
+// Each context's latest parse of its bot's config.json, and the file it came from. Snapshots are reference counted:
+// the cache holds one reference to the current snapshot and each caller that acquired it another.
+typedef struct NEPI_EDGE_Bot_Config_Cache
+{
+  struct NEPI_EDGE_Bot_Config_Snapshot *current; // NULL until the first acquire
+  char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  struct timespec mtime;
+  pthread_mutex_t lock;
+} NEPI_EDGE_Bot_Config_Cache_t;
+
+#define NEPI_EDGE_BOT_CONFIG_CACHE_INITIALIZER \
+  { NULL, {'\0'}, 0, 0, 0, {0, 0}, PTHREAD_MUTEX_INITIALIZER }
+
+void NEPI_EDGE_BotConfigCacheInit(NEPI_EDGE_Bot_Config_Cache_t *cache);
+// Drops the cache's reference; snapshots still acquired stay valid until released
+void NEPI_EDGE_BotConfigCacheDestroy(NEPI_EDGE_Bot_Config_Cache_t *cache);
+
+// Reparses if bot_base_path/cfg/bot/config.json isn't the file the current snapshot came from
+NEPI_EDGE_RET_t NEPI_EDGE_BotConfigCacheAcquire(NEPI_EDGE_Bot_Config_Cache_t *cache, const char *bot_base_path,
+                                                const NEPI_EDGE_Bot_Config_t **config);
+
+#endif //__NEPI_EDGE_BOT_CONFIG_IMPL_H
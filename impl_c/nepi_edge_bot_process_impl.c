@@ -0,0 +1,539 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#define _GNU_SOURCE // pipe2(), vfork(), wait4(), sched_setaffinity(), posix_spawn_file_actions_addchdir_np()
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "nepi_edge_bot_process_impl.h"
+#include "nepi_edge_sdk_link.h"
+
+static NEPI_EDGE_RET_t launch_errno_to_ret(int err)
+{
+  return ((ENOENT == err) || (ENOTDIR == err))? NEPI_EDGE_RET_INVALID_BOT_PATH : NEPI_EDGE_RET_CANT_START_BOT;
+}
+
+// From linux/ioprio.h, which older kernel headers don't ship to userspace
+#define IOPRIO_WHO_PROCESS  1
+#define IOPRIO_CLASS_SHIFT  13
+
+#define CGROUP_CPU_PERIOD_US  100000
+
+// Start options resolved into what the child applies to itself between vfork() and execve()
+typedef struct
+{
+  uint8_t set_affinity;
+  cpu_set_t affinity;
+  uint8_t set_nice;
+  int nice;
+  uint8_t set_ioprio;
+  int ioprio;
+  int cgroup_procs_fd; // -1 for no placement
+} Child_Isolation_t;
+
+static int pidfd_open_wrapper(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+  return syscall(SYS_pidfd_open, pid, 0); // Always close-on-exec
+#else
+  (void)pid;
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+static int64_t monotonic_ms(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return ((int64_t)now.tv_sec * 1000) + (now.tv_nsec / 1000000);
+}
+
+// -1 until the first launch finds out whether the running kernel has pidfd_open
+static atomic_int pidfd_supported = -1;
+
+static uint8_t have_pidfd(void)
+{
+  int supported = atomic_load_explicit(&pidfd_supported, memory_order_relaxed);
+  if (-1 == supported)
+  {
+    const int probe_fd = pidfd_open_wrapper(getpid());
+    supported = (probe_fd >= 0)? 1 : 0;
+    if (probe_fd >= 0) close(probe_fd);
+    atomic_store_explicit(&pidfd_supported, supported, memory_order_relaxed);
+  }
+  return (uint8_t)supported;
+}
+
+#ifdef NEPI_EDGE_HAVE_POSIX_SPAWN_ADDCHDIR
+
+static NEPI_EDGE_RET_t spawn_with_posix_spawn(const char *exec_dir, const char *exec_path, char *const argv[],
+                                              char *const envp[], const int *inherit_fds, size_t inherit_fd_count,
+                                              pid_t *pid)
+{
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  if (0 != posix_spawn_file_actions_init(&actions)) return NEPI_EDGE_RET_CANT_START_BOT;
+  if (0 != posix_spawnattr_init(&attr))
+  {
+    posix_spawn_file_actions_destroy(&actions);
+    return NEPI_EDGE_RET_CANT_START_BOT;
+  }
+
+  sigset_t empty_mask;
+  sigemptyset(&empty_mask);
+  sigset_t default_signals;
+  sigemptyset(&default_signals);
+  sigaddset(&default_signals, SIGPIPE);
+
+  int err = posix_spawn_file_actions_addchdir_np(&actions, exec_dir);
+  // A dup2 onto itself clears close-on-exec in the child only (glibc 2.29+, as is addchdir_np)
+  for (size_t i = 0; (0 == err) && (i < inherit_fd_count); ++i)
+  {
+    err = posix_spawn_file_actions_adddup2(&actions, inherit_fds[i], inherit_fds[i]);
+  }
+  if (0 == err) err = posix_spawnattr_setsigmask(&attr, &empty_mask);
+  if (0 == err) err = posix_spawnattr_setsigdefault(&attr, &default_signals);
+  if (0 == err) err = posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+  // glibc reports chdir and execve failures in the child through this return value
+  if (0 == err) err = posix_spawn(pid, exec_path, &actions, &attr, argv, envp);
+
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+  return (0 == err)? NEPI_EDGE_RET_OK : launch_errno_to_ret(err);
+}
+
+#endif // NEPI_EDGE_HAVE_POSIX_SPAWN_ADDCHDIR
+
+// Also the only way to apply isolation: posix_spawn() has no attributes for it
+static NEPI_EDGE_RET_t spawn_with_vfork(const char *exec_dir, const char *exec_path, char *const argv[], char *const envp[],
+                                        const int *inherit_fds, size_t inherit_fd_count, const Child_Isolation_t *isolation,
+                                        pid_t *pid)
+{
+  int status_pipe[2];
+  if (0 != pipe2(status_pipe, O_CLOEXEC)) return NEPI_EDGE_RET_CANT_START_BOT;
+
+  // Keep host signal handlers from running in the child while it still borrows the host's memory
+  sigset_t all_signals, saved_mask;
+  sigfillset(&all_signals);
+  pthread_sigmask(SIG_SETMASK, &all_signals, &saved_mask);
+
+  const pid_t child = vfork();
+  if (0 == child)
+  {
+    // Async-signal-safe calls only from here to execve/_exit. Host handlers go back to the default (ignored signals
+    // stay ignored across execve, as with fork, except SIGPIPE)
+    for (int sig = 1; sig < NSIG; ++sig)
+    {
+      struct sigaction action;
+      if (0 != sigaction(sig, NULL, &action)) continue;
+      const uint8_t keep = (SIG_DFL == action.sa_handler) || ((SIG_IGN == action.sa_handler) && (SIGPIPE != sig));
+      if (0 == keep)
+      {
+        action.sa_handler = SIG_DFL;
+        action.sa_flags = 0;
+        sigaction(sig, &action, NULL);
+      }
+    }
+
+    int err = 0;
+    if ((-1 != isolation->cgroup_procs_fd) && (1 != write(isolation->cgroup_procs_fd, "0", 1))) err = errno; // 0 is "me"
+    if ((0 == err) && isolation->set_affinity && (0 != sched_setaffinity(0, sizeof(cpu_set_t), &(isolation->affinity)))) err = errno;
+    if ((0 == err) && isolation->set_nice && (0 != setpriority(PRIO_PROCESS, 0, isolation->nice))) err = errno;
+    if ((0 == err) && isolation->set_ioprio && (0 != syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, isolation->ioprio))) err = errno;
+    for (size_t i = 0; (0 == err) && (i < inherit_fd_count); ++i)
+    {
+      if (0 != fcntl(inherit_fds[i], F_SETFD, 0)) err = errno;
+    }
+    if ((0 == err) && (0 != chdir(exec_dir))) err = errno;
+    if (0 == err)
+    {
+      sigset_t empty_mask;
+      sigemptyset(&empty_mask);
+      sigprocmask(SIG_SETMASK, &empty_mask, NULL);
+      execve(exec_path, argv, envp);
+      err = errno; // Only reached on failure
+    }
+    // Report why, and never return into the host's code
+    while ((-1 == write(status_pipe[1], &err, sizeof(err))) && (EINTR == errno)) {}
+    _exit(127);
+  }
+
+  pthread_sigmask(SIG_SETMASK, &saved_mask, NULL);
+  close(status_pipe[1]);
+  if (-1 == child)
+  {
+    close(status_pipe[0]);
+    return NEPI_EDGE_RET_CANT_START_BOT;
+  }
+
+  // EOF means execve succeeded and closed the write end; anything else is the child's errno
+  int child_err = 0;
+  ssize_t read_count;
+  do
+  {
+    read_count = read(status_pipe[0], &child_err, sizeof(child_err));
+  } while ((-1 == read_count) && (EINTR == errno));
+  close(status_pipe[0]);
+
+  if (0 != read_count)
+  {
+    waitpid(child, NULL, 0);
+    return (sizeof(child_err) == read_count)? launch_errno_to_ret(child_err) : NEPI_EDGE_RET_CANT_START_BOT;
+  }
+
+  *pid = child;
+  return NEPI_EDGE_RET_OK;
+}
+
+static int write_cgroup_file(const char *cgroup_path, const char *file_name, const char *value)
+{
+  char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  if (snprintf(path, sizeof(path), "%s/%s", cgroup_path, file_name) >= (int)sizeof(path)) return -1;
+  const int fd = open(path, O_WRONLY | O_CLOEXEC);
+  if (fd < 0) return -1;
+  const ssize_t len = (ssize_t)strlen(value);
+  const int ret = (len == write(fd, value, len))? 0 : -1;
+  close(fd);
+  return ret;
+}
+
+// Create the cgroup, apply its limits and open its cgroup.procs for the child to join through
+static int prepare_cgroup(const NEPI_EDGE_Bot_Start_Options_t *options, int *procs_fd)
+{
+  if ((0 != mkdir(options->cgroup_path, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH)) && (EEXIST != errno)) return -1;
+
+  char controllers[32] = "";
+  if (0 != options->cgroup_memory_max_bytes) strcat(controllers, "+memory ");
+  if (0 != options->cgroup_cpu_max_percent) strcat(controllers, "+cpu ");
+  if ('\0' != controllers[0])
+  {
+    char parent_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+    snprintf(parent_path, sizeof(parent_path), "%s", options->cgroup_path);
+    char *last_slash = strrchr(parent_path, '/');
+    if (last_slash == parent_path) last_slash[1] = '\0'; // Directly under the root
+    else if (NULL != last_slash) *last_slash = '\0';
+    // Already-enabled controllers make this a no-op; if it fails, the limit writes below will say so
+    write_cgroup_file(parent_path, "cgroup.subtree_control", controllers);
+  }
+
+  char value[64];
+  if (0 != options->cgroup_memory_max_bytes)
+  {
+    snprintf(value, sizeof(value), "%llu", (unsigned long long)options->cgroup_memory_max_bytes);
+    if (0 != write_cgroup_file(options->cgroup_path, "memory.max", value)) return -1;
+  }
+  if (0 != options->cgroup_cpu_max_percent)
+  {
+    snprintf(value, sizeof(value), "%llu %u",
+             (unsigned long long)options->cgroup_cpu_max_percent * (CGROUP_CPU_PERIOD_US / 100), CGROUP_CPU_PERIOD_US);
+    if (0 != write_cgroup_file(options->cgroup_path, "cpu.max", value)) return -1;
+  }
+
+  char procs_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  if (snprintf(procs_path, sizeof(procs_path), "%s/cgroup.procs", options->cgroup_path) >= (int)sizeof(procs_path)) return -1;
+  *procs_fd = open(procs_path, O_WRONLY | O_CLOEXEC);
+  return (*procs_fd < 0)? -1 : 0;
+}
+
+// Returns 1 if options ask for anything at all, 0 if not, -1 if they can't be set up
+static int resolve_isolation(const NEPI_EDGE_Bot_Start_Options_t *options, Child_Isolation_t *isolation)
+{
+  memset(isolation, 0, sizeof(Child_Isolation_t));
+  isolation->cgroup_procs_fd = -1;
+  if (NULL == options) return 0;
+
+  if (0 != options->cpu_affinity_mask)
+  {
+    isolation->set_affinity = 1;
+    CPU_ZERO(&(isolation->affinity));
+    for (int cpu = 0; cpu < 64; ++cpu)
+    {
+      if (options->cpu_affinity_mask & (1ULL << cpu)) CPU_SET(cpu, &(isolation->affinity));
+    }
+  }
+  if (NEPI_EDGE_BOT_NICE_INHERIT != options->nice)
+  {
+    isolation->set_nice = 1;
+    isolation->nice = options->nice;
+  }
+  if (NEPI_EDGE_BOT_IO_CLASS_INHERIT != options->io_class)
+  {
+    isolation->set_ioprio = 1;
+    isolation->ioprio = ((int)options->io_class << IOPRIO_CLASS_SHIFT) | options->io_level;
+  }
+  if (('\0' != options->cgroup_path[0]) && (0 != prepare_cgroup(options, &(isolation->cgroup_procs_fd))))
+  {
+    return -1;
+  }
+
+  return (isolation->set_affinity || isolation->set_nice || isolation->set_ioprio || (-1 != isolation->cgroup_procs_fd))? 1 : 0;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_BotSpawn(const char *exec_dir, const char *exec_name, char *const envp[],
+                                  const int *inherit_fds, size_t inherit_fd_count,
+                                  const NEPI_EDGE_Bot_Start_Options_t *options, NEPI_EDGE_Bot_Process_t *proc)
+{
+  if (inherit_fd_count > NEPI_EDGE_BOT_MAX_INHERIT_FDS) return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
+
+  // Everything the child needs is prepared here; the child itself must not allocate
+  // Relative to exec_dir, which the child changes into first; exec_dir itself may be relative to the host's cwd
+  char exec_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  if (snprintf(exec_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "./%s", exec_name) >= NEPI_EDGE_MAX_FILE_PATH_LENGTH)
+  {
+    return NEPI_EDGE_RET_INVALID_BOT_PATH;
+  }
+  char *argv[2] = {(char*)exec_name, NULL}; // Just argv[0] -- the application name
+
+  int child_fds[NEPI_EDGE_BOT_MAX_INHERIT_FDS + 1];
+  for (size_t i = 0; i < inherit_fd_count; ++i) child_fds[i] = inherit_fds[i];
+  size_t child_fd_count = inherit_fd_count;
+
+  // Without pidfds, the child carries the write end of an exit pipe
+  int exit_pipe[2] = {-1, -1};
+  const uint8_t use_pidfd = have_pidfd();
+  if ((0 == use_pidfd) && (0 != pipe2(exit_pipe, O_CLOEXEC)))
+  {
+    exit_pipe[0] = exit_pipe[1] = -1; // Still launch; waits fall back to polling
+  }
+  if (exit_pipe[1] >= 0) child_fds[child_fd_count++] = exit_pipe[1];
+
+  pid_t pid;
+  NEPI_EDGE_RET_t ret;
+  Child_Isolation_t isolation;
+  const int isolate = resolve_isolation(options, &isolation);
+  if (-1 == isolate)
+  {
+    ret = NEPI_EDGE_RET_CANT_START_BOT;
+  }
+  else
+  {
+#ifdef NEPI_EDGE_HAVE_POSIX_SPAWN_ADDCHDIR
+    if (0 == isolate) ret = spawn_with_posix_spawn(exec_dir, exec_path, argv, envp, child_fds, child_fd_count, &pid);
+    else
+#endif
+    ret = spawn_with_vfork(exec_dir, exec_path, argv, envp, child_fds, child_fd_count, &isolation, &pid);
+  }
+  if (-1 != isolation.cgroup_procs_fd) close(isolation.cgroup_procs_fd);
+  if (exit_pipe[1] >= 0) close(exit_pipe[1]);
+  if (NEPI_EDGE_RET_OK != ret)
+  {
+    if (exit_pipe[0] >= 0) close(exit_pipe[0]);
+    return ret;
+  }
+
+  proc->pid = pid;
+  proc->exit_fd = (0 != use_pidfd)? pidfd_open_wrapper(pid) : exit_pipe[0];
+  proc->start_monotonic_ms = monotonic_ms();
+  struct timespec start_time;
+  clock_gettime(CLOCK_REALTIME, &start_time);
+  proc->start_time_ms = ((uint64_t)start_time.tv_sec * 1000) + (start_time.tv_nsec / 1000000);
+  return NEPI_EDGE_RET_OK;
+}
+
+// Returns 1 when fd is readable, 0 on timeout, -1 on error. A negative timeout waits indefinitely.
+static int wait_readable(int fd, int32_t timeout_ms)
+{
+  const int64_t deadline_ms = monotonic_ms() + timeout_ms;
+  struct pollfd pfd = {.fd = fd, .events = POLLIN};
+  int poll_timeout_ms = timeout_ms;
+  while (1)
+  {
+    const int ret = poll(&pfd, 1, poll_timeout_ms);
+    if (ret > 0) return 1; // POLLIN for a pidfd; POLLHUP for the pipe's EOF
+    if (0 == ret) return 0;
+    if (EINTR != errno) return -1;
+
+    if (timeout_ms >= 0)
+    {
+      const int64_t remaining_ms = deadline_ms - monotonic_ms();
+      poll_timeout_ms = (remaining_ms > 0)? (int)remaining_ms : 0;
+    }
+  }
+}
+
+static void close_exit_fd(NEPI_EDGE_Bot_Process_t *proc)
+{
+  if (-1 != proc->exit_fd)
+  {
+    close(proc->exit_fd);
+    proc->exit_fd = -1;
+  }
+}
+
+void NEPI_EDGE_BotRunHistoryInit(NEPI_EDGE_Bot_Run_History_t *history)
+{
+  history->next = 0;
+  history->count = 0;
+  pthread_mutex_init(&(history->lock), NULL);
+}
+
+void NEPI_EDGE_BotRunHistoryDestroy(NEPI_EDGE_Bot_Run_History_t *history)
+{
+  pthread_mutex_destroy(&(history->lock));
+}
+
+void NEPI_EDGE_BotRunHistoryGet(NEPI_EDGE_Bot_Run_History_t *history, NEPI_EDGE_Bot_Run_Stats_t *runs, uint32_t max_runs,
+                                uint32_t *run_count)
+{
+  pthread_mutex_lock(&(history->lock));
+  const uint32_t count = (max_runs < history->count)? max_runs : history->count;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    runs[i] = history->runs[(history->next + NEPI_EDGE_BOT_RUN_HISTORY_LENGTH - 1 - i) % NEPI_EDGE_BOT_RUN_HISTORY_LENGTH];
+  }
+  pthread_mutex_unlock(&(history->lock));
+  *run_count = count;
+}
+
+static uint64_t timeval_us(const struct timeval *tv)
+{
+  return ((uint64_t)tv->tv_sec * 1000000) + (uint64_t)tv->tv_usec;
+}
+
+static void record_run(const NEPI_EDGE_Bot_Process_t *proc, int status, const struct rusage *usage)
+{
+  NEPI_EDGE_Bot_Run_Stats_t run;
+  run.start_time_ms = proc->start_time_ms;
+  run.wall_time_ms = (uint64_t)(monotonic_ms() - proc->start_monotonic_ms);
+  if (WIFSIGNALED(status))
+  {
+    run.exit_cause = NEPI_EDGE_BOT_EXIT_CAUSE_SIGNALED;
+    run.exit_value = WTERMSIG(status);
+  }
+  else
+  {
+    run.exit_cause = NEPI_EDGE_BOT_EXIT_CAUSE_EXITED;
+    run.exit_value = WEXITSTATUS(status);
+  }
+  run.resident = proc->resident;
+  run.user_cpu_us = timeval_us(&(usage->ru_utime));
+  run.system_cpu_us = timeval_us(&(usage->ru_stime));
+  run.max_rss_kb = (uint64_t)usage->ru_maxrss; // Already KiB on Linux
+  run.block_input_ops = (uint64_t)usage->ru_inblock;
+  run.block_output_ops = (uint64_t)usage->ru_oublock;
+
+  NEPI_EDGE_Bot_Run_History_t *history = proc->history;
+  pthread_mutex_lock(&(history->lock));
+  history->runs[history->next] = run;
+  history->next = (history->next + 1) % NEPI_EDGE_BOT_RUN_HISTORY_LENGTH;
+  if (history->count < NEPI_EDGE_BOT_RUN_HISTORY_LENGTH) ++(history->count);
+  pthread_mutex_unlock(&(history->lock));
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_BotReap(NEPI_EDGE_Bot_Process_t *proc, uint8_t *running)
+{
+  if (-1 == proc->pid) // not started
+  {
+    *running = 0;
+    return NEPI_EDGE_RET_OK;
+  }
+
+  int status = 0;
+  struct rusage usage;
+  const pid_t wait4_ret = wait4(proc->pid, &status, WNOHANG, &usage);
+  if (-1 == wait4_ret)
+  {
+    return NEPI_EDGE_RET_BOT_EXEC_UNDETERMINED;
+  }
+  else if (0 == wait4_ret)
+  {
+    *running = 1;
+  }
+  else // Must have terminated
+  {
+    *running = 0;
+    if (NULL != proc->history) record_run(proc, status, &usage);
+    // This is the only appropriate place to reset the pid to the not-running sentinel value
+    proc->pid = -1;
+    close_exit_fd(proc);
+  }
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_BotWait(NEPI_EDGE_Bot_Process_t *proc, int32_t timeout_ms)
+{
+  const int64_t start_ms = monotonic_ms();
+  while (1)
+  {
+    uint8_t running = 0;
+    const NEPI_EDGE_RET_t ret = NEPI_EDGE_BotReap(proc, &running);
+    if ((NEPI_EDGE_RET_OK != ret) || (0 == running)) return ret;
+
+    int32_t remaining_ms = -1;
+    if (timeout_ms >= 0)
+    {
+      const int64_t elapsed_ms = monotonic_ms() - start_ms;
+      if (elapsed_ms >= timeout_ms) return NEPI_EDGE_RET_TIMED_OUT;
+      remaining_ms = timeout_ms - (int32_t)elapsed_ms;
+    }
+
+    if (-1 != proc->exit_fd)
+    {
+      const int wait_ret = wait_readable(proc->exit_fd, remaining_ms);
+      if (0 == wait_ret) return NEPI_EDGE_RET_TIMED_OUT;
+      if (-1 == wait_ret) return NEPI_EDGE_RET_BOT_EXEC_UNDETERMINED;
+
+      // Readable but not reapable means the child closed its end of an exit pipe without exiting, so the
+      // descriptor can't tell us anything more
+      if ((NEPI_EDGE_RET_OK == NEPI_EDGE_BotReap(proc, &running)) && (0 != running)) close_exit_fd(proc);
+    }
+    else
+    {
+      // No exit descriptor for this launch: fall back to sleeping between checks
+      const struct timespec check_interval = {0, 5 * 1000000}; // 5ms
+      nanosleep(&check_interval, NULL);
+    }
+  }
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_BotSignal(const NEPI_EDGE_Bot_Process_t *proc, uint8_t force_kill)
+{
+  if (-1 == proc->pid)
+  {
+    return NEPI_EDGE_RET_BOT_NOT_RUNNING;
+  }
+
+  // An exited but unreaped child still holds its pid, so this can't reach an unrelated process
+  if (0 != kill(proc->pid, (0 == force_kill)? SIGINT : SIGKILL))
+  {
+    return NEPI_EDGE_RET_CANT_KILL_BOT;
+  }
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_BotStop(NEPI_EDGE_Bot_Process_t *proc, uint32_t grace_ms)
+{
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_BotSignal(proc, 0);
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+
+  const int32_t grace_wait_ms = (grace_ms > INT32_MAX)? INT32_MAX : (int32_t)grace_ms;
+  ret = NEPI_EDGE_BotWait(proc, grace_wait_ms);
+  if (NEPI_EDGE_RET_TIMED_OUT != ret) return ret;
+
+  ret = NEPI_EDGE_BotSignal(proc, 1);
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+  return NEPI_EDGE_BotWait(proc, -1);
+}
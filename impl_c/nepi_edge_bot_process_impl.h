@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#ifndef __NEPI_EDGE_BOT_PROCESS_IMPL_H
+#define __NEPI_EDGE_BOT_PROCESS_IMPL_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "nepi_edge_errors.h"
+#include "nepi_edge_sdk_link.h"
+
+// Recent bot runs, newest at runs[(next + LENGTH - 1) % LENGTH]. Written by whichever thread reaps, so always
+// accessed under lock.
+typedef struct
+{
+  NEPI_EDGE_Bot_Run_Stats_t runs[NEPI_EDGE_BOT_RUN_HISTORY_LENGTH];
+  uint32_t next;
+  uint32_t count;
+  pthread_mutex_t lock;
+} NEPI_EDGE_Bot_Run_History_t;
+
+#define NEPI_EDGE_BOT_RUN_HISTORY_INITIALIZER  {.next = 0, .count = 0, .lock = PTHREAD_MUTEX_INITIALIZER}
+
+void NEPI_EDGE_BotRunHistoryInit(NEPI_EDGE_Bot_Run_History_t *history);
+void NEPI_EDGE_BotRunHistoryDestroy(NEPI_EDGE_Bot_Run_History_t *history);
+// Copies up to max_runs, newest first
+void NEPI_EDGE_BotRunHistoryGet(NEPI_EDGE_Bot_Run_History_t *history, NEPI_EDGE_Bot_Run_Stats_t *runs, uint32_t max_runs,
+                                uint32_t *run_count);
+
+typedef struct
+{
+  pid_t pid; // -1 when not started
+  int exit_fd; // Readable once pid exits; -1 when not started or unavailable
+
+  // Run accounting. The owner sets history (NULL for none) and resident; the rest is kept by BotSpawn.
+  NEPI_EDGE_Bot_Run_History_t *history;
+  uint8_t resident;
+  int64_t start_monotonic_ms;
+  uint64_t start_time_ms;
+} NEPI_EDGE_Bot_Process_t;
+
+#define NEPI_EDGE_BOT_PROCESS_INITIALIZER(run_history) \
+  {.pid = -1, .exit_fd = -1, .history = (run_history), .resident = 0, .start_monotonic_ms = 0, .start_time_ms = 0}
+
+// How a resident bot is relaunched after it exits on its own
+typedef struct
+{
+  uint32_t max_restarts; // Consecutive relaunches without a completed run before giving up
+  uint32_t initial_backoff_ms; // Doubled for each further relaunch, up to max_backoff_ms
+  uint32_t max_backoff_ms;
+} NEPI_EDGE_Bot_Restart_Policy_t;
+
+// Matches NEPI_EDGE_BotStartOptionsInit
+#define NEPI_EDGE_BOT_START_OPTIONS_DEFAULT  {.cpu_affinity_mask = 0, .nice = NEPI_EDGE_BOT_NICE_INHERIT, \
+                                              .io_class = NEPI_EDGE_BOT_IO_CLASS_INHERIT, .io_level = 0, \
+                                              .cgroup_path = {'\0'}, .cgroup_memory_max_bytes = 0, .cgroup_cpu_max_percent = 0}
+
+#define NEPI_EDGE_BOT_RESTART_POLICY_DEFAULT  {.max_restarts = 5, .initial_backoff_ms = 500, .max_backoff_ms = 30000}
+
+#define NEPI_EDGE_BOT_MAX_INHERIT_FDS  4
+
+// Launch exec_dir/exec_name as a child process with exec_dir as its working directory and envp as its entire
+// environment. The child starts with an empty signal mask and default SIGPIPE handling regardless of the calling
+// thread's setup, and inherits only stdio plus the (close-on-exec) inherit_fds, under the same numbers. options
+// (NULL for none) are in effect before execve(), so nothing the child runs escapes them. The host's address space
+// is never copied:
+//   1. posix_spawn() with a chdir file action, where the C library provides one and there are no options to apply
+//   2. vfork() + isolation + chdir() + execve(), with failures reported back over a close-on-exec pipe
+// Returns NEPI_EDGE_RET_INVALID_BOT_PATH when exec_dir or the executable doesn't exist,
+// NEPI_EDGE_RET_CANT_START_BOT for any other launch failure. On success proc->pid is the child and proc->exit_fd is
+// a close-on-exec descriptor that becomes readable when the child exits, or -1 if none could be set up:
+//   1. a pidfd (Linux 5.3+)
+//   2. the read end of a pipe whose only write end the child inherits. This reports EOF early if the child closes
+//      descriptors it doesn't know about, and late if it hands the write end on to its own children.
+NEPI_EDGE_RET_t NEPI_EDGE_BotSpawn(const char *exec_dir, const char *exec_name, char *const envp[],
+                                  const int *inherit_fds, size_t inherit_fd_count,
+                                  const NEPI_EDGE_Bot_Start_Options_t *options, NEPI_EDGE_Bot_Process_t *proc);
+
+// Non-blocking; reaps the child and releases exit_fd once it has exited. Every reap (here, and so in BotWait and
+// BotStop) records the run's exit status and wait4() resource usage to proc->history.
+NEPI_EDGE_RET_t NEPI_EDGE_BotReap(NEPI_EDGE_Bot_Process_t *proc, uint8_t *running);
+
+// Block on exit_fd until the child exits and is reaped, or NEPI_EDGE_RET_TIMED_OUT. A negative timeout waits
+// indefinitely. NEPI_EDGE_RET_OK right away if it isn't running.
+NEPI_EDGE_RET_t NEPI_EDGE_BotWait(NEPI_EDGE_Bot_Process_t *proc, int32_t timeout_ms);
+
+// SIGINT, or SIGKILL with force_kill
+NEPI_EDGE_RET_t NEPI_EDGE_BotSignal(const NEPI_EDGE_Bot_Process_t *proc, uint8_t force_kill);
+
+// SIGINT, SIGKILL after grace_ms, and return once reaped
+NEPI_EDGE_RET_t NEPI_EDGE_BotStop(NEPI_EDGE_Bot_Process_t *proc, uint32_t grace_ms);
+
+#endif //__NEPI_EDGE_BOT_PROCESS_IMPL_H
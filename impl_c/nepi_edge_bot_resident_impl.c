@@ -0,0 +1,473 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#define _GNU_SOURCE // pipe2(), SOCK_CLOEXEC
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "nepi_edge_sdk_link.h"
+#include "nepi_edge_sdk_link_impl.h"
+#include "nepi_edge_bot_process_impl.h"
+
+#define RESIDENT_MESSAGE_MAX_LENGTH    256
+#define RESIDENT_RUN_COMPLETE_MESSAGE  "RUN_COMPLETE"
+#define RESIDENT_HANGUP_GRACE_MS       2000 // For a bot that closes its trigger socket but doesn't exit
+
+struct NEPI_EDGE_Resident_Bot
+{
+  char exec_dir[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  NEPI_EDGE_Bot_Restart_Policy_t restart_policy;
+  NEPI_EDGE_Bot_Start_Options_t start_options;
+
+  pthread_t supervisor;
+  int wake_pipe[2]; // A byte here asks the supervisor to stop
+  NEPI_EDGE_Bot_Process_t proc; // Owned by the supervisor once it is running
+
+  // Shared with the API calls
+  pthread_mutex_t lock;
+  pthread_cond_t run_done;
+  int trigger_fd; // Our end of the trigger socket; -1 while the bot is down
+  uint32_t stop_grace_ms;
+  uint8_t run_pending;
+  NEPI_EDGE_RET_t last_run_ret;
+};
+
+static int64_t monotonic_ms(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return ((int64_t)now.tv_sec * 1000) + (now.tv_nsec / 1000000);
+}
+
+// Launch the bot with the child end of a fresh trigger socket
+static NEPI_EDGE_RET_t launch_resident(struct NEPI_EDGE_Resident_Bot *resident)
+{
+  // SEQPACKET keeps each trigger and each reply a single message
+  int trigger_pair[2];
+  if (0 != socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, trigger_pair)) return NEPI_EDGE_RET_CANT_START_BOT;
+
+  char resident_env_var[] = "NEPI_BOT_RESIDENT=1";
+  char trigger_fd_env_var[32];
+  snprintf(trigger_fd_env_var, 32, "NEPI_BOT_TRIGGER_FD=%d", trigger_pair[1]);
+  char *executable_env[3] = {resident_env_var, trigger_fd_env_var, NULL};
+
+  const NEPI_EDGE_RET_t ret = NEPI_EDGE_BotSpawn(resident->exec_dir, "botmain", executable_env, &(trigger_pair[1]), 1,
+                                                 &(resident->start_options), &(resident->proc));
+  close(trigger_pair[1]);
+  if (NEPI_EDGE_RET_OK != ret)
+  {
+    close(trigger_pair[0]);
+    return ret;
+  }
+
+  pthread_mutex_lock(&(resident->lock));
+  resident->trigger_fd = trigger_pair[0];
+  pthread_mutex_unlock(&(resident->lock));
+  return NEPI_EDGE_RET_OK;
+}
+
+// The bot is gone (or going): retire its socket and fail any run it still owed us
+static void retire_trigger(struct NEPI_EDGE_Resident_Bot *resident)
+{
+  pthread_mutex_lock(&(resident->lock));
+  if (-1 != resident->trigger_fd)
+  {
+    close(resident->trigger_fd);
+    resident->trigger_fd = -1;
+  }
+  if (1 == resident->run_pending)
+  {
+    resident->run_pending = 0;
+    resident->last_run_ret = NEPI_EDGE_RET_BOT_EXEC_UNDETERMINED;
+    pthread_cond_broadcast(&(resident->run_done));
+  }
+  pthread_mutex_unlock(&(resident->lock));
+}
+
+static void handle_message(struct NEPI_EDGE_Resident_Bot *resident, const char *msg, size_t len, uint8_t *completed_run)
+{
+  const size_t complete_len = sizeof(RESIDENT_RUN_COMPLETE_MESSAGE) - 1;
+  if ((len < complete_len) || (0 != memcmp(msg, RESIDENT_RUN_COMPLETE_MESSAGE, complete_len))) return; // Not ours to act on
+
+  pthread_mutex_lock(&(resident->lock));
+  if (1 == resident->run_pending)
+  {
+    resident->run_pending = 0;
+    resident->last_run_ret = NEPI_EDGE_RET_OK;
+    pthread_cond_broadcast(&(resident->run_done));
+  }
+  pthread_mutex_unlock(&(resident->lock));
+  *completed_run = 1;
+}
+
+// Watch a running bot until it goes away or a stop is requested; either way it has been reaped on return.
+// Returns 1 for a stop request.
+static uint8_t supervise_bot(struct NEPI_EDGE_Resident_Bot *resident, uint8_t *completed_run)
+{
+  // Only this thread closes trigger_fd, so reading it outside the lock is safe here
+  const int trigger_fd = resident->trigger_fd;
+  while (1)
+  {
+    struct pollfd pfds[3] = {
+      {.fd = resident->wake_pipe[0], .events = POLLIN},
+      {.fd = trigger_fd, .events = POLLIN},
+      {.fd = resident->proc.exit_fd, .events = POLLIN} // Ignored by poll() when -1
+    };
+    if (poll(pfds, 3, -1) < 0)
+    {
+      if (EINTR == errno) continue;
+      break; // Treat as a lost bot
+    }
+
+    if (0 != pfds[0].revents)
+    {
+      pthread_mutex_lock(&(resident->lock));
+      const uint32_t grace_ms = resident->stop_grace_ms;
+      pthread_mutex_unlock(&(resident->lock));
+      NEPI_EDGE_BotStop(&(resident->proc), grace_ms);
+      retire_trigger(resident);
+      return 1;
+    }
+
+    if (0 != pfds[1].revents)
+    {
+      char msg[RESIDENT_MESSAGE_MAX_LENGTH];
+      const ssize_t len = recv(trigger_fd, msg, sizeof(msg), MSG_DONTWAIT);
+      if (len > 0)
+      {
+        handle_message(resident, msg, (size_t)len, completed_run);
+        continue; // Drain anything queued before looking at a hangup
+      }
+      if ((len < 0) && ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno))) continue;
+      break; // The bot closed its end
+    }
+
+    if (0 != pfds[2].revents)
+    {
+      uint8_t running = 1;
+      if ((NEPI_EDGE_RET_OK == NEPI_EDGE_BotReap(&(resident->proc), &running)) && (0 == running)) break;
+
+      // An exit pipe closed early by the bot; the trigger socket still tells us when it goes
+      if (-1 != resident->proc.exit_fd)
+      {
+        close(resident->proc.exit_fd);
+        resident->proc.exit_fd = -1;
+      }
+    }
+  }
+
+  // Make sure it's really gone: a no-op wait if it already exited
+  NEPI_EDGE_BotStop(&(resident->proc), RESIDENT_HANGUP_GRACE_MS);
+  retire_trigger(resident);
+  return 0;
+}
+
+// Returns 1 if a stop was requested within timeout_ms
+static uint8_t wait_for_stop(const struct NEPI_EDGE_Resident_Bot *resident, uint32_t timeout_ms)
+{
+  const int64_t deadline_ms = monotonic_ms() + timeout_ms;
+  struct pollfd pfd = {.fd = resident->wake_pipe[0], .events = POLLIN};
+  while (1)
+  {
+    const int64_t remaining_ms = deadline_ms - monotonic_ms();
+    const int ret = poll(&pfd, 1, (remaining_ms > 0)? (int)remaining_ms : 0);
+    if (ret > 0) return 1;
+    if ((0 == ret) || (EINTR != errno)) return 0;
+  }
+}
+
+static void* supervisor_main(void *arg)
+{
+  struct NEPI_EDGE_Resident_Bot *resident = (struct NEPI_EDGE_Resident_Bot*)arg;
+
+  uint32_t restarts = 0;
+  uint32_t backoff_ms = resident->restart_policy.initial_backoff_ms;
+  while (1)
+  {
+    if (-1 != resident->proc.pid)
+    {
+      uint8_t completed_run = 0;
+      if (1 == supervise_bot(resident, &completed_run)) break;
+
+      // A bot that got real work done earns a fresh restart budget
+      if (1 == completed_run)
+      {
+        restarts = 0;
+        backoff_ms = resident->restart_policy.initial_backoff_ms;
+      }
+    }
+
+    if (restarts >= resident->restart_policy.max_restarts) break; // Give up; StopBotResident still cleans up
+    ++restarts;
+    if (1 == wait_for_stop(resident, backoff_ms)) break;
+    backoff_ms = (backoff_ms > (resident->restart_policy.max_backoff_ms / 2))? resident->restart_policy.max_backoff_ms : (2 * backoff_ms);
+
+    launch_resident(resident); // On failure the bot stays down and the next pass backs off again
+  }
+
+  retire_trigger(resident);
+  return NULL;
+}
+
+static void destroy_resident(struct NEPI_EDGE_Resident_Bot *resident)
+{
+  pthread_cond_destroy(&(resident->run_done));
+  pthread_mutex_destroy(&(resident->lock));
+  close(resident->wake_pipe[0]);
+  close(resident->wake_pipe[1]);
+  NEPI_EDGE_FREE(resident);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_SetBotRestartPolicy(uint32_t max_restarts, uint32_t initial_backoff_ms, uint32_t max_backoff_ms)
+{
+  return NEPI_EDGE_SetBotRestartPolicyCtx(NEPI_EDGE_GetDefaultContext(), max_restarts, initial_backoff_ms, max_backoff_ms);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_SetBotRestartPolicyCtx(NEPI_EDGE_Context_t context, uint32_t max_restarts, uint32_t initial_backoff_ms,
+                                                 uint32_t max_backoff_ms)
+{
+  VALIDATE_CONTEXT(context)
+
+  if ((0 == initial_backoff_ms) || (initial_backoff_ms > max_backoff_ms) || (max_backoff_ms > INT32_MAX))
+  {
+    return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
+  }
+
+  ctx->bot_restart_policy.max_restarts = max_restarts;
+  ctx->bot_restart_policy.initial_backoff_ms = initial_backoff_ms;
+  ctx->bot_restart_policy.max_backoff_ms = max_backoff_ms;
+  return NEPI_EDGE_RET_OK;
+}
+
+// Caller holds ctx->resident_lock exclusively
+static NEPI_EDGE_RET_t start_resident(struct NEPI_EDGE_Context *ctx)
+{
+  if (NULL != ctx->resident) return NEPI_EDGE_RET_BOT_ALREADY_RUNNING;
+
+  uint8_t one_shot_running = 0;
+  const NEPI_EDGE_RET_t check_ret = NEPI_EDGE_BotReap(&(ctx->bot), &one_shot_running);
+  if (NEPI_EDGE_RET_OK != check_ret) return check_ret;
+  if (1 == one_shot_running) return NEPI_EDGE_RET_BOT_ALREADY_RUNNING;
+
+  struct NEPI_EDGE_Resident_Bot *resident = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_Resident_Bot));
+  if (NULL == resident) return NEPI_EDGE_RET_MALLOC_ERR;
+
+  if (snprintf(resident->exec_dir, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/bin/botmain", ctx->bot_base_file_path) >=
+      NEPI_EDGE_MAX_FILE_PATH_LENGTH)
+  {
+    NEPI_EDGE_FREE(resident);
+    return NEPI_EDGE_RET_INVALID_BOT_PATH;
+  }
+  resident->restart_policy = ctx->bot_restart_policy;
+  resident->start_options = ctx->bot_start_options;
+  const NEPI_EDGE_Bot_Process_t not_started = NEPI_EDGE_BOT_PROCESS_INITIALIZER(&(ctx->bot_run_history));
+  resident->proc = not_started;
+  resident->proc.resident = 1;
+  resident->trigger_fd = -1;
+  resident->stop_grace_ms = 0;
+  resident->run_pending = 0;
+  resident->last_run_ret = NEPI_EDGE_RET_BOT_NOT_RUNNING; // Until a run has been triggered
+
+  if (0 != pipe2(resident->wake_pipe, O_CLOEXEC))
+  {
+    NEPI_EDGE_FREE(resident);
+    return NEPI_EDGE_RET_CANT_START_THREAD;
+  }
+  pthread_mutex_init(&(resident->lock), NULL);
+  pthread_condattr_t cond_attr;
+  pthread_condattr_init(&cond_attr);
+  pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&(resident->run_done), &cond_attr);
+  pthread_condattr_destroy(&cond_attr);
+
+  // The first launch happens here so path and permission problems are reported to the caller
+  const NEPI_EDGE_RET_t launch_ret = launch_resident(resident);
+  if (NEPI_EDGE_RET_OK != launch_ret)
+  {
+    destroy_resident(resident);
+    return launch_ret;
+  }
+
+  if (0 != pthread_create(&(resident->supervisor), NULL, supervisor_main, resident))
+  {
+    NEPI_EDGE_BotStop(&(resident->proc), 0);
+    retire_trigger(resident);
+    destroy_resident(resident);
+    return NEPI_EDGE_RET_CANT_START_THREAD;
+  }
+
+  ctx->resident = resident;
+  ++(ctx->resident_generation);
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_StartBotResident(void)
+{
+  return NEPI_EDGE_StartBotResidentCtx(NEPI_EDGE_GetDefaultContext());
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_StartBotResidentCtx(NEPI_EDGE_Context_t context)
+{
+  VALIDATE_CONTEXT(context)
+
+  pthread_rwlock_wrlock(&(ctx->resident_lock));
+  const NEPI_EDGE_RET_t ret = start_resident(ctx);
+  pthread_rwlock_unlock(&(ctx->resident_lock));
+  return ret;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_TriggerBotRun(uint8_t run_lb, uint32_t lb_timeout_s, uint8_t run_hb, uint32_t hb_timeout_s)
+{
+  return NEPI_EDGE_TriggerBotRunCtx(NEPI_EDGE_GetDefaultContext(), run_lb, lb_timeout_s, run_hb, hb_timeout_s);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_TriggerBotRunCtx(NEPI_EDGE_Context_t context, uint8_t run_lb, uint32_t lb_timeout_s, uint8_t run_hb, uint32_t hb_timeout_s)
+{
+  VALIDATE_CONTEXT(context)
+
+  pthread_rwlock_rdlock(&(ctx->resident_lock));
+  struct NEPI_EDGE_Resident_Bot *resident = ctx->resident;
+  if (NULL == resident)
+  {
+    pthread_rwlock_unlock(&(ctx->resident_lock));
+    return NEPI_EDGE_RET_BOT_NOT_RUNNING;
+  }
+
+  // As with StartBot, the run should see exports still held back by a group-commit sync policy
+  NEPI_EDGE_StagingCommit(&(ctx->staging));
+
+  // The same assignments a one-shot launch puts in the bot's environment
+  char msg[RESIDENT_MESSAGE_MAX_LENGTH];
+  const int msg_len = snprintf(msg, sizeof(msg), "RUN_LB_LINK=%u\nLB_PROC_TIMEOUT=%u\nRUN_HB_LINK=%u\nHB_PROC_TIMEOUT=%u\n",
+                               run_lb, lb_timeout_s, run_hb, hb_timeout_s);
+
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_RET_OK;
+  pthread_mutex_lock(&(resident->lock));
+  if (-1 == resident->trigger_fd)
+  {
+    ret = NEPI_EDGE_RET_BOT_NOT_RUNNING; // Between restarts, or the supervisor has given up
+  }
+  else if (1 == resident->run_pending)
+  {
+    ret = NEPI_EDGE_RET_BOT_ALREADY_RUNNING;
+  }
+  else if (msg_len != send(resident->trigger_fd, msg, msg_len, MSG_NOSIGNAL))
+  {
+    ret = NEPI_EDGE_RET_CANT_START_BOT;
+  }
+  else
+  {
+    resident->run_pending = 1;
+  }
+  pthread_mutex_unlock(&(resident->lock));
+  pthread_rwlock_unlock(&(ctx->resident_lock));
+  return ret;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_WaitBotRun(int32_t timeout_ms)
+{
+  return NEPI_EDGE_WaitBotRunCtx(NEPI_EDGE_GetDefaultContext(), timeout_ms);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_WaitBotRunCtx(NEPI_EDGE_Context_t context, int32_t timeout_ms)
+{
+  VALIDATE_CONTEXT(context)
+
+  // A stop wakes this wait (the run fails as undetermined) before it needs the lock exclusively
+  pthread_rwlock_rdlock(&(ctx->resident_lock));
+  struct NEPI_EDGE_Resident_Bot *resident = ctx->resident;
+  if (NULL == resident)
+  {
+    pthread_rwlock_unlock(&(ctx->resident_lock));
+    return NEPI_EDGE_RET_BOT_NOT_RUNNING;
+  }
+
+  struct timespec deadline;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  if (timeout_ms > 0)
+  {
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+      deadline.tv_sec += 1;
+      deadline.tv_nsec -= 1000000000;
+    }
+  }
+
+  NEPI_EDGE_RET_t ret;
+  pthread_mutex_lock(&(resident->lock));
+  while (1 == resident->run_pending)
+  {
+    if (timeout_ms < 0)
+    {
+      pthread_cond_wait(&(resident->run_done), &(resident->lock));
+    }
+    else if (ETIMEDOUT == pthread_cond_timedwait(&(resident->run_done), &(resident->lock), &deadline))
+    {
+      break;
+    }
+  }
+  ret = (1 == resident->run_pending)? NEPI_EDGE_RET_TIMED_OUT : resident->last_run_ret;
+  pthread_mutex_unlock(&(resident->lock));
+  pthread_rwlock_unlock(&(ctx->resident_lock));
+  return ret;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_StopBotResident(uint32_t grace_ms)
+{
+  return NEPI_EDGE_StopBotResidentCtx(NEPI_EDGE_GetDefaultContext(), grace_ms);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_StopBotResidentCtx(NEPI_EDGE_Context_t context, uint32_t grace_ms)
+{
+  VALIDATE_CONTEXT(context)
+
+  // Ask the supervisor to stop while only sharing the lock, so a WaitBotRun blocked on the same bot is released
+  // (and lets go of the lock) instead of holding this stop up
+  pthread_rwlock_rdlock(&(ctx->resident_lock));
+  struct NEPI_EDGE_Resident_Bot *resident = ctx->resident;
+  if (NULL == resident)
+  {
+    pthread_rwlock_unlock(&(ctx->resident_lock));
+    return NEPI_EDGE_RET_BOT_NOT_RUNNING;
+  }
+  const uint32_t generation = ctx->resident_generation;
+
+  pthread_mutex_lock(&(resident->lock));
+  resident->stop_grace_ms = grace_ms;
+  pthread_mutex_unlock(&(resident->lock));
+
+  // The pipe never fills: one byte is all the supervisor ever needs to see
+  const char stop_byte = 1;
+  while ((-1 == write(resident->wake_pipe[1], &stop_byte, 1)) && (EINTR == errno)) {}
+  pthread_rwlock_unlock(&(ctx->resident_lock));
+
+  // A concurrent stop may have finished the job in between, and another start may even have followed it. Only
+  // the bot that was sent the stop byte above can be joined; a later one (possibly at the same address) would
+  // never let its supervisor go.
+  pthread_rwlock_wrlock(&(ctx->resident_lock));
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_RET_BOT_NOT_RUNNING;
+  if ((NULL != ctx->resident) && (generation == ctx->resident_generation))
+  {
+    pthread_join(ctx->resident->supervisor, NULL);
+    destroy_resident(ctx->resident);
+    ctx->resident = NULL;
+    ret = NEPI_EDGE_RET_OK;
+  }
+  pthread_rwlock_unlock(&(ctx->resident_lock));
+  return ret;
+}
@@ -0,0 +1,520 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "nepi_edge_sdk_link.h"
+#include "nepi_edge_sdk_link_impl.h"
+#include "nepi_edge_file_map_impl.h"
+#include "nepi_edge_timestamp_impl.h"
+
+#include "frozen/frozen.h"
+
+#define EXEC_HISTORY_PERSIST_VERSION  1
+
+typedef struct
+{
+  NEPI_EDGE_LINK_TYPE_t link_type;
+  char comms_type[NEPI_EDGE_MAX_COMMS_TYPE_LENGTH];
+  NEPI_EDGE_LINK_STATE_t state;
+
+  // Newest at runs[(next + LENGTH - 1) % LENGTH]
+  NEPI_EDGE_Exec_History_Run_t runs[NEPI_EDGE_EXEC_HISTORY_LENGTH];
+  uint32_t next;
+  uint32_t count;
+} Exec_History_Link_t;
+
+struct NEPI_EDGE_Exec_History
+{
+  Exec_History_Link_t links[NEPI_EDGE_EXEC_HISTORY_MAX_LINKS];
+  size_t link_count;
+  uint64_t next_run_seq;
+
+  // Newest at events[(next_event + LENGTH - 1) % LENGTH]
+  NEPI_EDGE_Exec_History_Event_t events[NEPI_EDGE_EXEC_HISTORY_EVENT_LENGTH];
+  uint32_t next_event;
+  uint32_t event_count;
+  uint64_t next_event_seq;
+
+  // The status files last recorded, to skip them when they come around again
+  NEPI_EDGE_Exec_Status_File_Id_t lb_file_id;
+  NEPI_EDGE_Exec_Status_File_Id_t hb_file_id;
+
+  char persist_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH]; // Empty for none
+
+  NEPI_EDGE_Opaque_Helper_t opaque_helper;
+};
+
+static Exec_History_Link_t* findLink(struct NEPI_EDGE_Exec_History *history, NEPI_EDGE_LINK_TYPE_t link_type, const char *comms_type)
+{
+  for (size_t i = 0; i < history->link_count; ++i)
+  {
+    Exec_History_Link_t *link = &(history->links[i]);
+    if ((link->link_type == link_type) && (0 == strcmp(link->comms_type, comms_type))) return link;
+  }
+  return NULL;
+}
+
+static void addEvent(struct NEPI_EDGE_Exec_History *history, const Exec_History_Link_t *link, const NEPI_EDGE_Exec_History_Run_t *run)
+{
+  NEPI_EDGE_Exec_History_Event_t *event = &(history->events[history->next_event]);
+  event->seq = history->next_event_seq++;
+  event->link_type = link->link_type;
+  memcpy(event->comms_type, link->comms_type, sizeof(event->comms_type));
+  event->state = link->state;
+  event->time_ms = (1 == run->has_times)? run->start_time_ms : 0;
+
+  history->next_event = (history->next_event + 1) % NEPI_EDGE_EXEC_HISTORY_EVENT_LENGTH;
+  if (history->event_count < NEPI_EDGE_EXEC_HISTORY_EVENT_LENGTH) ++(history->event_count);
+}
+
+// run->seq is assigned here unless replaying persisted runs, which keep theirs and raise no events
+static void addRun(struct NEPI_EDGE_Exec_History *history, NEPI_EDGE_LINK_TYPE_t link_type, const char *comms_type,
+                   NEPI_EDGE_Exec_History_Run_t *run, uint8_t replaying)
+{
+  const size_t comms_type_len = strnlen(comms_type, NEPI_EDGE_MAX_COMMS_TYPE_LENGTH);
+  if (NEPI_EDGE_MAX_COMMS_TYPE_LENGTH == comms_type_len) return;
+
+  Exec_History_Link_t *link = findLink(history, link_type, comms_type);
+  if (NULL == link)
+  {
+    if (NEPI_EDGE_EXEC_HISTORY_MAX_LINKS == history->link_count) return;
+
+    link = &(history->links[history->link_count]);
+    ++(history->link_count);
+    memset(link, 0, sizeof(*link));
+    link->link_type = link_type;
+    memcpy(link->comms_type, comms_type, comms_type_len + 1);
+    link->state = NEPI_EDGE_LINK_STATE_UNKNOWN;
+  }
+
+  if (1 == replaying)
+  {
+    if (run->seq >= history->next_run_seq) history->next_run_seq = run->seq + 1;
+  }
+  else
+  {
+    run->seq = history->next_run_seq++;
+  }
+
+  link->runs[link->next] = *run;
+  link->next = (link->next + 1) % NEPI_EDGE_EXEC_HISTORY_LENGTH;
+  if (link->count < NEPI_EDGE_EXEC_HISTORY_LENGTH) ++(link->count);
+
+  NEPI_EDGE_LINK_STATE_t state = link->state;
+  if (NEPI_EDGE_COMMS_STATUS_SUCCESS == run->status) state = NEPI_EDGE_LINK_STATE_UP;
+  else if (NEPI_EDGE_COMMS_STATUS_CONN_FAILED == run->status) state = NEPI_EDGE_LINK_STATE_DOWN;
+  if (state != link->state)
+  {
+    const uint8_t transition = (NEPI_EDGE_LINK_STATE_UNKNOWN != link->state)? 1 : 0;
+    link->state = state;
+    if ((1 == transition) && (0 == replaying)) addEvent(history, link, run);
+  }
+}
+
+static void runFromCommonHdr(const struct NEPI_EDGE_Connection_Status_Common_Hdr *hdr, NEPI_EDGE_Exec_History_Run_t *run)
+{
+  memset(run, 0, sizeof(*run));
+
+  run->status = (0 != (hdr->fields_set & NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Status))?
+    hdr->status : NEPI_EDGE_COMMS_STATUS_UNKNOWN;
+  if (0 != (hdr->fields_set & NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Warnings)) run->warning_count = hdr->warning_count;
+  if (0 != (hdr->fields_set & NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Errors)) run->error_count = hdr->error_count;
+
+  const uint32_t time_fields = NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Start_Time |
+                               NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Stop_Time;
+  int64_t start_ns, stop_ns;
+  if ((time_fields == (hdr->fields_set & time_fields)) &&
+      (NEPI_EDGE_RET_OK == NEPI_EDGE_TimestampParseRFC3339(hdr->start_time_rfc3339, &start_ns)) &&
+      (NEPI_EDGE_RET_OK == NEPI_EDGE_TimestampParseRFC3339(hdr->stop_time_rfc3339, &stop_ns)) &&
+      (stop_ns >= start_ns))
+  {
+    run->has_times = 1;
+    run->start_time_ms = start_ns / NEPI_EDGE_NSEC_PER_MSEC;
+    run->duration_ms = (uint32_t)((stop_ns - start_ns) / NEPI_EDGE_NSEC_PER_MSEC);
+  }
+}
+
+// Makes a completed rename of a file in this directory durable
+static int syncParentDir(const char *path)
+{
+  char dir_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  strncpy(dir_path, path, sizeof(dir_path) - 1);
+  dir_path[sizeof(dir_path) - 1] = '\0';
+  char *last_slash = strrchr(dir_path, '/');
+  if (NULL == last_slash) strcpy(dir_path, ".");
+  else if (last_slash == dir_path) last_slash[1] = '\0'; // Directly under /
+  else *last_slash = '\0';
+
+  const int fd = open(dir_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (-1 == fd) return -1;
+  const int ret = fsync(fd);
+  close(fd);
+  return ret;
+}
+
+static NEPI_EDGE_RET_t save(const struct NEPI_EDGE_Exec_History *history)
+{
+  // persist_path was checked at create to leave room for the suffix
+  char tmp_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH + 5];
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", history->persist_path);
+  FILE *f = fopen(tmp_path, "w");
+  if (NULL == f) return NEPI_EDGE_RET_FILE_OPEN_ERR;
+
+  struct json_out out = JSON_OUT_FILE(f);
+  fprintf(f, "{\n  \"version\": %d,\n", EXEC_HISTORY_PERSIST_VERSION);
+  const NEPI_EDGE_Exec_Status_File_Id_t *ids[2] = {&(history->lb_file_id), &(history->hb_file_id)};
+  const char *id_names[2] = {"lb_file", "hb_file"};
+  for (int i = 0; i < 2; ++i)
+  {
+    fprintf(f, "  \"%s\": {\"known\": %u, \"exists\": %u, \"dev\": %llu, \"ino\": %llu, \"size\": %lld, \"mtime_s\": %lld, "
+            "\"mtime_ns\": %ld},\n", id_names[i], ids[i]->known, ids[i]->exists, (unsigned long long)ids[i]->dev,
+            (unsigned long long)ids[i]->ino, (long long)ids[i]->size, (long long)ids[i]->mtime.tv_sec, ids[i]->mtime.tv_nsec);
+  }
+
+  // Oldest first across all links, so loading replays them in the order they were recorded
+  fprintf(f, "  \"runs\": [");
+  uint32_t cursors[NEPI_EDGE_EXEC_HISTORY_MAX_LINKS] = {0};
+  uint8_t first = 1;
+  while (1)
+  {
+    const Exec_History_Link_t *link = NULL;
+    const NEPI_EDGE_Exec_History_Run_t *run = NULL;
+    size_t link_index = 0;
+    for (size_t i = 0; i < history->link_count; ++i)
+    {
+      const Exec_History_Link_t *l = &(history->links[i]);
+      if (cursors[i] == l->count) continue;
+      const NEPI_EDGE_Exec_History_Run_t *r =
+        &(l->runs[(l->next + NEPI_EDGE_EXEC_HISTORY_LENGTH - l->count + cursors[i]) % NEPI_EDGE_EXEC_HISTORY_LENGTH]);
+      if ((NULL == run) || (r->seq < run->seq))
+      {
+        link = l;
+        run = r;
+        link_index = i;
+      }
+    }
+    if (NULL == run) break;
+    ++(cursors[link_index]);
+
+    fprintf(f, "%s\n    {\"seq\": %llu, \"link\": \"%s\", \"comms_type\": ", (1 == first)? "" : ",",
+            (unsigned long long)run->seq, (NEPI_EDGE_LINK_TYPE_LB == link->link_type)? "lb" : "hb");
+    json_printf(&out, "%Q", link->comms_type);
+    fprintf(f, ", \"has_times\": %u, \"start_time_ms\": %lld, \"duration_ms\": %u, \"status\": %d, \"warnings\": %u, "
+            "\"errors\": %u, \"msgsent\": %u, \"pktsent\": %u, \"msgrecv\": %u, \"statsent\": %u, \"datasent\": %u, "
+            "\"gensent\": %u, \"cfgrecv\": %u, \"genrecv\": %u, \"dtype\": %d, \"datasent_kB\": %u, \"datarecv_kB\": %u, "
+            "\"numdirs\": %u, \"numfiles\": %u}",
+            run->has_times, (long long)run->start_time_ms, run->duration_ms, run->status, run->warning_count,
+            run->error_count, run->msgs_sent, run->pkts_sent, run->msgs_rcvd, run->stat_msgs_sent, run->data_msgs_sent,
+            run->gen_msgs_sent, run->cfg_msgs_rcvd, run->gen_msgs_rcvd, run->direction, run->datasent_kB,
+            run->datareceived_kB, run->num_dirs, run->num_files);
+    first = 0;
+  }
+  fprintf(f, "\n  ]\n}\n");
+
+  // Swap in whole, so a reader or a crash never sees a partial file. The contents must be on disk before the rename
+  // is, or a crash could leave the new name pointing at an empty or partial file.
+  const int write_failed = (0 != fflush(f)) || (0 != ferror(f)) || (0 != fsync(fileno(f)));
+  if ((0 != fclose(f)) || (0 != write_failed) || (0 != rename(tmp_path, history->persist_path)))
+  {
+    unlink(tmp_path);
+    return NEPI_EDGE_RET_FILE_WRITE_ERROR;
+  }
+  if (0 != syncParentDir(history->persist_path)) return NEPI_EDGE_RET_FILE_WRITE_ERROR;
+  return NEPI_EDGE_RET_OK;
+}
+
+static void loadFileId(const char *json, int json_len, const char *name, NEPI_EDGE_Exec_Status_File_Id_t *id)
+{
+  char fmt[160];
+  snprintf(fmt, sizeof(fmt), "{%s: {known: %%u, exists: %%u, dev: %%llu, ino: %%llu, size: %%lld, mtime_s: %%lld, mtime_ns: %%ld}}", name);
+  unsigned int known = 0, exists = 0;
+  unsigned long long dev = 0, ino = 0;
+  long long size = 0, mtime_s = 0;
+  long mtime_ns = 0;
+  memset(id, 0, sizeof(*id));
+  if (7 != json_scanf(json, json_len, fmt, &known, &exists, &dev, &ino, &size, &mtime_s, &mtime_ns)) return; // Left unknown
+
+  id->known = (uint8_t)known;
+  id->exists = (uint8_t)exists;
+  id->dev = (dev_t)dev;
+  id->ino = (ino_t)ino;
+  id->size = (off_t)size;
+  id->mtime.tv_sec = (time_t)mtime_s;
+  id->mtime.tv_nsec = mtime_ns;
+}
+
+static NEPI_EDGE_RET_t load(struct NEPI_EDGE_Exec_History *history)
+{
+  if (0 != access(history->persist_path, F_OK)) return NEPI_EDGE_RET_OK; // Nothing recorded yet
+
+  NEPI_EDGE_File_Map_t *map;
+  if (NEPI_EDGE_RET_OK != NEPI_EDGE_FileMapOpen(history->persist_path, &map)) return NEPI_EDGE_RET_INVALID_FILE_FORMAT;
+  const int len = (int)map->length;
+
+  int version = 0;
+  if ((1 != json_scanf(map->data, len, "{version: %d}", &version)) || (EXEC_HISTORY_PERSIST_VERSION != version))
+  {
+    NEPI_EDGE_FileMapCloseAll(map);
+    return NEPI_EDGE_RET_INVALID_FILE_FORMAT;
+  }
+
+  loadFileId(map->data, len, "lb_file", &(history->lb_file_id));
+  loadFileId(map->data, len, "hb_file", &(history->hb_file_id));
+
+  struct json_token run_token;
+  for (int i = 0; json_scanf_array_elem(map->data, len, ".runs", i, &run_token) > 0; ++i)
+  {
+    unsigned long long seq = 0;
+    char *link_name = NULL;
+    char *comms_type = NULL;
+    unsigned int has_times = 0;
+    long long start_time_ms = 0;
+    int status = NEPI_EDGE_COMMS_STATUS_UNKNOWN, direction = NEPI_EDGE_HB_DIRECTION_UNKNOWN;
+    NEPI_EDGE_Exec_History_Run_t run;
+    memset(&run, 0, sizeof(run));
+    const int scanned = json_scanf(run_token.ptr, run_token.len,
+                                   "{seq: %llu, link: %Q, comms_type: %Q, has_times: %u, start_time_ms: %lld, duration_ms: %u, "
+                                   "status: %d, warnings: %u, errors: %u, msgsent: %u, pktsent: %u, msgrecv: %u, statsent: %u, "
+                                   "datasent: %u, gensent: %u, cfgrecv: %u, genrecv: %u, dtype: %d, datasent_kB: %u, "
+                                   "datarecv_kB: %u, numdirs: %u, numfiles: %u}",
+                                   &seq, &link_name, &comms_type, &has_times, &start_time_ms, &(run.duration_ms), &status,
+                                   &(run.warning_count), &(run.error_count), &(run.msgs_sent), &(run.pkts_sent),
+                                   &(run.msgs_rcvd), &(run.stat_msgs_sent), &(run.data_msgs_sent), &(run.gen_msgs_sent),
+                                   &(run.cfg_msgs_rcvd), &(run.gen_msgs_rcvd), &direction, &(run.datasent_kB),
+                                   &(run.datareceived_kB), &(run.num_dirs), &(run.num_files));
+    if ((scanned < 7) || (NULL == link_name) || (NULL == comms_type) ||
+        ((0 != strcmp(link_name, "lb")) && (0 != strcmp(link_name, "hb"))))
+    {
+      free(link_name);
+      free(comms_type);
+      NEPI_EDGE_FileMapCloseAll(map);
+      return NEPI_EDGE_RET_INVALID_FILE_FORMAT;
+    }
+
+    run.seq = seq;
+    run.has_times = (uint8_t)has_times;
+    run.start_time_ms = start_time_ms;
+    run.status = (NEPI_EDGE_COMMS_STATUS_t)status;
+    run.direction = (NEPI_EDGE_HB_DIRECTION_t)direction;
+    addRun(history, (0 == strcmp(link_name, "lb"))? NEPI_EDGE_LINK_TYPE_LB : NEPI_EDGE_LINK_TYPE_HB, comms_type, &run, 1);
+
+    // Strings scanned with %Q are malloc'd by frozen
+    free(link_name);
+    free(comms_type);
+  }
+
+  NEPI_EDGE_FileMapCloseAll(map);
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_ExecHistoryCreate(NEPI_EDGE_Exec_History_t *history, const char *persist_path)
+{
+  // Leave room for the ".tmp" the save goes through
+  if ((NULL != persist_path) && (strnlen(persist_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH) + 5 > NEPI_EDGE_MAX_FILE_PATH_LENGTH))
+  {
+    return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
+  }
+
+  *history = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_Exec_History));
+  if (NULL == *history) return NEPI_EDGE_RET_MALLOC_ERR;
+
+  struct NEPI_EDGE_Exec_History *p = (struct NEPI_EDGE_Exec_History*)(*history);
+  memset(p, 0, sizeof(*p)); // No links or events, and both file ids unknown
+  p->next_run_seq = 1;
+  p->next_event_seq = 1;
+  p->opaque_helper.msg_id = NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_HISTORY;
+
+  if (NULL != persist_path)
+  {
+    strncpy(p->persist_path, persist_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH - 1);
+    const NEPI_EDGE_RET_t ret = load(p);
+    if (NEPI_EDGE_RET_OK != ret)
+    {
+      NEPI_EDGE_FREE(p);
+      *history = NULL;
+      return ret;
+    }
+  }
+
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_ExecHistoryDestroy(NEPI_EDGE_Exec_History_t history)
+{
+  VALIDATE_OPAQUE_TYPE(history, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_HISTORY, NEPI_EDGE_Exec_History)
+
+  NEPI_EDGE_FREE(p);
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_ExecHistoryRecord(NEPI_EDGE_Exec_History_t history, NEPI_EDGE_Exec_Status_t exec_status)
+{
+  VALIDATE_OPAQUE_TYPE(history, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_HISTORY, NEPI_EDGE_Exec_History)
+  if (NULL == exec_status) return NEPI_EDGE_RET_UNINIT_OBJ;
+  struct NEPI_EDGE_Exec_Status *exec = (struct NEPI_EDGE_Exec_Status*)exec_status;
+  if (exec->opaque_helper.msg_id != NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS) return NEPI_EDGE_RET_WRONG_OBJ_TYPE;
+
+  uint8_t recorded = 0;
+  NEPI_EDGE_Exec_History_Run_t run;
+
+  // A part that failed to read isn't known, and one whose file doesn't exist has no runs to record
+  if ((1 == exec->lb_file.id.known) && (1 == exec->lb_file.id.exists) &&
+      (0 == NEPI_EDGE_ExecStatusFileIdsMatch(&(exec->lb_file.id), &(p->lb_file_id))))
+  {
+    for (size_t i = 0; i < exec->lb_conn_count; ++i)
+    {
+      const struct NEPI_EDGE_LB_Connection_Status *conn = &(exec->lb_conn_status[i]);
+      if (0 == (conn->hdr.fields_set & NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Comms_Type)) continue;
+
+      // Entries start zeroed, so counts the bot left out read 0
+      runFromCommonHdr(&(conn->hdr), &run);
+      run.msgs_sent = conn->messages_sent;
+      run.pkts_sent = conn->packets_sent;
+      run.msgs_rcvd = conn->messages_received;
+      run.stat_msgs_sent = conn->stat_messages_sent;
+      run.data_msgs_sent = conn->data_messages_sent;
+      run.gen_msgs_sent = conn->gen_messages_sent;
+      run.cfg_msgs_rcvd = conn->cfg_messages_received;
+      run.gen_msgs_rcvd = conn->gen_messages_received;
+      run.direction = NEPI_EDGE_HB_DIRECTION_UNKNOWN;
+      addRun(p, NEPI_EDGE_LINK_TYPE_LB, conn->hdr.comms_type, &run, 0);
+    }
+    p->lb_file_id = exec->lb_file.id;
+    recorded = 1;
+  }
+
+  if ((1 == exec->hb_file.id.known) && (1 == exec->hb_file.id.exists) &&
+      (0 == NEPI_EDGE_ExecStatusFileIdsMatch(&(exec->hb_file.id), &(p->hb_file_id))))
+  {
+    for (size_t i = 0; i < exec->hb_conn_count; ++i)
+    {
+      const struct NEPI_EDGE_HB_Connection_Status *conn = &(exec->hb_conn_status[i]);
+      if (0 == (conn->hdr.fields_set & NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Comms_Type)) continue;
+
+      runFromCommonHdr(&(conn->hdr), &run);
+      run.direction = (0 != (conn->hdr.fields_set & NEPI_EDGE_HB_Connection_Status_Fields_Dtype))?
+        conn->direction : NEPI_EDGE_HB_DIRECTION_UNKNOWN;
+      run.datasent_kB = conn->datasent_kB;
+      run.datareceived_kB = conn->datareceived_kB;
+      run.num_dirs = conn->num_dirs;
+      run.num_files = conn->num_files;
+      addRun(p, NEPI_EDGE_LINK_TYPE_HB, conn->hdr.comms_type, &run, 0);
+    }
+    p->hb_file_id = exec->hb_file.id;
+    recorded = 1;
+  }
+
+  if ((1 == recorded) && ('\0' != p->persist_path[0])) return save(p);
+  return NEPI_EDGE_RET_OK;
+}
+
+static int compareDurations(const void *a, const void *b)
+{
+  const uint32_t x = *(const uint32_t*)a;
+  const uint32_t y = *(const uint32_t*)b;
+  return (x > y) - (x < y);
+}
+
+static void linkStats(const Exec_History_Link_t *link, uint8_t percentile, NEPI_EDGE_Exec_History_Link_Stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+  stats->link_type = link->link_type;
+  memcpy(stats->comms_type, link->comms_type, sizeof(stats->comms_type));
+  stats->state = link->state;
+  stats->run_count = link->count;
+
+  uint32_t durations[NEPI_EDGE_EXEC_HISTORY_LENGTH];
+  uint64_t bytes = 0, pkts = 0, msgs = 0;
+  for (uint32_t i = 0; i < link->count; ++i)
+  {
+    const NEPI_EDGE_Exec_History_Run_t *run = &(link->runs[i]); // Order doesn't matter here
+    if ((NEPI_EDGE_COMMS_STATUS_SUCCESS != run->status) && (NEPI_EDGE_COMMS_STATUS_CONN_FAILED != run->status)) continue;
+    ++(stats->attempt_count);
+
+    if (NEPI_EDGE_COMMS_STATUS_SUCCESS != run->status) continue;
+    ++(stats->success_count);
+
+    if (0 == run->has_times) continue;
+    durations[stats->timed_run_count] = run->duration_ms;
+    ++(stats->timed_run_count);
+    stats->total_duration_ms += run->duration_ms;
+    if (run->duration_ms > stats->max_duration_ms) stats->max_duration_ms = run->duration_ms;
+    bytes += ((uint64_t)run->datasent_kB + run->datareceived_kB) * 1024;
+    pkts += run->pkts_sent;
+    msgs += (uint64_t)run->msgs_sent + run->msgs_rcvd;
+  }
+
+  if (stats->attempt_count > 0) stats->success_ratio = (float)stats->success_count / (float)stats->attempt_count;
+
+  if (stats->timed_run_count > 0)
+  {
+    qsort(durations, stats->timed_run_count, sizeof(durations[0]), compareDurations);
+    // Nearest rank: the smallest duration with at least percentile% of them at or below it
+    uint32_t rank = (uint32_t)((percentile * stats->timed_run_count + 99) / 100);
+    if (rank < 1) rank = 1;
+    stats->duration_percentile_ms = durations[rank - 1];
+  }
+
+  if (stats->total_duration_ms > 0)
+  {
+    const double seconds = (double)stats->total_duration_ms / 1000.0;
+    stats->bytes_per_s = (double)bytes / seconds;
+    stats->pkts_per_s = (double)pkts / seconds;
+    stats->msgs_per_s = (double)msgs / seconds;
+  }
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_ExecHistoryGetLinkStats(NEPI_EDGE_Exec_History_t history, uint8_t percentile,
+                                                  NEPI_EDGE_Exec_History_Link_Stats_t *stats, size_t max_links,
+                                                  size_t *link_count)
+{
+  VALIDATE_OPAQUE_TYPE(history, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_HISTORY, NEPI_EDGE_Exec_History)
+  if (percentile > 100) return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
+
+  *link_count = (p->link_count < max_links)? p->link_count : max_links;
+  for (size_t i = 0; i < *link_count; ++i)
+  {
+    linkStats(&(p->links[i]), percentile, &(stats[i]));
+  }
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_ExecHistoryGetRuns(NEPI_EDGE_Exec_History_t history, NEPI_EDGE_LINK_TYPE_t link_type,
+                                             const char *comms_type, NEPI_EDGE_Exec_History_Run_t *runs, size_t max_runs,
+                                             size_t *run_count)
+{
+  VALIDATE_OPAQUE_TYPE(history, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_HISTORY, NEPI_EDGE_Exec_History)
+
+  *run_count = 0;
+  const Exec_History_Link_t *link = findLink(p, link_type, comms_type);
+  if (NULL == link) return NEPI_EDGE_RET_PARAM_NOT_FOUND;
+
+  *run_count = (link->count < max_runs)? link->count : max_runs;
+  for (size_t i = 0; i < *run_count; ++i)
+  {
+    runs[i] = link->runs[(link->next + NEPI_EDGE_EXEC_HISTORY_LENGTH - 1 - i) % NEPI_EDGE_EXEC_HISTORY_LENGTH];
+  }
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_ExecHistoryGetEvents(NEPI_EDGE_Exec_History_t history, NEPI_EDGE_Exec_History_Event_t *events,
+                                               size_t max_events, size_t *event_count)
+{
+  VALIDATE_OPAQUE_TYPE(history, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_HISTORY, NEPI_EDGE_Exec_History)
+
+  *event_count = (p->event_count < max_events)? p->event_count : max_events;
+  for (size_t i = 0; i < *event_count; ++i)
+  {
+    events[i] = p->events[(p->next_event + NEPI_EDGE_EXEC_HISTORY_EVENT_LENGTH - 1 - i) % NEPI_EDGE_EXEC_HISTORY_EVENT_LENGTH];
+  }
+  return NEPI_EDGE_RET_OK;
+}
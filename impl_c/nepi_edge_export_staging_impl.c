@@ -0,0 +1,497 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#define _GNU_SOURCE // syncfs(), renameat2()
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "nepi_edge_export_staging_impl.h"
+#include "nepi_edge_lb_interface.h"
+#include "nepi_edge_sdk_link_impl.h"
+
+// Shared by every context, since two of them may stage under the same data root
+static atomic_uint staging_seq;
+
+uint32_t NEPI_EDGE_StagingNextSequence(void)
+{
+  return atomic_fetch_add_explicit(&staging_seq, 1, memory_order_relaxed);
+}
+
+static uint64_t monotonic_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+static int fsync_dir(const char *path)
+{
+  const int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (-1 == fd) return -1;
+  const int ret = fsync(fd);
+  close(fd);
+  return ret;
+}
+
+static int sync_filesystem(const char *path)
+{
+#ifdef __linux__
+  const int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (-1 == fd) return -1;
+  const int ret = syncfs(fd);
+  close(fd);
+  return ret;
+#else
+  sync();
+  return 0;
+#endif
+}
+
+#ifdef NEPI_EDGE_HAVE_RENAMEAT2
+// Serializes merges by this process so each one swaps in a folder built from the latest published one
+static pthread_mutex_t merge_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Hard-link every entry of from_path into to_path. Unless replace is set, names to_path already has are kept.
+static int link_entries(const char *from_path, const char *to_path, uint8_t replace)
+{
+  DIR *dir = opendir(from_path);
+  if (NULL == dir) return -1;
+
+  int ret = 0;
+  struct dirent *entry;
+  while (NULL != (entry = readdir(dir)))
+  {
+    if ((0 == strcmp(entry->d_name, ".")) || (0 == strcmp(entry->d_name, ".."))) continue;
+
+    char src[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+    char dest[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+    snprintf(src, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", from_path, entry->d_name);
+    snprintf(dest, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", to_path, entry->d_name);
+    if (0 == link(src, dest)) continue;
+    if ((EEXIST == errno) && (0 == replace)) continue;
+    if ((EEXIST == errno) && (0 == unlink(dest)) && (0 == link(src, dest))) continue;
+    ret = -1;
+    break;
+  }
+  const int link_errno = errno;
+  closedir(dir);
+  errno = link_errno;
+  return ret;
+}
+#endif
+
+// Merge staging_path into an already-existing final_path. A fresh staging directory gets links to everything in the
+// published folder plus the new export (whose files win on a name clash) and is then swapped with it in one step,
+// so the bot sees the folder either as it was or fully merged, never partway. Without the swap there is no way to
+// do that, and a folder under any other name is one the bot wouldn't look for, so the export fails instead.
+static NEPI_EDGE_RET_t merge_into_existing(const char *data_root, const char *staging_path, const char *final_path,
+                                           uint8_t sync_each_file)
+{
+#ifdef NEPI_EDGE_HAVE_RENAMEAT2
+  char merge_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  if (NEPI_EDGE_RET_OK != NEPI_EDGE_StagingCreate(data_root, merge_path)) return NEPI_EDGE_RET_FILE_MOVE_ERROR;
+
+  pthread_mutex_lock(&merge_lock);
+  int swapped = 0;
+  if ((0 == link_entries(final_path, merge_path, 0)) && (0 == link_entries(staging_path, merge_path, 1)) &&
+      ((0 == sync_each_file) || (0 == fsync_dir(merge_path))))
+  {
+    swapped = (0 == renameat2(AT_FDCWD, merge_path, AT_FDCWD, final_path, RENAME_EXCHANGE));
+  }
+  const int swap_errno = errno;
+
+  if (swapped)
+  {
+    // merge_path now names the old folder. Another process merging at the same time could have added files to it
+    // after they were linked above, so carry any of those over before letting it go.
+    link_entries(merge_path, final_path, 0);
+  }
+  pthread_mutex_unlock(&merge_lock);
+
+  // Either the old folder or the abandoned merge; everything worth keeping in it is also linked elsewhere
+  NEPI_EDGE_StagingDiscard(merge_path, 0);
+  if (swapped)
+  {
+    NEPI_EDGE_StagingDiscard(staging_path, 0);
+    return NEPI_EDGE_RET_OK;
+  }
+
+  // The bot took the existing folder in the meantime, so there is nothing left to merge with
+  if ((ENOENT == swap_errno) && (0 == rename(staging_path, final_path))) return NEPI_EDGE_RET_OK;
+#else
+  (void)data_root;
+  (void)staging_path;
+  (void)final_path;
+  (void)sync_each_file;
+#endif
+  return NEPI_EDGE_RET_FILE_MOVE_ERROR;
+}
+
+static NEPI_EDGE_RET_t rename_into_place(const char *data_root, const char *staging_path, const char *final_path,
+                                         uint8_t sync_each_file)
+{
+  if (0 == rename(staging_path, final_path)) return NEPI_EDGE_RET_OK;
+
+  // An export with the same timestamp was already published -- fall back to merging into it
+  if ((EEXIST == errno) || (ENOTEMPTY == errno))
+  {
+    return merge_into_existing(data_root, staging_path, final_path, sync_each_file);
+  }
+  return NEPI_EDGE_RET_FILE_MOVE_ERROR;
+}
+
+// An export that can't be published would never reach the bot, so its staging folder isn't left behind to pile up
+static NEPI_EDGE_RET_t publish_or_discard(const char *data_root, const NEPI_EDGE_Staged_Export_t *staged,
+                                          const char *final_path, uint8_t sync_each_file)
+{
+  const NEPI_EDGE_RET_t ret = rename_into_place(data_root, staged->staging_path, final_path, sync_each_file);
+  if (NEPI_EDGE_RET_OK != ret) NEPI_EDGE_StagingDiscard(staged->staging_path, staged->keep_contents);
+  return ret;
+}
+
+// Caller holds state->pending_lock
+static NEPI_EDGE_RET_t commit_pending(NEPI_EDGE_Staging_State_t *state)
+{
+  if (0 == state->pending_count) return NEPI_EDGE_RET_OK;
+
+  NEPI_EDGE_Pending_Publish_t *pending = state->pending;
+
+  // One filesystem-wide flush makes the content of every pending export durable before any of them
+  // becomes visible, so a crash can never expose a published folder with unwritten files in it
+  if (0 != sync_filesystem(pending[0].data_root)) return NEPI_EDGE_RET_FILE_WRITE_ERROR;
+
+  // As for an immediate publish, one that fails is discarded rather than holding back the rest
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_RET_OK;
+  for (size_t i = 0; i < state->pending_count; ++i)
+  {
+    const NEPI_EDGE_RET_t publish_ret = rename_into_place(pending[i].data_root, pending[i].staging_path, pending[i].final_path, 0);
+    if (NEPI_EDGE_RET_OK != publish_ret)
+    {
+      NEPI_EDGE_StagingDiscard(pending[i].staging_path, pending[i].keep_contents);
+      if (NEPI_EDGE_RET_OK == ret) ret = publish_ret;
+    }
+    // Usually all pending entries share a parent, so this is one fsync in practice
+    if ((i + 1 == state->pending_count) || (0 != strcmp(pending[i].data_root, pending[i + 1].data_root)))
+    {
+      fsync_dir(pending[i].data_root);
+    }
+  }
+
+  state->pending_count = 0;
+  state->last_commit_ms = monotonic_ms();
+  return ret;
+}
+
+static void *flush_thread_main(void *arg)
+{
+  NEPI_EDGE_Staging_State_t *state = arg;
+  pthread_mutex_lock(&(state->pending_lock));
+  // A policy change may have stopped this thread and started another before it got to run again
+  while ((1 == state->flush_thread_running) && pthread_equal(state->flush_thread, pthread_self()))
+  {
+    if (0 == state->pending_count)
+    {
+      pthread_cond_wait(&(state->flush_cond), &(state->pending_lock));
+      continue;
+    }
+
+    const uint64_t now_ms = monotonic_ms();
+    const uint64_t due_ms = state->last_commit_ms + state->group_commit_interval_ms;
+    if (now_ms >= due_ms)
+    {
+      const NEPI_EDGE_RET_t ret = commit_pending(state);
+      if ((NEPI_EDGE_RET_OK != ret) && (NEPI_EDGE_RET_OK == state->flush_ret)) state->flush_ret = ret;
+      // A flush that failed outright left everything pending; wait out another interval rather than spinning
+      state->last_commit_ms = now_ms;
+      continue;
+    }
+
+    // The condition variable runs on the wall clock, so only the remaining time is carried over
+    const uint64_t wait_ms = due_ms - now_ms;
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += wait_ms / 1000;
+    deadline.tv_nsec += (long)(wait_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+      deadline.tv_sec += 1;
+      deadline.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(&(state->flush_cond), &(state->pending_lock), &deadline);
+  }
+  pthread_mutex_unlock(&(state->pending_lock));
+  return NULL;
+}
+
+// Caller holds state->pending_lock
+static void start_flush_thread(NEPI_EDGE_Staging_State_t *state)
+{
+  if (1 == state->flush_thread_running) return;
+  // Without the thread, exports are still published by the next export or commit past the interval
+  if (0 == pthread_create(&(state->flush_thread), NULL, flush_thread_main, state)) state->flush_thread_running = 1;
+}
+
+// Caller holds state->pending_lock, which is released
+static void stop_flush_thread_and_unlock(NEPI_EDGE_Staging_State_t *state)
+{
+  const uint8_t was_running = state->flush_thread_running;
+  const pthread_t flush_thread = state->flush_thread;
+  state->flush_thread_running = 0;
+  pthread_cond_broadcast(&(state->flush_cond));
+  pthread_mutex_unlock(&(state->pending_lock));
+
+  if (1 == was_running) pthread_join(flush_thread, NULL);
+}
+
+// Caller holds state->pending_lock
+static NEPI_EDGE_RET_t add_pending(NEPI_EDGE_Staging_State_t *state, const char *data_root,
+                                   const NEPI_EDGE_Staged_Export_t *staged, const char *final_path)
+{
+  if (state->pending_count == state->pending_capacity)
+  {
+    const size_t new_capacity = (0 == state->pending_capacity)? 8 : (2 * state->pending_capacity);
+    NEPI_EDGE_Pending_Publish_t *new_pending = NEPI_EDGE_MALLOC(new_capacity * sizeof(NEPI_EDGE_Pending_Publish_t));
+    if (NULL == new_pending) return NEPI_EDGE_RET_MALLOC_ERR;
+    if (NULL != state->pending)
+    {
+      memcpy(new_pending, state->pending, state->pending_count * sizeof(NEPI_EDGE_Pending_Publish_t));
+      NEPI_EDGE_FREE(state->pending);
+    }
+    state->pending = new_pending;
+    state->pending_capacity = new_capacity;
+  }
+
+  NEPI_EDGE_Pending_Publish_t *entry = &(state->pending[state->pending_count]);
+  strncpy(entry->data_root, data_root, NEPI_EDGE_MAX_FILE_PATH_LENGTH);
+  strncpy(entry->staging_path, staged->staging_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH);
+  strncpy(entry->final_path, final_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH);
+  entry->keep_contents = staged->keep_contents;
+  ++(state->pending_count);
+  return NEPI_EDGE_RET_OK;
+}
+
+void NEPI_EDGE_StagingStateInit(NEPI_EDGE_Staging_State_t *state)
+{
+  atomic_init(&(state->sync_policy), NEPI_EDGE_EXPORT_SYNC_NONE);
+  state->group_commit_interval_ms = 0;
+  state->pending = NULL;
+  state->pending_count = 0;
+  state->pending_capacity = 0;
+  state->last_commit_ms = 0;
+  pthread_mutex_init(&(state->pending_lock), NULL);
+  state->flush_thread_running = 0;
+  pthread_cond_init(&(state->flush_cond), NULL);
+  state->flush_ret = NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_StagingStateDestroy(NEPI_EDGE_Staging_State_t *state)
+{
+  pthread_mutex_lock(&(state->pending_lock));
+  stop_flush_thread_and_unlock(state);
+
+  pthread_mutex_lock(&(state->pending_lock));
+  NEPI_EDGE_RET_t ret = commit_pending(state);
+  if (NEPI_EDGE_RET_OK == ret) ret = state->flush_ret;
+  // If even the flush failed, what was pending stays behind as hidden staging folders
+  if (NULL != state->pending) NEPI_EDGE_FREE(state->pending);
+  state->pending = NULL;
+  state->pending_count = 0;
+  state->pending_capacity = 0;
+  pthread_mutex_unlock(&(state->pending_lock));
+
+  pthread_cond_destroy(&(state->flush_cond));
+  pthread_mutex_destroy(&(state->pending_lock));
+  return ret;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_StagingSetPolicy(NEPI_EDGE_Staging_State_t *state, NEPI_EDGE_Export_Sync_Policy_t policy,
+                                           uint32_t commit_interval_ms)
+{
+  if ((policy != NEPI_EDGE_EXPORT_SYNC_NONE) &&
+      (policy != NEPI_EDGE_EXPORT_SYNC_PER_EXPORT) &&
+      (policy != NEPI_EDGE_EXPORT_SYNC_GROUP_COMMIT))
+  {
+    return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
+  }
+
+  pthread_mutex_lock(&(state->pending_lock));
+  // Don't strand anything staged under the old policy
+  const NEPI_EDGE_RET_t ret = commit_pending(state);
+  if (NEPI_EDGE_RET_OK == ret)
+  {
+    atomic_store(&(state->sync_policy), policy);
+    state->group_commit_interval_ms = commit_interval_ms;
+  }
+
+  if (NEPI_EDGE_EXPORT_SYNC_GROUP_COMMIT == atomic_load(&(state->sync_policy)))
+  {
+    start_flush_thread(state);
+    pthread_cond_signal(&(state->flush_cond)); // Pick up the new interval
+    pthread_mutex_unlock(&(state->pending_lock));
+  }
+  else
+  {
+    stop_flush_thread_and_unlock(state);
+  }
+  return ret;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_StagingCommit(NEPI_EDGE_Staging_State_t *state)
+{
+  pthread_mutex_lock(&(state->pending_lock));
+  NEPI_EDGE_RET_t ret = commit_pending(state);
+  if (NEPI_EDGE_RET_OK == ret) ret = state->flush_ret;
+  state->flush_ret = NEPI_EDGE_RET_OK;
+  pthread_mutex_unlock(&(state->pending_lock));
+  return ret;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_StagingCreate(const char *data_root, char *staging_path)
+{
+  // A stale directory from an earlier process with the same PID is possible, so retry on collision
+  for (int attempt = 0; attempt < 16; ++attempt)
+  {
+    snprintf(staging_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/" NEPI_EDGE_STAGING_DIR_PREFIX "%d-%u" NEPI_EDGE_STAGING_DIR_SUFFIX,
+             data_root, (int)getpid(), NEPI_EDGE_StagingNextSequence());
+    if (0 == mkdir(staging_path, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH)) return NEPI_EDGE_RET_OK;
+    if (EEXIST != errno) break;
+  }
+  return NEPI_EDGE_RET_FILE_PERMISSION_ERR;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_StagingPublish(NEPI_EDGE_Staging_State_t *state, const char *data_root, const char *staging_path,
+                                         const char *final_name, uint8_t keep_contents)
+{
+  NEPI_EDGE_Staged_Export_t staged;
+  strncpy(staged.staging_path, staging_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH);
+  staged.final_name = final_name;
+  staged.keep_contents = keep_contents;
+  return NEPI_EDGE_StagingPublishBatch(state, data_root, &staged, 1);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_StagingPublishBatch(NEPI_EDGE_Staging_State_t *state, const char *data_root,
+                                              const NEPI_EDGE_Staged_Export_t *staged, size_t staged_count)
+{
+  if (0 == staged_count) return NEPI_EDGE_RET_OK;
+
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_RET_OK;
+  char final_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+
+  // Read under the lock, so nothing can be added to the pending list after a policy change has flushed it
+  pthread_mutex_lock(&(state->pending_lock));
+  const NEPI_EDGE_Export_Sync_Policy_t policy = atomic_load(&(state->sync_policy));
+  if (NEPI_EDGE_EXPORT_SYNC_GROUP_COMMIT != policy) pthread_mutex_unlock(&(state->pending_lock));
+
+  switch (policy)
+  {
+  case NEPI_EDGE_EXPORT_SYNC_PER_EXPORT:
+    // Files were fsync'd as they were written; now make the directory entries durable, then publish
+    for (size_t i = 0; i < staged_count; ++i)
+    {
+      if ((0 != fsync_dir(staged[i].staging_path)) && (NEPI_EDGE_RET_OK == ret)) ret = NEPI_EDGE_RET_FILE_WRITE_ERROR;
+      snprintf(final_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", data_root, staged[i].final_name);
+      const NEPI_EDGE_RET_t publish_ret = publish_or_discard(data_root, &(staged[i]), final_path, 1);
+      if (NEPI_EDGE_RET_OK == ret) ret = publish_ret;
+    }
+    // Even after a partial failure, whatever was renamed should be made durable
+    if ((0 != fsync_dir(data_root)) && (NEPI_EDGE_RET_OK == ret)) ret = NEPI_EDGE_RET_FILE_WRITE_ERROR;
+    return ret;
+
+  case NEPI_EDGE_EXPORT_SYNC_GROUP_COMMIT:
+    for (size_t i = 0; i < staged_count; ++i)
+    {
+      snprintf(final_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", data_root, staged[i].final_name);
+      if (NEPI_EDGE_RET_OK != add_pending(state, data_root, &(staged[i]), final_path))
+      {
+        // Can't be held back, so publish it now instead (without the group's durability)
+        const NEPI_EDGE_RET_t publish_ret = publish_or_discard(data_root, &(staged[i]), final_path, 0);
+        if (NEPI_EDGE_RET_OK == ret) ret = publish_ret;
+      }
+    }
+    if ((monotonic_ms() - state->last_commit_ms) >= state->group_commit_interval_ms)
+    {
+      const NEPI_EDGE_RET_t commit_ret = commit_pending(state);
+      if (NEPI_EDGE_RET_OK == ret) ret = commit_ret;
+    }
+    else
+    {
+      pthread_cond_signal(&(state->flush_cond)); // The flush thread may be idle with nothing pending until now
+    }
+    pthread_mutex_unlock(&(state->pending_lock));
+    return ret;
+
+  case NEPI_EDGE_EXPORT_SYNC_NONE:
+  default:
+    for (size_t i = 0; i < staged_count; ++i)
+    {
+      snprintf(final_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", data_root, staged[i].final_name);
+      const NEPI_EDGE_RET_t publish_ret = publish_or_discard(data_root, &(staged[i]), final_path, 0);
+      if (NEPI_EDGE_RET_OK == ret) ret = publish_ret;
+    }
+    return ret;
+  }
+}
+
+void NEPI_EDGE_StagingDiscard(const char *staging_path, uint8_t keep_contents)
+{
+  // Leaving the directory behind is harmless -- its hidden name keeps the bot from picking it up
+  if (keep_contents) return;
+
+  DIR *dir = opendir(staging_path);
+  if (NULL != dir)
+  {
+    struct dirent *entry;
+    while (NULL != (entry = readdir(dir)))
+    {
+      if ((0 == strcmp(entry->d_name, ".")) || (0 == strcmp(entry->d_name, ".."))) continue;
+      char tmp_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+      snprintf(tmp_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", staging_path, entry->d_name);
+      unlink(tmp_path);
+    }
+    closedir(dir);
+  }
+  rmdir(staging_path);
+}
+
+uint8_t NEPI_EDGE_StagingSyncEachFile(const NEPI_EDGE_Staging_State_t *state)
+{
+  return (NEPI_EDGE_EXPORT_SYNC_PER_EXPORT == atomic_load(&(state->sync_policy)))? 1 : 0;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBSetExportSyncPolicyCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Export_Sync_Policy_t policy,
+                                                   uint32_t commit_interval_ms)
+{
+  VALIDATE_CONTEXT(context)
+  return NEPI_EDGE_StagingSetPolicy(&(ctx->staging), policy, commit_interval_ms);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBSetExportSyncPolicy(NEPI_EDGE_Export_Sync_Policy_t policy, uint32_t commit_interval_ms)
+{
+  return NEPI_EDGE_LBSetExportSyncPolicyCtx(NEPI_EDGE_GetDefaultContext(), policy, commit_interval_ms);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBCommitExportsCtx(NEPI_EDGE_Context_t context)
+{
+  VALIDATE_CONTEXT(context)
+  return NEPI_EDGE_StagingCommit(&(ctx->staging));
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBCommitExports(void)
+{
+  return NEPI_EDGE_LBCommitExportsCtx(NEPI_EDGE_GetDefaultContext());
+}
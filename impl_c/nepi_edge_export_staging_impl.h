@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#ifndef __NEPI_EDGE_EXPORT_STAGING_IMPL_H
+#define __NEPI_EDGE_EXPORT_STAGING_IMPL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "nepi_edge_sdk_link.h"
+#include "nepi_edge_lb_interface.h"
+
+// Staging directories are dot-prefixed siblings of the published export folders so that the
+// final rename() never crosses a filesystem boundary
+#define NEPI_EDGE_STAGING_DIR_PREFIX   "."
+#define NEPI_EDGE_STAGING_DIR_SUFFIX   ".staging"
+
+typedef struct NEPI_EDGE_Pending_Publish
+{
+  char data_root[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  char staging_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  char final_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  uint8_t keep_contents;
+} NEPI_EDGE_Pending_Publish_t;
+
+// Sync policy and group-commit bookkeeping; each SDK context has its own
+typedef struct NEPI_EDGE_Staging_State
+{
+  // Changed under pending_lock; read without it only to decide how to write files into a staging directory
+  atomic_int sync_policy; // NEPI_EDGE_Export_Sync_Policy_t
+  uint32_t group_commit_interval_ms;
+
+  // Group-commit state: staged exports that are complete but not yet renamed into place
+  NEPI_EDGE_Pending_Publish_t *pending;
+  size_t pending_count;
+  size_t pending_capacity;
+  uint64_t last_commit_ms;
+  // The async export writer publishes from its own thread while the caller may commit (e.g., via NEPI_EDGE_StartBot)
+  pthread_mutex_t pending_lock;
+
+  // While group-commit is selected, a flush thread publishes held-back exports once the interval has passed, so the
+  // last export of a burst doesn't wait for another one to arrive
+  pthread_t flush_thread;
+  uint8_t flush_thread_running;
+  pthread_cond_t flush_cond;
+  NEPI_EDGE_RET_t flush_ret; // First flush-thread error, reported by the next explicit commit
+} NEPI_EDGE_Staging_State_t;
+
+#define NEPI_EDGE_STAGING_STATE_INITIALIZER \
+  { NEPI_EDGE_EXPORT_SYNC_NONE, 0, NULL, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER, 0, 0, PTHREAD_COND_INITIALIZER, \
+    NEPI_EDGE_RET_OK }
+
+void NEPI_EDGE_StagingStateInit(NEPI_EDGE_Staging_State_t *state);
+// Stops the flush thread and publishes anything still held back by group-commit, then releases the state. The
+// commit result is returned.
+NEPI_EDGE_RET_t NEPI_EDGE_StagingStateDestroy(NEPI_EDGE_Staging_State_t *state);
+
+// Change the sync policy, first committing anything staged under the old one
+NEPI_EDGE_RET_t NEPI_EDGE_StagingSetPolicy(NEPI_EDGE_Staging_State_t *state, NEPI_EDGE_Export_Sync_Policy_t policy,
+                                           uint32_t commit_interval_ms);
+// Publish everything held back by group-commit now. A failed commit by the flush thread since the last call is
+// reported here if this one succeeds.
+NEPI_EDGE_RET_t NEPI_EDGE_StagingCommit(NEPI_EDGE_Staging_State_t *state);
+
+// Process-wide, lock-free sequence for staging directory and staged file names. Concurrent exports that share a
+// timestamp are merged into one published folder, so every file in them needs a name no other export can produce.
+uint32_t NEPI_EDGE_StagingNextSequence(void);
+
+// Create a fresh, uniquely-named staging directory under data_root; staging_path must hold NEPI_EDGE_MAX_FILE_PATH_LENGTH
+NEPI_EDGE_RET_t NEPI_EDGE_StagingCreate(const char *data_root, char *staging_path);
+
+typedef struct NEPI_EDGE_Staged_Export
+{
+  char staging_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  const char *final_name; // Only needs to stay valid for the duration of the publish call
+  uint8_t keep_contents; // Passed to NEPI_EDGE_StagingDiscard if it can't be published
+} NEPI_EDGE_Staged_Export_t;
+
+// Publish a completely-written staging directory as data_root/final_name, honoring the current sync policy.
+// Under group-commit the rename may be deferred until the next commit point.
+NEPI_EDGE_RET_t NEPI_EDGE_StagingPublish(NEPI_EDGE_Staging_State_t *state, const char *data_root, const char *staging_path,
+                                         const char *final_name, uint8_t keep_contents);
+
+// As above for several staging directories under the same data_root; data_root is fsync'd (when required) once for all.
+// One that can't be published is discarded and the rest are still published; the first error is returned.
+NEPI_EDGE_RET_t NEPI_EDGE_StagingPublishBatch(NEPI_EDGE_Staging_State_t *state, const char *data_root,
+                                              const NEPI_EDGE_Staged_Export_t *staged, size_t staged_count);
+
+// Throw away a staging directory after a failed export. Files in it are removed unless keep_contents is set
+// (used when a caller-owned data file was already moved in and must not be lost).
+void NEPI_EDGE_StagingDiscard(const char *staging_path, uint8_t keep_contents);
+
+// Whether individual files written into a staging directory must be fsync'd before publication
+uint8_t NEPI_EDGE_StagingSyncEachFile(const NEPI_EDGE_Staging_State_t *state);
+
+#endif //__NEPI_EDGE_EXPORT_STAGING_IMPL_H
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#define _GNU_SOURCE // copy_file_range()
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h> // FICLONE
+#endif
+
+#include "nepi_edge_file_attach_impl.h"
+#include "nepi_edge_sdk_link_impl.h"
+
+#define FALLBACK_COPY_BUFFER_SIZE  (64 * 1024)
+
+// Errors meaning "this mechanism isn't available for this pair of files", i.e., try the next one
+static int is_unsupported_errno(int err)
+{
+  return ((EXDEV == err) || (EINVAL == err) || (ENOSYS == err) || (EOPNOTSUPP == err) ||
+          (ENOTTY == err) || (EPERM == err) || (EMLINK == err) || (ETXTBSY == err));
+}
+
+// Returns 0 when the whole file was copied, 1 when the mechanism is unsupported and nothing was written, -1 on error
+static int copy_in_kernel(int src_fd, int dest_fd, off_t size)
+{
+#ifdef NEPI_EDGE_HAVE_COPY_FILE_RANGE
+  off_t copied = 0;
+  while (copied < size)
+  {
+    const ssize_t ret = copy_file_range(src_fd, NULL, dest_fd, NULL, size - copied, 0);
+    if (ret < 0)
+    {
+      if (EINTR == errno) continue;
+      if ((0 == copied) && is_unsupported_errno(errno)) break; // Try sendfile
+      return -1;
+    }
+    if (0 == ret) return -1; // Source shrank underneath us
+    copied += ret;
+  }
+  if (copied == size) return 0;
+#endif
+
+#ifdef __linux__
+  off_t offset = 0;
+  while (offset < size)
+  {
+    const ssize_t ret = sendfile(dest_fd, src_fd, &offset, size - offset);
+    if (ret < 0)
+    {
+      if (EINTR == errno) continue;
+      if ((0 == offset) && is_unsupported_errno(errno)) return 1;
+      return -1;
+    }
+    if (0 == ret) return -1;
+  }
+  return 0;
+#else
+  (void)src_fd; (void)dest_fd; (void)size;
+  return 1;
+#endif
+}
+
+static int copy_in_userspace(int src_fd, int dest_fd)
+{
+  char *cpy_buf = NEPI_EDGE_MALLOC(FALLBACK_COPY_BUFFER_SIZE);
+  if (NULL == cpy_buf) return -1;
+
+  int ret = 0;
+  ssize_t block_byte_count;
+  while (0 != (block_byte_count = read(src_fd, cpy_buf, FALLBACK_COPY_BUFFER_SIZE)))
+  {
+    if (block_byte_count < 0)
+    {
+      if (EINTR == errno) continue;
+      ret = -1;
+      break;
+    }
+    const char *src = cpy_buf;
+    while (block_byte_count > 0)
+    {
+      const ssize_t written = write(dest_fd, src, block_byte_count);
+      if (written < 0)
+      {
+        if (EINTR == errno) continue;
+        ret = -1;
+        break;
+      }
+      src += written;
+      block_byte_count -= written;
+    }
+    if (0 != ret) break;
+  }
+
+  NEPI_EDGE_FREE(cpy_buf);
+  return ret;
+}
+
+static NEPI_EDGE_RET_t sync_existing_file(const char *filename)
+{
+  const int fd = open(filename, O_RDONLY | O_CLOEXEC);
+  if (-1 == fd) return NEPI_EDGE_RET_FILE_OPEN_ERR;
+  const int ret = fsync(fd);
+  close(fd);
+  return (0 == ret)? NEPI_EDGE_RET_OK : NEPI_EDGE_RET_FILE_WRITE_ERROR;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_AttachCopy(const char *src_filename, const char *dest_filename, uint8_t sync_to_disk)
+{
+  const int src_fd = open(src_filename, O_RDONLY | O_CLOEXEC);
+  if (-1 == src_fd) return NEPI_EDGE_RET_FILE_MOVE_ERROR;
+
+  struct stat src_stat;
+  if (0 != fstat(src_fd, &src_stat))
+  {
+    close(src_fd);
+    return NEPI_EDGE_RET_FILE_MOVE_ERROR;
+  }
+
+  // Same creation mode as fopen(dest_filename, "w")
+  const int dest_fd = open(dest_filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (-1 == dest_fd)
+  {
+    close(src_fd);
+    return NEPI_EDGE_RET_FILE_MOVE_ERROR;
+  }
+
+  int copy_ret = 1;
+#ifdef FICLONE
+  if (0 == ioctl(dest_fd, FICLONE, src_fd))
+  {
+    copy_ret = 0;
+  }
+#endif
+  if (1 == copy_ret)
+  {
+    copy_ret = copy_in_kernel(src_fd, dest_fd, src_stat.st_size);
+  }
+  if (1 == copy_ret)
+  {
+    copy_ret = copy_in_userspace(src_fd, dest_fd);
+  }
+
+  if ((0 == copy_ret) && sync_to_disk && (0 != fsync(dest_fd)))
+  {
+    copy_ret = -1;
+  }
+
+  close(src_fd);
+  if ((0 != close(dest_fd)) || (0 != copy_ret))
+  {
+    unlink(dest_filename);
+    return NEPI_EDGE_RET_FILE_MOVE_ERROR;
+  }
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_AttachMove(const char *src_filename, const char *dest_filename, uint8_t sync_to_disk)
+{
+  if (0 == rename(src_filename, dest_filename))
+  {
+    return sync_to_disk? sync_existing_file(dest_filename) : NEPI_EDGE_RET_OK;
+  }
+  if (EXDEV != errno) return NEPI_EDGE_RET_FILE_MOVE_ERROR;
+
+  // Cross-device: copy, and only remove the source once the copy is known good
+  const NEPI_EDGE_RET_t ret = NEPI_EDGE_AttachCopy(src_filename, dest_filename, sync_to_disk);
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+
+  if (0 != unlink(src_filename))
+  {
+    unlink(dest_filename);
+    return NEPI_EDGE_RET_FILE_DELETE_ERROR;
+  }
+  return NEPI_EDGE_RET_OK;
+}
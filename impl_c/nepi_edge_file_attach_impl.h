@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#ifndef __NEPI_EDGE_FILE_ATTACH_IMPL_H
+#define __NEPI_EDGE_FILE_ATTACH_IMPL_H
+
+#include <stdint.h>
+
+#include "nepi_edge_errors.h"
+
+// Make dest_filename an independent copy of src_filename as cheaply as the filesystem allows. The caller keeps
+// the source and may go on modifying it, so it is never hard-linked.
+//   1. ioctl(FICLONE)    -- copy-on-write reflink (btrfs, xfs, ...)
+//   2. copy_file_range() -- in-kernel copy, may be offloaded by the filesystem
+//   3. sendfile()        -- in-kernel copy
+//   4. read()/write()    -- plain userspace copy
+NEPI_EDGE_RET_t NEPI_EDGE_AttachCopy(const char *src_filename, const char *dest_filename, uint8_t sync_to_disk);
+
+// Move src_filename to dest_filename. rename() when possible; across filesystems this falls back
+// to NEPI_EDGE_AttachCopy followed by unlinking the source.
+NEPI_EDGE_RET_t NEPI_EDGE_AttachMove(const char *src_filename, const char *dest_filename, uint8_t sync_to_disk);
+
+#endif //__NEPI_EDGE_FILE_ATTACH_IMPL_H
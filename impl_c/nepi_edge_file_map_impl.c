@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "nepi_edge_file_map_impl.h"
+#include "nepi_edge_sdk_link_impl.h"
+
+static NEPI_EDGE_RET_t read_into_buffer(int fd, NEPI_EDGE_File_Map_t *map)
+{
+  map->data = NEPI_EDGE_MALLOC(map->length + 1);
+  if (NULL == map->data) return NEPI_EDGE_RET_MALLOC_ERR;
+
+  size_t total = 0;
+  while (total < map->length)
+  {
+    const ssize_t count = read(fd, map->data + total, map->length - total);
+    if (count < 0)
+    {
+      if (EINTR == errno) continue;
+      NEPI_EDGE_FREE(map->data);
+      return NEPI_EDGE_RET_FILE_OPEN_ERR;
+    }
+    if (0 == count) break; // Truncated since the fstat; take what is there
+    total += count;
+  }
+  map->length = total;
+  map->data[total] = '\0';
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_FileMapOpen(const char *filename, NEPI_EDGE_File_Map_t **map)
+{
+  const int fd = open(filename, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return NEPI_EDGE_RET_FILE_OPEN_ERR;
+
+  struct stat st;
+  if ((0 != fstat(fd, &st)) || !S_ISREG(st.st_mode))
+  {
+    close(fd);
+    return NEPI_EDGE_RET_FILE_OPEN_ERR;
+  }
+
+  NEPI_EDGE_File_Map_t *m = NEPI_EDGE_MALLOC(sizeof(NEPI_EDGE_File_Map_t));
+  if (NULL == m)
+  {
+    close(fd);
+    return NEPI_EDGE_RET_MALLOC_ERR;
+  }
+  m->length = st.st_size;
+  m->mapped_length = 0;
+  m->next = NULL;
+
+  // Only map when the file ends partway into a page: the kernel zero-fills the rest of that page, which supplies the
+  // terminating '\0'. An exact page multiple would leave no room, so it takes the read path like small files do.
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  if ((m->length >= NEPI_EDGE_FILE_MAP_MIN_LENGTH) && (0 != (m->length % page_size)))
+  {
+    void *addr = mmap(NULL, m->length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED != addr)
+    {
+      // The JSON walk is a single forward pass
+      madvise(addr, m->length, MADV_SEQUENTIAL);
+      m->data = addr;
+      m->mapped_length = m->length;
+    }
+  }
+
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_RET_OK;
+  if (0 == m->mapped_length)
+  {
+    ret = read_into_buffer(fd, m); // Also the fallback for filesystems that can't mmap
+  }
+  close(fd);
+
+  if (NEPI_EDGE_RET_OK != ret)
+  {
+    NEPI_EDGE_FREE(m);
+    return ret;
+  }
+
+  *map = m;
+  return NEPI_EDGE_RET_OK;
+}
+
+void NEPI_EDGE_FileMapCloseAll(NEPI_EDGE_File_Map_t *map)
+{
+  while (NULL != map)
+  {
+    NEPI_EDGE_File_Map_t *next = map->next;
+    if (0 != map->mapped_length)
+    {
+      munmap(map->data, map->mapped_length);
+    }
+    else
+    {
+      NEPI_EDGE_FREE(map->data);
+    }
+    NEPI_EDGE_FREE(map);
+    map = next;
+  }
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#ifndef __NEPI_EDGE_FILE_MAP_IMPL_H
+#define __NEPI_EDGE_FILE_MAP_IMPL_H
+
+#include <stddef.h>
+
+#include "nepi_edge_sdk_link.h"
+
+// Files smaller than this are read into a heap buffer; faulting in and tearing down a mapping costs more than the copy
+#define NEPI_EDGE_FILE_MAP_MIN_LENGTH  (64 * 1024)
+
+// A file's contents, either mmap'd (MAP_PRIVATE, so writable without touching the file) or read into a heap buffer.
+// data[length] is always '\0', so the contents can be handed to string functions and json_walk without a copy.
+// Maps are chained so that an object built from several imports can own all of them.
+typedef struct NEPI_EDGE_File_Map
+{
+  char *data;
+  size_t length;
+  size_t mapped_length; // 0 if data is a heap buffer
+  struct NEPI_EDGE_File_Map *next;
+} NEPI_EDGE_File_Map_t;
+
+NEPI_EDGE_RET_t NEPI_EDGE_FileMapOpen(const char *filename, NEPI_EDGE_File_Map_t **map);
+// Closes the map and every map chained after it
+void NEPI_EDGE_FileMapCloseAll(NEPI_EDGE_File_Map_t *map);
+
+#endif //__NEPI_EDGE_FILE_MAP_IMPL_H
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#include "nepi_edge_json_keys_impl.h"
+
+// Length and one distinguishing character pick the single candidate; one memcmp confirms it.
+// When adding a key, make sure it lands in a case with no other key of the same length and character.
+#define CONFIRM(literal, key) \
+  return (0 == memcmp(name, (literal), sizeof(literal) - 1))? (key) : NEPI_EDGE_JSON_KEY_UNKNOWN
+
+NEPI_EDGE_Json_Key_t NEPI_EDGE_JsonKeyLookup(const char *name, size_t name_len)
+{
+  if (NULL == name) return NEPI_EDGE_JSON_KEY_UNKNOWN;
+
+  switch (name_len)
+  {
+  case 3:
+    CONFIRM("b64", NEPI_EDGE_JSON_KEY_B64);
+  case 5:
+    switch (name[0])
+    {
+    case 'd': CONFIRM("dtype", NEPI_EDGE_JSON_KEY_DTYPE);
+    case 'v': CONFIRM("value", NEPI_EDGE_JSON_KEY_VALUE);
+    }
+    break;
+  case 6:
+    switch (name[0])
+    {
+    case 'e': CONFIRM("errors", NEPI_EDGE_JSON_KEY_ERRORS);
+    case 'p': CONFIRM("params", NEPI_EDGE_JSON_KEY_PARAMS);
+    case 's': CONFIRM("status", NEPI_EDGE_JSON_KEY_STATUS);
+    }
+    break;
+  case 7:
+    // msg{sent,recv} and gen{sent,recv} share a first character, so use the fourth
+    switch (name[0] ^ name[3])
+    {
+    case 'c' ^ 'r': CONFIRM("cfgrecv", NEPI_EDGE_JSON_KEY_CFGRECV);
+    case 'g' ^ 's': CONFIRM("gensent", NEPI_EDGE_JSON_KEY_GENSENT);
+    case 'g' ^ 'r': CONFIRM("genrecv", NEPI_EDGE_JSON_KEY_GENRECV);
+    case 'm' ^ 's': CONFIRM("msgsent", NEPI_EDGE_JSON_KEY_MSGSENT);
+    case 'm' ^ 'r': CONFIRM("msgrecv", NEPI_EDGE_JSON_KEY_MSGRECV);
+    case 'n' ^ 'd': CONFIRM("numdirs", NEPI_EDGE_JSON_KEY_NUMDIRS);
+    case 'p' ^ 's': CONFIRM("pktsent", NEPI_EDGE_JSON_KEY_PKTSENT);
+    }
+    break;
+  case 8:
+    switch (name[0])
+    {
+    case 'd': CONFIRM("datasent", NEPI_EDGE_JSON_KEY_DATASENT);
+    case 'n': CONFIRM("numfiles", NEPI_EDGE_JSON_KEY_NUMFILES);
+    case 's': CONFIRM("statsent", NEPI_EDGE_JSON_KEY_STATSENT);
+    case 't': CONFIRM("timestop", NEPI_EDGE_JSON_KEY_TIMESTOP);
+    case 'w': CONFIRM("warnings", NEPI_EDGE_JSON_KEY_WARNINGS);
+    }
+    break;
+  case 9:
+    CONFIRM("timestart", NEPI_EDGE_JSON_KEY_TIMESTART);
+  case 10:
+    switch (name[0])
+    {
+    case 'c': CONFIRM("comms_type", NEPI_EDGE_JSON_KEY_COMMS_TYPE);
+    case 'i': CONFIRM("identifier", NEPI_EDGE_JSON_KEY_IDENTIFIER);
+    }
+    break;
+  case 11:
+    // datasent_kB and datarecv_kB differ at the fifth character
+    switch (name[4])
+    {
+    case 'e': CONFIRM("connections", NEPI_EDGE_JSON_KEY_CONNECTIONS);
+    case 's': CONFIRM("datasent_kB", NEPI_EDGE_JSON_KEY_DATASENT_KB);
+    case 'r': CONFIRM("datarecv_kB", NEPI_EDGE_JSON_KEY_DATARECV_KB);
+    }
+    break;
+  }
+
+  return NEPI_EDGE_JSON_KEY_UNKNOWN;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#ifndef __NEPI_EDGE_JSON_KEYS_IMPL_H
+#define __NEPI_EDGE_JSON_KEYS_IMPL_H
+
+#include <stddef.h>
+#include <string.h>
+
+// Every JSON key the import callbacks act on
+typedef enum NEPI_EDGE_Json_Key
+{
+  NEPI_EDGE_JSON_KEY_UNKNOWN = 0,
+
+  // Config and general files
+  NEPI_EDGE_JSON_KEY_PARAMS,
+  NEPI_EDGE_JSON_KEY_IDENTIFIER,
+  NEPI_EDGE_JSON_KEY_VALUE,
+  NEPI_EDGE_JSON_KEY_B64, // Base64 byte-array value, nested as "value":{"b64":"..."}
+
+  // Exec status files, common
+  NEPI_EDGE_JSON_KEY_CONNECTIONS,
+  NEPI_EDGE_JSON_KEY_COMMS_TYPE,
+  NEPI_EDGE_JSON_KEY_STATUS,
+  NEPI_EDGE_JSON_KEY_TIMESTART,
+  NEPI_EDGE_JSON_KEY_TIMESTOP,
+  NEPI_EDGE_JSON_KEY_WARNINGS,
+  NEPI_EDGE_JSON_KEY_ERRORS,
+
+  // Exec status files, LB
+  NEPI_EDGE_JSON_KEY_MSGSENT,
+  NEPI_EDGE_JSON_KEY_PKTSENT,
+  NEPI_EDGE_JSON_KEY_MSGRECV,
+  NEPI_EDGE_JSON_KEY_STATSENT,
+  NEPI_EDGE_JSON_KEY_DATASENT,
+  NEPI_EDGE_JSON_KEY_GENSENT,
+  NEPI_EDGE_JSON_KEY_CFGRECV,
+  NEPI_EDGE_JSON_KEY_GENRECV,
+
+  // Exec status files, HB
+  NEPI_EDGE_JSON_KEY_DTYPE,
+  NEPI_EDGE_JSON_KEY_DATASENT_KB,
+  NEPI_EDGE_JSON_KEY_DATARECV_KB,
+  NEPI_EDGE_JSON_KEY_NUMDIRS,
+  NEPI_EDGE_JSON_KEY_NUMFILES
+} NEPI_EDGE_Json_Key_t;
+
+// Classify a json_walk key name in place (it is not NUL-terminated). A NULL name, as for array elements, is UNKNOWN.
+NEPI_EDGE_Json_Key_t NEPI_EDGE_JsonKeyLookup(const char *name, size_t name_len);
+
+// Compare a json_token's text against a string literal without copying it out first
+#define NEPI_EDGE_JSON_TOKEN_EQUALS(token, literal) \
+  (((size_t)(token)->len == (sizeof(literal) - 1)) && (0 == memcmp((token)->ptr, (literal), sizeof(literal) - 1)))
+
+#endif //__NEPI_EDGE_JSON_KEYS_IMPL_H
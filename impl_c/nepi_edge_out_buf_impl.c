@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "nepi_edge_out_buf_impl.h"
+#include "nepi_edge_base64_impl.h"
+#include "nepi_edge_sdk_link_impl.h"
+
+#define MAX_UINT64_DIGITS  20
+
+// Each thread keeps the heap block its last large document grew into, so a producer that exports big payloads
+// over and over goes back to the allocator only when a document outgrows it. Nothing here is shared between
+// threads; the key exists only to free the block when its thread exits.
+static _Thread_local char *scratch_data = NULL;
+static _Thread_local size_t scratch_capacity = 0;
+static pthread_key_t scratch_key;
+static pthread_once_t scratch_key_once = PTHREAD_ONCE_INIT;
+
+static void free_scratch(void *data)
+{
+  NEPI_EDGE_FREE(data);
+}
+
+static void create_scratch_key(void)
+{
+  pthread_key_create(&scratch_key, free_scratch);
+}
+
+static void set_scratch(char *data, size_t capacity)
+{
+  scratch_data = data;
+  scratch_capacity = capacity;
+  pthread_once(&scratch_key_once, create_scratch_key);
+  pthread_setspecific(scratch_key, data);
+}
+
+void NEPI_EDGE_OutBufInit(NEPI_EDGE_Out_Buf_t *buf)
+{
+  buf->data = buf->stack_storage;
+  buf->len = 0;
+  buf->capacity = NEPI_EDGE_OUT_BUF_STACK_SIZE;
+  buf->alloc_failed = 0;
+}
+
+void NEPI_EDGE_OutBufFree(NEPI_EDGE_Out_Buf_t *buf)
+{
+  if (buf->data != buf->stack_storage)
+  {
+    // Hand the block back to this thread's scratch slot if it's the biggest one seen that is still worth keeping
+    if ((buf->capacity > scratch_capacity) && (buf->capacity <= NEPI_EDGE_OUT_BUF_SCRATCH_MAX_SIZE))
+    {
+      if (NULL != scratch_data) NEPI_EDGE_FREE(scratch_data);
+      set_scratch(buf->data, buf->capacity);
+    }
+    else
+    {
+      NEPI_EDGE_FREE(buf->data);
+    }
+  }
+  NEPI_EDGE_OutBufInit(buf);
+}
+
+char* NEPI_EDGE_OutBufReserve(NEPI_EDGE_Out_Buf_t *buf, size_t additional_len)
+{
+  if (buf->alloc_failed) return NULL;
+
+  const size_t required = buf->len + additional_len;
+  if (required <= buf->capacity) return buf->data + buf->len;
+
+  // Grow geometrically so that large byte-array payloads don't cause repeated copies
+  size_t new_capacity = buf->capacity * 2;
+  if (new_capacity < required) new_capacity = required;
+
+  char *new_data;
+  if ((buf->data == buf->stack_storage) && (scratch_capacity >= new_capacity))
+  {
+    // Leaving the stack for the first time; this thread's scratch block is big enough
+    new_data = scratch_data;
+    new_capacity = scratch_capacity;
+    set_scratch(NULL, 0);
+  }
+  else
+  {
+    new_data = NEPI_EDGE_MALLOC(new_capacity);
+  }
+  if (NULL == new_data)
+  {
+    buf->alloc_failed = 1;
+    return NULL;
+  }
+  memcpy(new_data, buf->data, buf->len);
+  if (buf->data != buf->stack_storage)
+  {
+    NEPI_EDGE_FREE(buf->data);
+  }
+  buf->data = new_data;
+  buf->capacity = new_capacity;
+
+  return buf->data + buf->len;
+}
+
+void NEPI_EDGE_OutBufAppend(NEPI_EDGE_Out_Buf_t *buf, const char *str, size_t len)
+{
+  char *dest = NEPI_EDGE_OutBufReserve(buf, len);
+  if (NULL == dest) return;
+
+  memcpy(dest, str, len);
+  buf->len += len;
+}
+
+void NEPI_EDGE_OutBufAppendStr(NEPI_EDGE_Out_Buf_t *buf, const char *str)
+{
+  NEPI_EDGE_OutBufAppend(buf, str, strlen(str));
+}
+
+void NEPI_EDGE_OutBufAppendChar(NEPI_EDGE_Out_Buf_t *buf, char c)
+{
+  char *dest = NEPI_EDGE_OutBufReserve(buf, 1);
+  if (NULL == dest) return;
+
+  *dest = c;
+  ++(buf->len);
+}
+
+void NEPI_EDGE_OutBufAppendUInt64(NEPI_EDGE_Out_Buf_t *buf, uint64_t val)
+{
+  // Format back-to-front into a scratch area, then copy the used tail
+  char digits[MAX_UINT64_DIGITS];
+  char *d = digits + MAX_UINT64_DIGITS;
+  do
+  {
+    *(--d) = (char)('0' + (val % 10));
+    val /= 10;
+  } while (val != 0);
+
+  NEPI_EDGE_OutBufAppend(buf, d, (digits + MAX_UINT64_DIGITS) - d);
+}
+
+void NEPI_EDGE_OutBufAppendInt64(NEPI_EDGE_Out_Buf_t *buf, int64_t val)
+{
+  if (val < 0)
+  {
+    NEPI_EDGE_OutBufAppendChar(buf, '-');
+    // Negate in unsigned space so that INT64_MIN is handled
+    NEPI_EDGE_OutBufAppendUInt64(buf, (uint64_t)0 - (uint64_t)val);
+  }
+  else
+  {
+    NEPI_EDGE_OutBufAppendUInt64(buf, (uint64_t)val);
+  }
+}
+
+void NEPI_EDGE_OutBufAppendDouble(NEPI_EDGE_Out_Buf_t *buf, double val)
+{
+  // Correctly-rounded %f output is non-trivial to reproduce by hand, and the JSON consumers rely on it
+  // byte-for-byte, so use snprintf -- but straight into the buffer, avoiding the FILE stream and its lock.
+  // 64 bytes covers any value of practical magnitude; retry with the exact size otherwise.
+  char *dest = NEPI_EDGE_OutBufReserve(buf, 64);
+  if (NULL == dest) return;
+
+  int written = snprintf(dest, 64, "%f", val);
+  if (written < 0) return;
+  if (written >= 64)
+  {
+    dest = NEPI_EDGE_OutBufReserve(buf, written + 1);
+    if (NULL == dest) return;
+    snprintf(dest, written + 1, "%f", val);
+  }
+  buf->len += written;
+}
+
+void NEPI_EDGE_OutBufAppendByteList(NEPI_EDGE_Out_Buf_t *buf, const uint8_t *bytes, size_t count)
+{
+  if (0 == count) return;
+
+  // Worst case is "255," for every entry; reserve it all once up front
+  char *dest = NEPI_EDGE_OutBufReserve(buf, 4 * count);
+  if (NULL == dest) return;
+
+  char *d = dest;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const uint8_t b = bytes[i];
+    if (b >= 100)
+    {
+      *d++ = (char)('0' + (b / 100));
+      *d++ = (char)('0' + ((b / 10) % 10));
+    }
+    else if (b >= 10)
+    {
+      *d++ = (char)('0' + (b / 10));
+    }
+    *d++ = (char)('0' + (b % 10));
+    *d++ = ',';
+  }
+  buf->len += (d - dest) - 1; // Drop the trailing comma
+}
+
+void NEPI_EDGE_OutBufAppendBase64(NEPI_EDGE_Out_Buf_t *buf, const uint8_t *bytes, size_t count)
+{
+  if (0 == count) return;
+
+  char *dest = NEPI_EDGE_OutBufReserve(buf, NEPI_EDGE_BASE64_ENCODED_LENGTH(count));
+  if (NULL == dest) return;
+
+  buf->len += NEPI_EDGE_Base64Encode(bytes, count, dest);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_OutBufWriteFile(const NEPI_EDGE_Out_Buf_t *buf, const char *filename, uint8_t sync_to_disk)
+{
+  if (buf->alloc_failed) return NEPI_EDGE_RET_MALLOC_ERR;
+
+  // Same creation mode as fopen(filename, "w")
+  const int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (-1 == fd) return NEPI_EDGE_RET_FILE_OPEN_ERR;
+
+  const char *src = buf->data;
+  size_t remaining = buf->len;
+  while (remaining > 0)
+  {
+    const ssize_t written = write(fd, src, remaining);
+    if (written < 0)
+    {
+      if (EINTR == errno) continue;
+      close(fd);
+      return NEPI_EDGE_RET_FILE_WRITE_ERROR;
+    }
+    src += written;
+    remaining -= written;
+  }
+
+  if (sync_to_disk && (0 != fsync(fd)))
+  {
+    close(fd);
+    return NEPI_EDGE_RET_FILE_WRITE_ERROR;
+  }
+
+  if (0 != close(fd)) return NEPI_EDGE_RET_FILE_WRITE_ERROR;
+  return NEPI_EDGE_RET_OK;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#ifndef __NEPI_EDGE_OUT_BUF_IMPL_H
+#define __NEPI_EDGE_OUT_BUF_IMPL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "nepi_edge_errors.h"
+
+// Documents that fit here never touch the heap; status and snippet files are typically a few hundred bytes
+#define NEPI_EDGE_OUT_BUF_STACK_SIZE  2048
+// Heap blocks up to this size are kept per thread for reuse by the next document that outgrows the stack
+#define NEPI_EDGE_OUT_BUF_SCRATCH_MAX_SIZE  (4 * 1024 * 1024)
+
+// In-memory document builder. Export routines format their whole JSON document into one of these
+// and then hand it to the filesystem with a single write() rather than a long series of fprintf calls.
+typedef struct NEPI_EDGE_Out_Buf
+{
+  char *data; // Points at stack_storage until the document outgrows it
+  size_t len;
+  size_t capacity;
+  uint8_t alloc_failed; // Sticky -- reported by NEPI_EDGE_OutBufWriteFile
+
+  char stack_storage[NEPI_EDGE_OUT_BUF_STACK_SIZE];
+} NEPI_EDGE_Out_Buf_t;
+
+void NEPI_EDGE_OutBufInit(NEPI_EDGE_Out_Buf_t *buf);
+void NEPI_EDGE_OutBufFree(NEPI_EDGE_Out_Buf_t *buf);
+
+// Ensure room for at least additional_len more bytes; returns NULL (and latches alloc_failed) on failure
+char* NEPI_EDGE_OutBufReserve(NEPI_EDGE_Out_Buf_t *buf, size_t additional_len);
+
+void NEPI_EDGE_OutBufAppend(NEPI_EDGE_Out_Buf_t *buf, const char *str, size_t len);
+void NEPI_EDGE_OutBufAppendStr(NEPI_EDGE_Out_Buf_t *buf, const char *str);
+void NEPI_EDGE_OutBufAppendChar(NEPI_EDGE_Out_Buf_t *buf, char c);
+
+// Integer formatters are hand-rolled and match printf's %lu/%ld/%d output exactly
+void NEPI_EDGE_OutBufAppendUInt64(NEPI_EDGE_Out_Buf_t *buf, uint64_t val);
+void NEPI_EDGE_OutBufAppendInt64(NEPI_EDGE_Out_Buf_t *buf, int64_t val);
+// Formats as printf's %f (6 fractional digits) directly into the buffer
+void NEPI_EDGE_OutBufAppendDouble(NEPI_EDGE_Out_Buf_t *buf, double val);
+// Comma-separated decimal byte list without the enclosing brackets, e.g., 222,173,190,239
+void NEPI_EDGE_OutBufAppendByteList(NEPI_EDGE_Out_Buf_t *buf, const uint8_t *bytes, size_t count);
+// Padded base64 without the enclosing quotes, e.g., 3q2+7w==
+void NEPI_EDGE_OutBufAppendBase64(NEPI_EDGE_Out_Buf_t *buf, const uint8_t *bytes, size_t count);
+
+// Create/truncate filename and write the entire buffer to it, optionally fsync'ing before close
+NEPI_EDGE_RET_t NEPI_EDGE_OutBufWriteFile(const NEPI_EDGE_Out_Buf_t *buf, const char *filename, uint8_t sync_to_disk);
+
+#endif //__NEPI_EDGE_OUT_BUF_IMPL_H
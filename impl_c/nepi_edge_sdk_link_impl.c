@@ -15,28 +15,46 @@
 #include <unistd.h>
 
 #include "nepi_edge_sdk_link_impl.h"
+#include "nepi_edge_lb_interface.h"
+#include "nepi_edge_file_map_impl.h"
+#include "nepi_edge_json_keys_impl.h"
+#include "nepi_edge_bot_process_impl.h"
 
 #include "frozen/frozen.h"
 
 #define NEPI_EDGE_DEVNUID_FILE_PATH     "devinfo/devnuid.txt"
-#define NEPI_EDGE_NUID_STRLENGTH    16
+
+#define NEPI_EDGE_CONTEXT_DESTROY_RESIDENT_GRACE_MS  1000
 
 #define EXTRACT_LB_CONNECTION_STATUS(x,t,s,i) \
   VALIDATE_OPAQUE_TYPE(x,t,s) \
-  struct NEPI_EDGE_LB_Connection_Status *lb_conn_status; \
-  NEPI_EDGE_RET_t ret = getLBStatusByIndex(p, &lb_conn_status, (i)); \
-  if (ret != NEPI_EDGE_RET_OK) return ret;
+  if ((i) >= p->lb_conn_count) return NEPI_EDGE_RET_ARG_OUT_OF_RANGE; \
+  struct NEPI_EDGE_LB_Connection_Status *lb_conn_status = &(p->lb_conn_status[(i)]);
 
 #define EXTRACT_HB_CONNECTION_STATUS(x,t,s,i) \
   VALIDATE_OPAQUE_TYPE(x,t,s) \
-  struct NEPI_EDGE_HB_Connection_Status *hb_conn_status; \
-  NEPI_EDGE_RET_t ret = getHBStatusByIndex(p, &hb_conn_status, (i)); \
-  if (ret != NEPI_EDGE_RET_OK) return ret;
+  if ((i) >= p->hb_conn_count) return NEPI_EDGE_RET_ARG_OUT_OF_RANGE; \
+  struct NEPI_EDGE_HB_Connection_Status *hb_conn_status = &(p->hb_conn_status[(i)]);
 
-static char nepi_edge_bot_base_file_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH] = {'\0'};
-static char nepi_edge_bot_nuid[NEPI_EDGE_NUID_STRLENGTH] = {'\0'};
-
-static pid_t bot_pid = -1;
+// Backs every API call without a Ctx suffix
+static struct NEPI_EDGE_Context default_context =
+{
+  .bot_base_file_path = {'\0'},
+  .bot_nuid = {'\0'},
+  .bot = NEPI_EDGE_BOT_PROCESS_INITIALIZER(&(default_context.bot_run_history)),
+  .resident = NULL,
+  .resident_lock = PTHREAD_RWLOCK_INITIALIZER,
+  .resident_generation = 0,
+  .bot_run_history = NEPI_EDGE_BOT_RUN_HISTORY_INITIALIZER,
+  .bot_restart_policy = NEPI_EDGE_BOT_RESTART_POLICY_DEFAULT,
+  .bot_start_options = NEPI_EDGE_BOT_START_OPTIONS_DEFAULT,
+  .hb_targ_data_path = {'\0'},
+  .general_do_file_count = 0,
+  .bytes_encoding = NEPI_EDGE_LB_BYTES_ENCODING_DECIMAL,
+  .staging = NEPI_EDGE_STAGING_STATE_INITIALIZER,
+  .bot_config = NEPI_EDGE_BOT_CONFIG_CACHE_INITIALIZER,
+  .opaque_helper = { NEPI_EDGE_OPAQUE_TYPE_ID_CONTEXT }
+};
 
 static void mkdir_recursive(const char *dir, mode_t mode)
 {
@@ -92,8 +110,72 @@ NEPI_EDGE_RET_t NEPI_EDGE_SDKCheckPath(const char* path)
   return NEPI_EDGE_RET_OK;
 }
 
+NEPI_EDGE_RET_t NEPI_EDGE_ContextCreate(NEPI_EDGE_Context_t *context)
+{
+  *context = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_Context));
+  if (NULL == *context) return NEPI_EDGE_RET_MALLOC_ERR;
+
+  struct NEPI_EDGE_Context *ctx = (struct NEPI_EDGE_Context*)(*context);
+  ctx->opaque_helper.msg_id = NEPI_EDGE_OPAQUE_TYPE_ID_CONTEXT;
+  ctx->bot_base_file_path[0] = '\0';
+  ctx->bot_nuid[0] = '\0';
+  const NEPI_EDGE_Bot_Process_t not_started = NEPI_EDGE_BOT_PROCESS_INITIALIZER(&(ctx->bot_run_history));
+  ctx->bot = not_started;
+  ctx->resident = NULL;
+  pthread_rwlock_init(&(ctx->resident_lock), NULL);
+  ctx->resident_generation = 0;
+  NEPI_EDGE_BotRunHistoryInit(&(ctx->bot_run_history));
+  const NEPI_EDGE_Bot_Restart_Policy_t default_restart_policy = NEPI_EDGE_BOT_RESTART_POLICY_DEFAULT;
+  ctx->bot_restart_policy = default_restart_policy;
+  NEPI_EDGE_BotStartOptionsInit(&(ctx->bot_start_options));
+  ctx->hb_targ_data_path[0] = '\0';
+  atomic_init(&(ctx->general_do_file_count), 0);
+  atomic_init(&(ctx->bytes_encoding), NEPI_EDGE_LB_BYTES_ENCODING_DECIMAL);
+  NEPI_EDGE_StagingStateInit(&(ctx->staging));
+  NEPI_EDGE_BotConfigCacheInit(&(ctx->bot_config));
+
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_ContextDestroy(NEPI_EDGE_Context_t context)
+{
+  VALIDATE_CONTEXT(context)
+  if (ctx == &default_context) return NEPI_EDGE_RET_BAD_PARAM;
+
+  // Nothing would be left to reap a one-shot bot still running, so the context stays until it has been waited on or
+  // stopped. Reaping here also closes its exit fd once it has finished.
+  uint8_t one_shot_running = 0;
+  const NEPI_EDGE_RET_t reap_ret = NEPI_EDGE_BotReap(&(ctx->bot), &one_shot_running);
+  if (NEPI_EDGE_RET_OK != reap_ret) return reap_ret;
+  if (1 == one_shot_running) return NEPI_EDGE_RET_BOT_ALREADY_RUNNING;
+
+  pthread_rwlock_rdlock(&(ctx->resident_lock));
+  const uint8_t resident_running = (NULL != ctx->resident)? 1 : 0;
+  pthread_rwlock_unlock(&(ctx->resident_lock));
+  if (1 == resident_running) NEPI_EDGE_StopBotResidentCtx(ctx, NEPI_EDGE_CONTEXT_DESTROY_RESIDENT_GRACE_MS);
+  const NEPI_EDGE_RET_t ret = NEPI_EDGE_StagingStateDestroy(&(ctx->staging));
+  NEPI_EDGE_BotRunHistoryDestroy(&(ctx->bot_run_history));
+  NEPI_EDGE_BotConfigCacheDestroy(&(ctx->bot_config));
+  pthread_rwlock_destroy(&(ctx->resident_lock));
+
+  NEPI_EDGE_FREE(ctx);
+  return ret;
+}
+
+NEPI_EDGE_Context_t NEPI_EDGE_GetDefaultContext(void)
+{
+  return &default_context;
+}
+
 NEPI_EDGE_RET_t NEPI_EDGE_SetBotBaseFilePath(const char* path)
 {
+  return NEPI_EDGE_SetBotBaseFilePathCtx(&default_context, path);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_SetBotBaseFilePathCtx(NEPI_EDGE_Context_t context, const char* path)
+{
+  VALIDATE_CONTEXT(context)
+
   // First create and/or check permissions on subfolder paths
   char tmp_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
 
@@ -130,34 +212,53 @@ NEPI_EDGE_RET_t NEPI_EDGE_SetBotBaseFilePath(const char* path)
   // Get the NUID
   snprintf(tmp_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", path, NEPI_EDGE_DEVNUID_FILE_PATH);
   FILE *nuid_file = fopen(tmp_path, "r");
-  if ((NULL == tmp_path) ||
-      (NULL == fgets(nepi_edge_bot_nuid, NEPI_EDGE_NUID_STRLENGTH, nuid_file)))
+  if ((NULL == nuid_file) ||
+      (NULL == fgets(ctx->bot_nuid, NEPI_EDGE_NUID_STRLENGTH, nuid_file)))
   {
+    if (NULL != nuid_file) fclose(nuid_file);
     return NEPI_EDGE_RET_INVALID_BOT_PATH;
   }
   // Chomp the newline if there is one
-  nepi_edge_bot_nuid[strcspn(nepi_edge_bot_nuid, "\n")] = '\0';
+  ctx->bot_nuid[strcspn(ctx->bot_nuid, "\n")] = '\0';
   fclose(nuid_file);
 
-  // Everything checks out, so update the global variable and return success
-  strncpy(nepi_edge_bot_base_file_path, path, NEPI_EDGE_MAX_FILE_PATH_LENGTH);
+  // Everything checks out, so update the context and return success
+  strncpy(ctx->bot_base_file_path, path, NEPI_EDGE_MAX_FILE_PATH_LENGTH);
   return NEPI_EDGE_RET_OK;
 }
 
 const char* NEPI_EDGE_GetBotBaseFilePath(void)
 {
-  return nepi_edge_bot_base_file_path;
+  return default_context.bot_base_file_path;
+}
+
+const char* NEPI_EDGE_GetBotBaseFilePathCtx(NEPI_EDGE_Context_t context)
+{
+  struct NEPI_EDGE_Context *ctx = (struct NEPI_EDGE_Context*)context;
+  if ((NULL == ctx) || (ctx->opaque_helper.msg_id != NEPI_EDGE_OPAQUE_TYPE_ID_CONTEXT)) return NULL;
+  return ctx->bot_base_file_path;
 }
 
 const char* NEPI_EDGE_GetBotNUID(void)
 {
-  return nepi_edge_bot_nuid;
+  return default_context.bot_nuid;
 }
 
-NEPI_EDGE_RET_t NEPI_EDGE_StartBot(uint8_t run_lb, uint32_t lb_timeout_s, uint8_t run_hb, uint32_t hb_timeout_s)
+const char* NEPI_EDGE_GetBotNUIDCtx(NEPI_EDGE_Context_t context)
+{
+  struct NEPI_EDGE_Context *ctx = (struct NEPI_EDGE_Context*)context;
+  if ((NULL == ctx) || (ctx->opaque_helper.msg_id != NEPI_EDGE_OPAQUE_TYPE_ID_CONTEXT)) return NULL;
+  return ctx->bot_nuid;
+}
+
+// Caller holds ctx->resident_lock
+static NEPI_EDGE_RET_t start_one_shot(struct NEPI_EDGE_Context *ctx, uint8_t run_lb, uint32_t lb_timeout_s, uint8_t run_hb,
+                                      uint32_t hb_timeout_s)
 {
+  if (NULL != ctx->resident) return NEPI_EDGE_RET_BOT_ALREADY_RUNNING; // Use TriggerBotRun instead
+
   uint8_t bot_already_running = 0;
-  const NEPI_EDGE_RET_t check_bot_running_ret = NEPI_EDGE_CheckBotRunning(&bot_already_running);
+  const NEPI_EDGE_RET_t check_bot_running_ret = NEPI_EDGE_CheckBotRunningCtx(ctx, &bot_already_running);
   if (NEPI_EDGE_RET_OK != check_bot_running_ret)
   {
     return check_bot_running_ret;
@@ -168,101 +269,178 @@ NEPI_EDGE_RET_t NEPI_EDGE_StartBot(uint8_t run_lb, uint32_t lb_timeout_s, uint8_
     return NEPI_EDGE_RET_BOT_ALREADY_RUNNING;
   }
 
-  const pid_t fork_ret = fork();
-  if (-1 == fork_ret)
+  // Make sure the bot sees any exports still held back by a group-commit sync policy. A failure here
+  // leaves them staged for the next commit, which is no reason to hold up the bot.
+  NEPI_EDGE_StagingCommit(&(ctx->staging));
+
+  char executable_dir[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  if (snprintf(executable_dir, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/bin/botmain", ctx->bot_base_file_path) >=
+      NEPI_EDGE_MAX_FILE_PATH_LENGTH)
   {
-    return NEPI_EDGE_RET_CANT_START_BOT;
+    return NEPI_EDGE_RET_INVALID_BOT_PATH;
   }
-  else if (0 == fork_ret) // Child process
-  {
-    //sleep(30); // Just for attaching a debugger to this child process
 
-    // Avoid a race case on bot_pid by delaying here for a moment
-    usleep(50000); // 50ms
+  // The environment is the bot's only configuration channel
+  char run_lb_link_env_var[32];
+  snprintf(run_lb_link_env_var, 32, "RUN_LB_LINK=%u", run_lb);
+  char lb_proc_timeout_env_var[32];
+  snprintf(lb_proc_timeout_env_var, 32, "LB_PROC_TIMEOUT=%u", lb_timeout_s);
+  char run_hb_link_env_var[32];
+  snprintf(run_hb_link_env_var, 32, "RUN_HB_LINK=%u", run_hb);
+  char hb_proc_timeout_env_var[32];
+  snprintf(hb_proc_timeout_env_var, 32, "HB_PROC_TIMEOUT=%u", hb_timeout_s);
+  char *executable_env[5] = {run_lb_link_env_var, lb_proc_timeout_env_var, run_hb_link_env_var, hb_proc_timeout_env_var, NULL};
 
-    char executable_dir[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-    snprintf(executable_dir, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/bin/botmain", nepi_edge_bot_base_file_path);
-    if (-1 == chdir(executable_dir))
-    {
-      return NEPI_EDGE_RET_INVALID_BOT_PATH;
-    }
+  // The pid is only ever set here in the parent, so there is no window for the child to race
+  return NEPI_EDGE_BotSpawn(executable_dir, "botmain", executable_env, NULL, 0, &(ctx->bot_start_options), &(ctx->bot));
+}
 
-    // Set up the args for execve -- includes command line args and environment
-    char *executable_argv[2];
-    executable_argv[0] = "botmain"; // just argv[0] -- the application name, last one must be null-terminated
-    executable_argv[1] = NULL; // Indicates the end of the array
-    char run_lb_link_env_var[32];
-    snprintf(run_lb_link_env_var, 32, "RUN_LB_LINK=%u", run_lb);
-    char lb_proc_timeout_env_var[32];
-    snprintf(lb_proc_timeout_env_var, 32, "LB_PROC_TIMEOUT=%u", lb_timeout_s);
-    char run_hb_link_env_var[32];
-    snprintf(run_hb_link_env_var, 32, "RUN_HB_LINK=%u", run_hb);
-    char hb_proc_timeout_env_var[32];
-    snprintf(hb_proc_timeout_env_var, 32, "HB_PROC_TIMEOUT=%u", hb_timeout_s);
-    char *executable_env[5] = {run_lb_link_env_var, lb_proc_timeout_env_var, run_hb_link_env_var, hb_proc_timeout_env_var, NULL};
-
-    if (-1 == execve("botmain", executable_argv, executable_env))
-    {
-      return NEPI_EDGE_RET_CANT_START_BOT; // Nobody will get this return value
-    }
-    // Otherwise, execve never returns
-  }
+NEPI_EDGE_RET_t NEPI_EDGE_StartBot(uint8_t run_lb, uint32_t lb_timeout_s, uint8_t run_hb, uint32_t hb_timeout_s)
+{
+  return NEPI_EDGE_StartBotCtx(&default_context, run_lb, lb_timeout_s, run_hb, hb_timeout_s);
+}
 
-  // else // Parent process
-  // Just set the bot_pid and return
-  bot_pid = fork_ret;
-  return NEPI_EDGE_RET_OK;
+NEPI_EDGE_RET_t NEPI_EDGE_StartBotCtx(NEPI_EDGE_Context_t context, uint8_t run_lb, uint32_t lb_timeout_s, uint8_t run_hb, uint32_t hb_timeout_s)
+{
+  VALIDATE_CONTEXT(context)
+
+  // Held until the bot is spawned, so a StartBotResident waiting for the lock then finds it running
+  pthread_rwlock_rdlock(&(ctx->resident_lock));
+  const NEPI_EDGE_RET_t ret = start_one_shot(ctx, run_lb, lb_timeout_s, run_hb, hb_timeout_s);
+  pthread_rwlock_unlock(&(ctx->resident_lock));
+  return ret;
 }
 
 NEPI_EDGE_RET_t NEPI_EDGE_CheckBotRunning(uint8_t *bot_running)
 {
-  if (-1 == bot_pid) // not started
-  {
-    *bot_running = 0;
-  }
-  else
-  {
-    int status = 0;
-    int waitpid_ret = waitpid(bot_pid, &status, WNOHANG);
-    if (-1 == waitpid_ret)
-    {
-      return NEPI_EDGE_RET_BOT_EXEC_UNDETERMINED;
-    }
-    else if (0 == waitpid_ret)
-    {
-      *bot_running = 1;
-    }
-    else // Must have terminated
-    {
-      *bot_running = 0;
-      // This is the only appropriate place to reset the bot_pid to the not-running sentinel value
-      bot_pid = -1;
-    }
-  }
-  return NEPI_EDGE_RET_OK;
+  return NEPI_EDGE_CheckBotRunningCtx(&default_context, bot_running);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_CheckBotRunningCtx(NEPI_EDGE_Context_t context, uint8_t *bot_running)
+{
+  VALIDATE_CONTEXT(context)
+
+  return NEPI_EDGE_BotReap(&(ctx->bot), bot_running);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_WaitBot(int32_t timeout_ms)
+{
+  return NEPI_EDGE_WaitBotCtx(&default_context, timeout_ms);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_WaitBotCtx(NEPI_EDGE_Context_t context, int32_t timeout_ms)
+{
+  VALIDATE_CONTEXT(context)
+
+  return NEPI_EDGE_BotWait(&(ctx->bot), timeout_ms);
+}
+
+int NEPI_EDGE_GetBotFd(void)
+{
+  return NEPI_EDGE_GetBotFdCtx(&default_context);
+}
+
+int NEPI_EDGE_GetBotFdCtx(NEPI_EDGE_Context_t context)
+{
+  struct NEPI_EDGE_Context *ctx = (struct NEPI_EDGE_Context*)context;
+  if ((NULL == ctx) || (ctx->opaque_helper.msg_id != NEPI_EDGE_OPAQUE_TYPE_ID_CONTEXT)) return -1;
+  return ctx->bot.exit_fd;
 }
 
 NEPI_EDGE_RET_t NEPI_EDGE_StopBot(uint8_t force_kill)
 {
-  if (-1 == bot_pid)
-  {
-    return NEPI_EDGE_RET_BOT_NOT_RUNNING;
-  }
+  return NEPI_EDGE_StopBotCtx(&default_context, force_kill);
+}
 
-  int kill_ret;
-  if (0 == force_kill)
+NEPI_EDGE_RET_t NEPI_EDGE_StopBotCtx(NEPI_EDGE_Context_t context, uint8_t force_kill)
+{
+  VALIDATE_CONTEXT(context)
+
+  return NEPI_EDGE_BotSignal(&(ctx->bot), force_kill);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_StopBotGraceful(uint32_t grace_ms)
+{
+  return NEPI_EDGE_StopBotGracefulCtx(&default_context, grace_ms);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_StopBotGracefulCtx(NEPI_EDGE_Context_t context, uint32_t grace_ms)
+{
+  VALIDATE_CONTEXT(context)
+
+  return NEPI_EDGE_BotStop(&(ctx->bot), grace_ms);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_GetBotLastRun(NEPI_EDGE_Bot_Run_Stats_t *run)
+{
+  return NEPI_EDGE_GetBotLastRunCtx(&default_context, run);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_GetBotLastRunCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Bot_Run_Stats_t *run)
+{
+  VALIDATE_CONTEXT(context)
+  if (NULL == run) return NEPI_EDGE_RET_UNINIT_OBJ;
+
+  uint32_t run_count = 0;
+  NEPI_EDGE_BotRunHistoryGet(&(ctx->bot_run_history), run, 1, &run_count);
+  return (0 == run_count)? NEPI_EDGE_RET_PARAM_NOT_FOUND : NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_GetBotRunHistory(NEPI_EDGE_Bot_Run_Stats_t *runs, uint32_t max_runs, uint32_t *run_count)
+{
+  return NEPI_EDGE_GetBotRunHistoryCtx(&default_context, runs, max_runs, run_count);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_GetBotRunHistoryCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Bot_Run_Stats_t *runs, uint32_t max_runs,
+                                              uint32_t *run_count)
+{
+  VALIDATE_CONTEXT(context)
+  if ((NULL == runs) || (NULL == run_count)) return NEPI_EDGE_RET_UNINIT_OBJ;
+
+  NEPI_EDGE_BotRunHistoryGet(&(ctx->bot_run_history), runs, max_runs, run_count);
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_BotStartOptionsInit(NEPI_EDGE_Bot_Start_Options_t *options)
+{
+  if (NULL == options) return NEPI_EDGE_RET_UNINIT_OBJ;
+
+  const NEPI_EDGE_Bot_Start_Options_t default_options = NEPI_EDGE_BOT_START_OPTIONS_DEFAULT;
+  *options = default_options;
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_SetBotStartOptions(const NEPI_EDGE_Bot_Start_Options_t *options)
+{
+  return NEPI_EDGE_SetBotStartOptionsCtx(&default_context, options);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_SetBotStartOptionsCtx(NEPI_EDGE_Context_t context, const NEPI_EDGE_Bot_Start_Options_t *options)
+{
+  VALIDATE_CONTEXT(context)
+
+  if (NULL == options) return NEPI_EDGE_BotStartOptionsInit(&(ctx->bot_start_options));
+
+  if ((NEPI_EDGE_BOT_NICE_INHERIT != options->nice) && ((options->nice < -20) || (options->nice > 19)))
   {
-    kill_ret = kill(bot_pid, SIGINT);
+    return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
   }
-  else
+  if ((options->io_class > NEPI_EDGE_BOT_IO_CLASS_IDLE) || (options->io_level > 7)) return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
+  if ('\0' != options->cgroup_path[0])
   {
-    kill_ret = kill(bot_pid, SIGKILL);
+    const size_t cgroup_path_len = strnlen(options->cgroup_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH);
+    // Leave room for the "/cgroup.subtree_control" and such that get appended
+    if (('/' != options->cgroup_path[0]) || (cgroup_path_len + 32 > NEPI_EDGE_MAX_FILE_PATH_LENGTH))
+    {
+      return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
+    }
   }
-
-  if (0 != kill_ret)
+  else if ((0 != options->cgroup_memory_max_bytes) || (0 != options->cgroup_cpu_max_percent))
   {
-    return NEPI_EDGE_RET_CANT_KILL_BOT;
+    return NEPI_EDGE_RET_ARG_OUT_OF_RANGE; // Limits without a cgroup to hold them
   }
+
+  ctx->bot_start_options = *options;
   return NEPI_EDGE_RET_OK;
 }
 
@@ -274,8 +452,13 @@ NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusCreate(NEPI_EDGE_Exec_Status_t *exec_status)
   struct NEPI_EDGE_Exec_Status *p = (struct NEPI_EDGE_Exec_Status*)(*exec_status);
   p->opaque_helper.msg_id = NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS;
 
-  p->lb_conn_status = NULL; // Linked list
-  p->hb_conn_status = NULL; // Linked list
+  p->lb_conn_count = 0;
+  p->hb_conn_count = 0;
+  memset(&(p->lb_file), 0, sizeof(p->lb_file)); // Nothing known, and buffers grow on first read
+  memset(&(p->hb_file), 0, sizeof(p->hb_file));
+
+  p->software_updated = 0;
+  memset(&(p->sw_update_file_id), 0, sizeof(p->sw_update_file_id));
 
   return NEPI_EDGE_RET_OK;
 }
@@ -284,23 +467,10 @@ NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusDestroy(NEPI_EDGE_Exec_Status_t exec_status)
 {
   VALIDATE_OPAQUE_TYPE(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status)
 
-  struct NEPI_EDGE_LB_Connection_Status *lb_conn_status = p->lb_conn_status;
-  struct NEPI_EDGE_LB_Connection_Status *tmp_lb;
-  while (lb_conn_status != NULL)
-  {
-    tmp_lb = lb_conn_status->next;
-    NEPI_EDGE_FREE(lb_conn_status);
-    lb_conn_status = tmp_lb;
-  }
-
-  struct NEPI_EDGE_HB_Connection_Status *hb_conn_status = p->hb_conn_status;
-  struct NEPI_EDGE_HB_Connection_Status *tmp_hb;
-  while (hb_conn_status != NULL)
-  {
-    tmp_hb = hb_conn_status->next;
-    NEPI_EDGE_FREE(hb_conn_status);
-    hb_conn_status = tmp_hb;
-  }
+  NEPI_EDGE_FREE(p->lb_file.pool);
+  NEPI_EDGE_FREE(p->lb_file.strings);
+  NEPI_EDGE_FREE(p->hb_file.pool);
+  NEPI_EDGE_FREE(p->hb_file.strings);
 
   NEPI_EDGE_FREE(exec_status);
   exec_status = NULL;
@@ -308,284 +478,262 @@ NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusDestroy(NEPI_EDGE_Exec_Status_t exec_status)
   return NEPI_EDGE_RET_OK;
 }
 
-static void detectNewLBConnectionEntry(struct NEPI_EDGE_LB_Connection_Status **conn_status, uint32_t field_mask)
+// json_walk callback state for one exec status file
+typedef struct
 {
-  // If comms_type is already set, this is a new entry so step the linked list and start fresh
-  if ((*conn_status)->hdr.fields_set & field_mask)
-  {
-    (*conn_status)->next = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_LB_Connection_Status));
-    (*conn_status) = (*conn_status)->next;
-    (*conn_status)->next = NULL;
-    (*conn_status)->hdr.fields_set = 0;
-    (*conn_status)->hdr.currently_parsing_warnings = 0;
-    (*conn_status)->hdr.currently_parsing_errors = 0;
-  }
-}
+  NEPI_EDGE_Exec_Status_File_t *file;
 
-static void json_walk_exec_lb_status_callback(void *callback_data, const char *name, size_t name_len, const char *path, const struct json_token *token)
-{
-  if (token->type == JSON_TYPE_OBJECT_START || token->type == JSON_TYPE_OBJECT_END) return;
+  // The exec status' LB or HB entries
+  void *entries;
+  size_t entry_size;
+  size_t *entry_count;
+  size_t max_entries;
 
-  char tmp_name[1024];
-  size_t tmp_len = (name_len < 1024)? name_len : 1024;
-  strncpy(tmp_name, name, tmp_len);
-  tmp_name[tmp_len] = '\0';
+  struct NEPI_EDGE_Connection_Status_Common_Hdr *current; // NULL until the first entry starts
+  union
+  {
+    struct NEPI_EDGE_LB_Connection_Status lb;
+    struct NEPI_EDGE_HB_Connection_Status hb;
+  } dropped; // Stands in for entries past max_entries
+  uint8_t currently_parsing_warnings;
+  uint8_t currently_parsing_errors;
 
-  if (0 == strcmp(tmp_name, "connections")) return; // The start of the connections array, nothing to do
+  NEPI_EDGE_RET_t ret;
+} Exec_Status_Parse_State_t;
 
-  struct NEPI_EDGE_Exec_Status *exec_status = *(struct NEPI_EDGE_Exec_Status**)(callback_data);
-  if (exec_status->lb_conn_status == NULL) // First entry of linked list not allocated yet
+// The entry a field belongs to. If the current entry already has that field set, this is a new entry so step to the
+// next and start fresh.
+static struct NEPI_EDGE_Connection_Status_Common_Hdr* execStatusEntryFor(Exec_Status_Parse_State_t *state, uint32_t field_mask)
+{
+  if ((NULL == state->current) || (state->current->fields_set & field_mask))
   {
-    exec_status->lb_conn_status = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_LB_Connection_Status));
-    if (NULL == exec_status->lb_conn_status) return; // Not much we can do here -- probably totally hosed
+    if (*(state->entry_count) < state->max_entries)
+    {
+      state->current = (struct NEPI_EDGE_Connection_Status_Common_Hdr*)
+        ((char*)(state->entries) + (*(state->entry_count) * state->entry_size));
+      ++(*(state->entry_count));
+    }
+    else
+    {
+      state->current = &(state->dropped.lb.hdr); // Same place as dropped.hb.hdr
+    }
 
-    exec_status->lb_conn_status->next = NULL;
-    exec_status->lb_conn_status->hdr.fields_set = 0;
-    exec_status->lb_conn_status->hdr.currently_parsing_warnings = 0;
-    exec_status->lb_conn_status->hdr.currently_parsing_errors = 0;
+    memset(state->current, 0, state->entry_size);
+    state->currently_parsing_warnings = 0;
+    state->currently_parsing_errors = 0;
   }
 
-  struct NEPI_EDGE_LB_Connection_Status *conn_status = exec_status->lb_conn_status;
+  return state->current;
+}
 
-  // Navigate to the last entry in the linked list -- that's the one we're working on right now
-  while (conn_status->next != NULL)
+// Copies a string token into the file's pool. NULL only if the pool was undersized, which well-formed JSON can't do.
+static char* execStatusPoolString(Exec_Status_Parse_State_t *state, const struct json_token *token)
+{
+  NEPI_EDGE_Exec_Status_File_t *file = state->file;
+  if ((file->pool_used + token->len + 1) > file->pool_size)
   {
-    conn_status = conn_status->next;
+    state->ret = NEPI_EDGE_RET_INVALID_FILE_FORMAT;
+    return NULL;
   }
 
-  if (0 == strcmp(tmp_name, "comms_type"))
-  {
-    detectNewLBConnectionEntry(&conn_status, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Comms_Type);
+  char *str = file->pool + file->pool_used;
+  memcpy(str, token->ptr, token->len);
+  str[token->len] = '\0';
+  file->pool_used += token->len + 1;
+  return str;
+}
 
-    const size_t bytes_to_copy = (token->len < NEPI_EDGE_MAX_COMMS_TYPE_STRLENGTH)? token->len : NEPI_EDGE_MAX_COMMS_TYPE_STRLENGTH;
-    memcpy(conn_status->hdr.comms_type, token->ptr, bytes_to_copy);
-    conn_status->hdr.comms_type[bytes_to_copy] = '\0';
-    conn_status->hdr.fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Comms_Type;
-  }
-  else if (0 == strcmp(tmp_name, "status"))
+static NEPI_EDGE_RET_t execStatusAppendString(NEPI_EDGE_Exec_Status_File_t *file, char *str)
+{
+  if (file->string_count == file->strings_size)
   {
-    detectNewLBConnectionEntry(&conn_status, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Status);
+    const size_t new_size = (0 == file->strings_size)? 16 : (2 * file->strings_size);
+    char **strings = NEPI_EDGE_REALLOC(file->strings, new_size * sizeof(char*));
+    if (NULL == strings) return NEPI_EDGE_RET_MALLOC_ERR;
+    file->strings = strings;
+    file->strings_size = new_size;
+  }
 
-    conn_status->hdr.fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Status;
-    char tmp_val[1024];
-    size_t tmp_len = (token->len < 1024)? token->len : 1024;
-    memcpy(tmp_val, token->ptr, tmp_len);
-    tmp_val[tmp_len] = '\0';
+  file->strings[file->string_count] = str;
+  ++(file->string_count);
+  return NEPI_EDGE_RET_OK;
+}
 
-    if (0 == strcmp(tmp_val, NEPI_EDGE_COMMS_STATUS_STRING_SUCCESS)) conn_status->hdr.status = NEPI_EDGE_COMMS_STATUS_SUCCESS;
-    else if (0 == strcmp(tmp_val, NEPI_EDGE_COMMS_STATUS_STRING_CONN_FAILED)) conn_status->hdr.status = NEPI_EDGE_COMMS_STATUS_CONN_FAILED;
-    else if (0 == strcmp(tmp_val, NEPI_EDGE_COMMS_STATUS_STRING_DISABLED)) conn_status->hdr.status = NEPI_EDGE_COMMS_STATUS_DISABLED;
-    else conn_status->hdr.status = NEPI_EDGE_COMMS_STATUS_UNKNOWN;
-  }
-  else if (0 == strcmp(tmp_name, "timestart"))
-  {
-    detectNewLBConnectionEntry(&conn_status, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Start_Time);
+static void json_walk_exec_status_common_callback(Exec_Status_Parse_State_t *state, NEPI_EDGE_Json_Key_t key, const char *path,
+                                                  const struct json_token *token)
+{
+  struct NEPI_EDGE_Connection_Status_Common_Hdr *hdr;
 
-    const size_t bytes_to_copy = (token->len < NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH)? token->len : NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH;
-    memcpy(conn_status->hdr.start_time_rfc3339, token->ptr, bytes_to_copy);
-    conn_status->hdr.start_time_rfc3339[bytes_to_copy] = '\0';
-    conn_status->hdr.fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Start_Time;
-  }
-  else if (0 == strcmp(tmp_name, "timestop"))
+  if (NEPI_EDGE_JSON_KEY_COMMS_TYPE == key)
   {
-    detectNewLBConnectionEntry(&conn_status, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Stop_Time);
+    hdr = execStatusEntryFor(state, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Comms_Type);
 
-    const size_t bytes_to_copy = (token->len < NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH)? token->len : NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH;
-    memcpy(conn_status->hdr.stop_time_rfc3339, token->ptr, bytes_to_copy);
-    conn_status->hdr.stop_time_rfc3339[bytes_to_copy] = '\0';
-    conn_status->hdr.fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Stop_Time;
+    hdr->comms_type = execStatusPoolString(state, token);
+    if (NULL != hdr->comms_type) hdr->fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Comms_Type;
   }
-  else if (0 == strcmp(tmp_name, "warnings"))
+  else if (NEPI_EDGE_JSON_KEY_STATUS == key)
   {
-    detectNewLBConnectionEntry(&conn_status, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Warnings);
+    hdr = execStatusEntryFor(state, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Status);
 
-    conn_status->hdr.fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Warnings;
-    conn_status->hdr.warning_count = 0;
-    conn_status->hdr.currently_parsing_warnings = 1;
+    hdr->fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Status;
+    if (NEPI_EDGE_JSON_TOKEN_EQUALS(token, NEPI_EDGE_COMMS_STATUS_STRING_SUCCESS)) hdr->status = NEPI_EDGE_COMMS_STATUS_SUCCESS;
+    else if (NEPI_EDGE_JSON_TOKEN_EQUALS(token, NEPI_EDGE_COMMS_STATUS_STRING_CONN_FAILED)) hdr->status = NEPI_EDGE_COMMS_STATUS_CONN_FAILED;
+    else if (NEPI_EDGE_JSON_TOKEN_EQUALS(token, NEPI_EDGE_COMMS_STATUS_STRING_DISABLED)) hdr->status = NEPI_EDGE_COMMS_STATUS_DISABLED;
+    else hdr->status = NEPI_EDGE_COMMS_STATUS_UNKNOWN;
   }
-  else if (0 == strcmp(tmp_name, "errors"))
+  else if (NEPI_EDGE_JSON_KEY_TIMESTART == key)
   {
-    detectNewLBConnectionEntry(&conn_status, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Errors);
+    hdr = execStatusEntryFor(state, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Start_Time);
 
-    conn_status->hdr.fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Errors;
-    conn_status->hdr.error_count = 0;
-    conn_status->hdr.currently_parsing_errors = 1;
+    hdr->start_time_rfc3339 = execStatusPoolString(state, token);
+    if (NULL != hdr->start_time_rfc3339) hdr->fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Start_Time;
   }
-  else if (0 == strcmp(tmp_name, "msgsent"))
+  else if (NEPI_EDGE_JSON_KEY_TIMESTOP == key)
   {
-    detectNewLBConnectionEntry(&conn_status, NEPI_EDGE_LB_Connection_Status_Fields_Messages_Sent);
+    hdr = execStatusEntryFor(state, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Stop_Time);
 
-    conn_status->messages_sent = strtol(token->ptr, NULL, 10);
-    conn_status->hdr.fields_set |= NEPI_EDGE_LB_Connection_Status_Fields_Messages_Sent;
+    hdr->stop_time_rfc3339 = execStatusPoolString(state, token);
+    if (NULL != hdr->stop_time_rfc3339) hdr->fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Stop_Time;
   }
-  else if (0 == strcmp(tmp_name, "pktsent"))
+  else if (NEPI_EDGE_JSON_KEY_WARNINGS == key)
   {
-    detectNewLBConnectionEntry(&conn_status, NEPI_EDGE_LB_Connection_Status_Fields_Packets_Sent);
+    hdr = execStatusEntryFor(state, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Warnings);
 
-    conn_status->packets_sent = strtol(token->ptr, NULL, 10);
-    conn_status->hdr.fields_set |= NEPI_EDGE_LB_Connection_Status_Fields_Packets_Sent;
+    hdr->fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Warnings;
+    hdr->first_warning = state->file->string_count;
+    hdr->warning_count = 0;
+    state->currently_parsing_warnings = 1;
   }
-  else if (0 == strcmp(tmp_name, "msgrecv"))
+  else if (NEPI_EDGE_JSON_KEY_ERRORS == key)
   {
-    detectNewLBConnectionEntry(&conn_status, NEPI_EDGE_LB_Connection_Status_Fields_Messages_Received);
+    hdr = execStatusEntryFor(state, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Errors);
 
-    conn_status->messages_received = strtol(token->ptr, NULL, 10);
-    conn_status->hdr.fields_set |= NEPI_EDGE_LB_Connection_Status_Fields_Messages_Received;
-  }
-  else if ((0 == strcmp(tmp_name, "statsent")) || (0 == strcmp(tmp_name, "datasent")) ||
-           (0 == strcmp(tmp_name, "gensent")) || (0 == strcmp(tmp_name, "cfgrecv")) ||
-           (0 == strcmp(tmp_name, "genrecv")))
-  {
-    // We aren't doing anything with these fields presently
-    return;
+    hdr->fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Errors;
+    hdr->first_error = state->file->string_count;
+    hdr->error_count = 0;
+    state->currently_parsing_errors = 1;
   }
 
   // Otherwise, we're in the error or warning array
   else if ((token->type == JSON_TYPE_STRING) && (path[strlen(path) - 1] == ']'))
   {
-    // This cannot be the start of a new connections entry, so skip detectNewLBConnectionEntry
-    char *destination_buf = NULL;
-    if ((1 == conn_status->hdr.currently_parsing_warnings) && (conn_status->hdr.warning_count < NEPI_EDGE_MAX_COMMS_ERROR_CNT))
-    {
-      destination_buf = conn_status->hdr.warnings[conn_status->hdr.warning_count];
-      ++(conn_status->hdr.warning_count);
-    }
-    else if ((1 == conn_status->hdr.currently_parsing_errors) && (conn_status->hdr.error_count < NEPI_EDGE_MAX_COMMS_ERROR_CNT))
-    {
-      destination_buf = conn_status->hdr.errors[conn_status->hdr.error_count];
-      ++(conn_status->hdr.error_count);
-    }
-    else // Either we're in an unknown array or the warning/error array is already at max capacity
+    // This cannot be the start of a new connections entry, so skip execStatusEntryFor
+    if ((0 == state->currently_parsing_warnings) && (0 == state->currently_parsing_errors)) return; // Unknown array
+
+    char *str = execStatusPoolString(state, token);
+    if (NULL == str) return;
+    const NEPI_EDGE_RET_t ret = execStatusAppendString(state->file, str);
+    if (NEPI_EDGE_RET_OK != ret)
     {
+      state->ret = ret;
       return;
     }
-    const int bytes_to_copy = (token->len < NEPI_EDGE_MAX_COMMS_ERROR_STRLENGTH)? token->len : NEPI_EDGE_MAX_COMMS_ERROR_STRLENGTH;
-    memcpy(destination_buf, token->ptr, bytes_to_copy);
-    destination_buf[bytes_to_copy] = '\0';
+
+    // The array keeps its entry's run in the string table contiguous
+    if (1 == state->currently_parsing_warnings) ++(state->current->warning_count);
+    else ++(state->current->error_count);
   }
   else if (token->type == JSON_TYPE_ARRAY_END) // Must catch this one to update the state
   {
-    if (1 == conn_status->hdr.currently_parsing_warnings)
+    if (1 == state->currently_parsing_warnings)
     {
-      conn_status->hdr.currently_parsing_warnings = 0;
+      state->currently_parsing_warnings = 0;
     }
-    else if (1 == conn_status->hdr.currently_parsing_errors)
+    else if (1 == state->currently_parsing_errors)
     {
-      conn_status->hdr.currently_parsing_errors = 0;
+      state->currently_parsing_errors = 0;
     }
-    else
-    {
-      return; // Probably just the end of the "connections" array
-    }
-  }
-}
-
-static void detectNewHBConnectionEntry(struct NEPI_EDGE_HB_Connection_Status **conn_status, uint32_t field_mask)
-{
-  // If comms_type is already set, this is a new entry so step the linked list and start fresh
-  if ((*conn_status)->hdr.fields_set & field_mask)
-  {
-    (*conn_status)->next = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_HB_Connection_Status));
-    (*conn_status) = (*conn_status)->next;
-    (*conn_status)->next = NULL;
-    (*conn_status)->hdr.fields_set = 0;
-    (*conn_status)->hdr.currently_parsing_warnings = 0;
-    (*conn_status)->hdr.currently_parsing_errors = 0;
+    // Otherwise probably just the end of the "connections" array
   }
 }
 
-static void json_walk_exec_hb_status_callback(void *callback_data, const char *name, size_t name_len, const char *path, const struct json_token *token)
+static void json_walk_exec_lb_status_callback(void *callback_data, const char *name, size_t name_len, const char *path, const struct json_token *token)
 {
   if (token->type == JSON_TYPE_OBJECT_START || token->type == JSON_TYPE_OBJECT_END) return;
 
-  char tmp_name[1024];
-  size_t tmp_len = (name_len < 1024)? name_len : 1024;
-  strncpy(tmp_name, name, tmp_len);
-  tmp_name[tmp_len] = '\0';
+  const NEPI_EDGE_Json_Key_t key = NEPI_EDGE_JsonKeyLookup(name, name_len);
+
+  if (NEPI_EDGE_JSON_KEY_CONNECTIONS == key) return; // The start of the connections array, nothing to do
 
-  if (0 == strcmp(tmp_name, "connections")) return; // The start of the connections array, nothing to do
+  Exec_Status_Parse_State_t *state = (Exec_Status_Parse_State_t*)callback_data;
+  struct NEPI_EDGE_LB_Connection_Status *conn_status;
 
-  struct NEPI_EDGE_Exec_Status *exec_status = *(struct NEPI_EDGE_Exec_Status**)(callback_data);
-  if (exec_status->hb_conn_status == NULL) // First entry of linked list not allocated yet
+  if (NEPI_EDGE_JSON_KEY_MSGSENT == key)
   {
-    exec_status->hb_conn_status = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_HB_Connection_Status));
-    if (NULL == exec_status->hb_conn_status) return; // Not much we can do here -- probably totally hosed
+    conn_status = (struct NEPI_EDGE_LB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_LB_Connection_Status_Fields_Messages_Sent);
 
-    exec_status->hb_conn_status->next = NULL;
-    exec_status->hb_conn_status->hdr.fields_set = 0;
-    exec_status->hb_conn_status->hdr.currently_parsing_warnings = 0;
-    exec_status->hb_conn_status->hdr.currently_parsing_errors = 0;
+    conn_status->messages_sent = strtol(token->ptr, NULL, 10);
+    conn_status->hdr.fields_set |= NEPI_EDGE_LB_Connection_Status_Fields_Messages_Sent;
   }
-
-  struct NEPI_EDGE_HB_Connection_Status *conn_status = exec_status->hb_conn_status;
-
-  // Navigate to the last entry in the linked list -- that's the one we're working on right now
-  while (conn_status->next != NULL)
+  else if (NEPI_EDGE_JSON_KEY_PKTSENT == key)
   {
-    conn_status = conn_status->next;
-  }
+    conn_status = (struct NEPI_EDGE_LB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_LB_Connection_Status_Fields_Packets_Sent);
 
-  if (0 == strcmp(tmp_name, "comms_type"))
+    conn_status->packets_sent = strtol(token->ptr, NULL, 10);
+    conn_status->hdr.fields_set |= NEPI_EDGE_LB_Connection_Status_Fields_Packets_Sent;
+  }
+  else if (NEPI_EDGE_JSON_KEY_MSGRECV == key)
   {
-    detectNewHBConnectionEntry(&conn_status, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Comms_Type);
+    conn_status = (struct NEPI_EDGE_LB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_LB_Connection_Status_Fields_Messages_Received);
 
-    const size_t bytes_to_copy = (token->len < NEPI_EDGE_MAX_COMMS_TYPE_STRLENGTH)? token->len : NEPI_EDGE_MAX_COMMS_TYPE_STRLENGTH;
-    memcpy(conn_status->hdr.comms_type, token->ptr, bytes_to_copy);
-    conn_status->hdr.comms_type[bytes_to_copy] = '\0';
-    conn_status->hdr.fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Comms_Type;
+    conn_status->messages_received = strtol(token->ptr, NULL, 10);
+    conn_status->hdr.fields_set |= NEPI_EDGE_LB_Connection_Status_Fields_Messages_Received;
   }
-  else if (0 == strcmp(tmp_name, "status"))
+  else if (NEPI_EDGE_JSON_KEY_STATSENT == key)
   {
-    detectNewHBConnectionEntry(&conn_status, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Status);
-
-    conn_status->hdr.fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Status;
-    char tmp_val[1024];
-    size_t tmp_len = (token->len < 1024)? token->len : 1024;
-    memcpy(tmp_val, token->ptr, tmp_len);
-    tmp_val[tmp_len] = '\0';
+    conn_status = (struct NEPI_EDGE_LB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_LB_Connection_Status_Fields_Stat_Messages_Sent);
 
-    if (0 == strcmp(tmp_val, NEPI_EDGE_COMMS_STATUS_STRING_SUCCESS)) conn_status->hdr.status = NEPI_EDGE_COMMS_STATUS_SUCCESS;
-    else if (0 == strcmp(tmp_val, NEPI_EDGE_COMMS_STATUS_STRING_CONN_FAILED)) conn_status->hdr.status = NEPI_EDGE_COMMS_STATUS_CONN_FAILED;
-    else if (0 == strcmp(tmp_val, NEPI_EDGE_COMMS_STATUS_STRING_DISABLED)) conn_status->hdr.status = NEPI_EDGE_COMMS_STATUS_DISABLED;
-    else conn_status->hdr.status = NEPI_EDGE_COMMS_STATUS_UNKNOWN;
+    conn_status->stat_messages_sent = strtol(token->ptr, NULL, 10);
+    conn_status->hdr.fields_set |= NEPI_EDGE_LB_Connection_Status_Fields_Stat_Messages_Sent;
   }
-  else if (0 == strcmp(tmp_name, "timestart"))
+  else if (NEPI_EDGE_JSON_KEY_DATASENT == key)
   {
-    detectNewHBConnectionEntry(&conn_status, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Start_Time);
+    conn_status = (struct NEPI_EDGE_LB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_LB_Connection_Status_Fields_Data_Messages_Sent);
 
-    const size_t bytes_to_copy = (token->len < NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH)? token->len : NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH;
-    memcpy(conn_status->hdr.start_time_rfc3339, token->ptr, bytes_to_copy);
-    conn_status->hdr.start_time_rfc3339[bytes_to_copy] = '\0';
-    conn_status->hdr.fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Start_Time;
+    conn_status->data_messages_sent = strtol(token->ptr, NULL, 10);
+    conn_status->hdr.fields_set |= NEPI_EDGE_LB_Connection_Status_Fields_Data_Messages_Sent;
   }
-  else if (0 == strcmp(tmp_name, "timestop"))
+  else if (NEPI_EDGE_JSON_KEY_GENSENT == key)
   {
-    detectNewHBConnectionEntry(&conn_status, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Stop_Time);
+    conn_status = (struct NEPI_EDGE_LB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_LB_Connection_Status_Fields_Gen_Messages_Sent);
 
-    const size_t bytes_to_copy = (token->len < NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH)? token->len : NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH;
-    memcpy(conn_status->hdr.stop_time_rfc3339, token->ptr, bytes_to_copy);
-    conn_status->hdr.stop_time_rfc3339[bytes_to_copy] = '\0';
-    conn_status->hdr.fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Stop_Time;
+    conn_status->gen_messages_sent = strtol(token->ptr, NULL, 10);
+    conn_status->hdr.fields_set |= NEPI_EDGE_LB_Connection_Status_Fields_Gen_Messages_Sent;
   }
-  else if (0 == strcmp(tmp_name, "warnings"))
+  else if (NEPI_EDGE_JSON_KEY_CFGRECV == key)
   {
-    detectNewHBConnectionEntry(&conn_status, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Warnings);
+    conn_status = (struct NEPI_EDGE_LB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_LB_Connection_Status_Fields_Cfg_Messages_Received);
 
-    conn_status->hdr.fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Warnings;
-    conn_status->hdr.warning_count = 0;
-    conn_status->hdr.currently_parsing_warnings = 1;
+    conn_status->cfg_messages_received = strtol(token->ptr, NULL, 10);
+    conn_status->hdr.fields_set |= NEPI_EDGE_LB_Connection_Status_Fields_Cfg_Messages_Received;
   }
-  else if (0 == strcmp(tmp_name, "errors"))
+  else if (NEPI_EDGE_JSON_KEY_GENRECV == key)
   {
-    detectNewHBConnectionEntry(&conn_status, NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Errors);
+    conn_status = (struct NEPI_EDGE_LB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_LB_Connection_Status_Fields_Gen_Messages_Received);
 
-    conn_status->hdr.fields_set |= NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Errors;
-    conn_status->hdr.error_count = 0;
-    conn_status->hdr.currently_parsing_errors = 1;
+    conn_status->gen_messages_received = strtol(token->ptr, NULL, 10);
+    conn_status->hdr.fields_set |= NEPI_EDGE_LB_Connection_Status_Fields_Gen_Messages_Received;
+  }
+  else
+  {
+    json_walk_exec_status_common_callback(state, key, path, token);
   }
-  else if (0 == strcmp(tmp_name, "dtype"))
+}
+
+static void json_walk_exec_hb_status_callback(void *callback_data, const char *name, size_t name_len, const char *path, const struct json_token *token)
+{
+  if (token->type == JSON_TYPE_OBJECT_START || token->type == JSON_TYPE_OBJECT_END) return;
+
+  const NEPI_EDGE_Json_Key_t key = NEPI_EDGE_JsonKeyLookup(name, name_len);
+
+  if (NEPI_EDGE_JSON_KEY_CONNECTIONS == key) return; // The start of the connections array, nothing to do
+
+  Exec_Status_Parse_State_t *state = (Exec_Status_Parse_State_t*)callback_data;
+  struct NEPI_EDGE_HB_Connection_Status *conn_status;
+
+  if (NEPI_EDGE_JSON_KEY_DTYPE == key)
   {
-    detectNewHBConnectionEntry(&conn_status, NEPI_EDGE_HB_Connection_Status_Fields_Dtype);
+    conn_status = (struct NEPI_EDGE_HB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_HB_Connection_Status_Fields_Dtype);
 
     if (0 == memcmp("do", token->ptr, 2)) conn_status->direction = NEPI_EDGE_HB_DIRECTION_DO;
     //else if (0 == memcmp("dt", token->ptr, 2)) conn_status->direction = NEPI_EDGE_HB_DIRECTION_DT;
@@ -595,165 +743,226 @@ static void json_walk_exec_hb_status_callback(void *callback_data, const char *n
 
     conn_status->hdr.fields_set |= NEPI_EDGE_HB_Connection_Status_Fields_Dtype;
   }
-  else if (0 == strcmp(tmp_name, "datasent_kB"))
+  else if (NEPI_EDGE_JSON_KEY_DATASENT_KB == key)
   {
-    detectNewHBConnectionEntry(&conn_status, NEPI_EDGE_HB_Connection_Status_Fields_Data_Sent);
+    conn_status = (struct NEPI_EDGE_HB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_HB_Connection_Status_Fields_Data_Sent);
 
     conn_status->datasent_kB = strtol(token->ptr, NULL, 10);
     conn_status->hdr.fields_set |= NEPI_EDGE_HB_Connection_Status_Fields_Data_Sent;
   }
-  else if (0 == strcmp(tmp_name, "datarecv_kB"))
+  else if (NEPI_EDGE_JSON_KEY_DATARECV_KB == key)
   {
-    detectNewHBConnectionEntry(&conn_status, NEPI_EDGE_HB_Connection_Status_Fields_Data_Received);
+    conn_status = (struct NEPI_EDGE_HB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_HB_Connection_Status_Fields_Data_Received);
 
     conn_status->datareceived_kB = strtol(token->ptr, NULL, 10);
     conn_status->hdr.fields_set |= NEPI_EDGE_HB_Connection_Status_Fields_Data_Received;
   }
-  else if ((0 == strcmp(tmp_name, "numdirs")) || (0 == strcmp(tmp_name, "numfiles")))
+  else if (NEPI_EDGE_JSON_KEY_NUMDIRS == key)
   {
-    // We aren't doing anything with these fields presently
-    return;
-  }
+    conn_status = (struct NEPI_EDGE_HB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_HB_Connection_Status_Fields_Num_Dirs);
 
-  // Otherwise, we're in the error or warning array
-  else if ((token->type == JSON_TYPE_STRING) && (path[strlen(path) - 1] == ']'))
+    conn_status->num_dirs = strtol(token->ptr, NULL, 10);
+    conn_status->hdr.fields_set |= NEPI_EDGE_HB_Connection_Status_Fields_Num_Dirs;
+  }
+  else if (NEPI_EDGE_JSON_KEY_NUMFILES == key)
   {
-    // This cannot be the start of a new connections entry, so skip detectNewHBConnectionEntry
-    char *destination_buf = NULL;
-    if ((1 == conn_status->hdr.currently_parsing_warnings) && (conn_status->hdr.warning_count < NEPI_EDGE_MAX_COMMS_ERROR_CNT))
-    {
-      destination_buf = conn_status->hdr.warnings[conn_status->hdr.warning_count];
-      ++(conn_status->hdr.warning_count);
-    }
-    else if ((1 == conn_status->hdr.currently_parsing_errors) && (conn_status->hdr.error_count < NEPI_EDGE_MAX_COMMS_ERROR_CNT))
-    {
-      destination_buf = conn_status->hdr.errors[conn_status->hdr.error_count];
-      ++(conn_status->hdr.error_count);
-    }
-    else // Either we're in an unknown array or the warning/error array is alradyat max capacity
-    {
-      return;
-    }
-    const int bytes_to_copy = (token->len < NEPI_EDGE_MAX_COMMS_ERROR_STRLENGTH)? token->len : NEPI_EDGE_MAX_COMMS_ERROR_STRLENGTH;
-    memcpy(destination_buf, token->ptr, bytes_to_copy);
-    destination_buf[bytes_to_copy] = '\0';
+    conn_status = (struct NEPI_EDGE_HB_Connection_Status*)execStatusEntryFor(state, NEPI_EDGE_HB_Connection_Status_Fields_Num_Files);
+
+    conn_status->num_files = strtol(token->ptr, NULL, 10);
+    conn_status->hdr.fields_set |= NEPI_EDGE_HB_Connection_Status_Fields_Num_Files;
   }
-  else if (token->type == JSON_TYPE_ARRAY_END) // Must catch this one to update the state
+  else
   {
-    if (1 == conn_status->hdr.currently_parsing_warnings)
-    {
-      conn_status->hdr.currently_parsing_warnings = 0;
-    }
-    else if (1 == conn_status->hdr.currently_parsing_errors)
-    {
-      conn_status->hdr.currently_parsing_errors = 0;
-    }
-    else
-    {
-      return; // Probably just the end of the "connections" array
-    }
+    json_walk_exec_status_common_callback(state, key, path, token);
   }
 }
 
-NEPI_EDGE_RET_t NEPI_EDGE_ImportExecStatus(NEPI_EDGE_Exec_Status_t exec_status)
+static void getExecStatusFileId(const char *filename, NEPI_EDGE_Exec_Status_File_Id_t *id)
 {
-  VALIDATE_OPAQUE_TYPE(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status)
+  struct stat st;
+  memset(id, 0, sizeof(*id));
+  id->known = 1;
+  if (0 != stat(filename, &st)) return; // Treated as absent, as before
+
+  id->exists = 1;
+  id->dev = st.st_dev;
+  id->ino = st.st_ino;
+  id->size = st.st_size;
+  id->mtime = st.st_mtim;
+}
 
-  // Exec status comes in two files: lb_exec and hb_exec
-  // Parse each individually
-  char lb_exec_filename_with_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-  snprintf(lb_exec_filename_with_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s",
-           NEPI_EDGE_GetBotBaseFilePath(), NEPI_EDGE_LB_EXEC_STAT_FILE_PATH);
+uint8_t NEPI_EDGE_ExecStatusFileIdsMatch(const NEPI_EDGE_Exec_Status_File_Id_t *a, const NEPI_EDGE_Exec_Status_File_Id_t *b)
+{
+  if ((0 == a->known) || (0 == b->known) || (a->exists != b->exists)) return 0;
+  if (0 == a->exists) return 1;
+  return ((a->dev == b->dev) && (a->ino == b->ino) && (a->size == b->size) &&
+          (a->mtime.tv_sec == b->mtime.tv_sec) && (a->mtime.tv_nsec == b->mtime.tv_nsec))? 1 : 0;
+}
 
-  // Check if the lb exec status file exists, and if so, parse it
-  if (access(lb_exec_filename_with_path, F_OK) == 0)
+// Replaces one status file's entries, or leaves them be when only_if_changed and the file is as it was last read
+static NEPI_EDGE_RET_t readExecStatusFile(const char *filename, NEPI_EDGE_Exec_Status_File_t *file, uint8_t only_if_changed,
+                                          json_walk_callback_t callback, void *entries, size_t entry_size, size_t *entry_count,
+                                          size_t max_entries, uint8_t *updated)
+{
+  // Taken before reading, so a change that lands in between is caught on the next refresh rather than missed
+  NEPI_EDGE_Exec_Status_File_Id_t id;
+  getExecStatusFileId(filename, &id);
+  if ((1 == only_if_changed) && (1 == NEPI_EDGE_ExecStatusFileIdsMatch(&id, &(file->id))))
   {
-    char *json_string = json_fread(lb_exec_filename_with_path);
-    if (NULL == json_string) return NEPI_EDGE_RET_INVALID_FILE_FORMAT;
-    //printf("%s\n", json_string); // Debugging
-    json_walk(json_string, strlen(json_string), json_walk_exec_lb_status_callback, &p);
-    free(json_string); // Must free the frozen-malloc'd string
+    *updated = 0;
+    return NEPI_EDGE_RET_OK;
   }
 
-  char hb_exec_filename_with_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-  snprintf(hb_exec_filename_with_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s",
-           NEPI_EDGE_GetBotBaseFilePath(), NEPI_EDGE_HB_EXEC_STAT_FILE_PATH);
-
-  // Check if the hb exec status file exists, and if so, parse it
-  if (access(hb_exec_filename_with_path, F_OK) == 0)
+  *updated = 1;
+  *entry_count = 0;
+  file->pool_used = 0;
+  file->string_count = 0;
+  file->id.known = 0; // Until this read succeeds
+  if (0 == id.exists)
   {
-    char *json_string = json_fread(hb_exec_filename_with_path);
-    if (NULL == json_string) return NEPI_EDGE_RET_INVALID_FILE_FORMAT;
-    //printf("%s\n", json_string); // Debugging
-    json_walk(json_string, strlen(json_string), json_walk_exec_hb_status_callback, &p);
-    free(json_string); // Must free the frozen-malloc'd string
+    file->id = id;
+    return NEPI_EDGE_RET_OK;
   }
 
-  // Check if the sw update status file exists to inform caller if software has been updated... existence
-  // of this file is the indicator
-  char sw_status_filename_with_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-  snprintf(sw_status_filename_with_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s",
-           NEPI_EDGE_GetBotBaseFilePath(), NEPI_EDGE_SW_UPDATE_STAT_FILE_PATH);
-  if (access(sw_status_filename_with_path, F_OK) == 0)
+  NEPI_EDGE_File_Map_t *map;
+  if (NEPI_EDGE_RET_OK != NEPI_EDGE_FileMapOpen(filename, &map)) return NEPI_EDGE_RET_INVALID_FILE_FORMAT;
+
+  // Every string is quoted in the file, so its length always leaves room for the terminators
+  if (map->length > file->pool_size)
   {
-    p->software_updated = 1;
+    char *pool = NEPI_EDGE_REALLOC(file->pool, map->length);
+    if (NULL == pool)
+    {
+      NEPI_EDGE_FileMapCloseAll(map);
+      return NEPI_EDGE_RET_MALLOC_ERR;
+    }
+    file->pool = pool;
+    file->pool_size = map->length;
   }
-  else
+
+  Exec_Status_Parse_State_t state =
+  {
+    .file = file,
+    .entries = entries,
+    .entry_size = entry_size,
+    .entry_count = entry_count,
+    .max_entries = max_entries,
+    .current = NULL,
+    .currently_parsing_warnings = 0,
+    .currently_parsing_errors = 0,
+    .ret = NEPI_EDGE_RET_OK
+  };
+
+  //printf("%s\n", map->data); // Debugging
+  const int walk_ret = json_walk(map->data, map->length, callback, &state);
+  NEPI_EDGE_FileMapCloseAll(map); // Everything needed was copied out during the walk
+
+  // A file the bot is still writing can be cut short; the id stays unknown so the next refresh reads it again
+  if ((walk_ret <= 0) && (NEPI_EDGE_RET_OK == state.ret)) state.ret = NEPI_EDGE_RET_INVALID_FILE_FORMAT;
+  if (NEPI_EDGE_RET_OK != state.ret)
   {
-    p->software_updated = 0;
+    *entry_count = 0;
+    return state.ret;
   }
 
+  file->id = id;
   return NEPI_EDGE_RET_OK;
 }
 
-NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetCounts(NEPI_EDGE_Exec_Status_t exec_status, size_t *lb_counts, size_t *hb_counts)
+static NEPI_EDGE_RET_t readExecStatus(struct NEPI_EDGE_Context *ctx, struct NEPI_EDGE_Exec_Status *p, uint8_t only_if_changed,
+                                      uint32_t *updated_parts)
 {
-  VALIDATE_OPAQUE_TYPE(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status)
+  *updated_parts = 0;
+  uint8_t updated;
 
-  struct NEPI_EDGE_LB_Connection_Status *lb_conn_status = p->lb_conn_status;
-  *lb_counts = 0;
-  while (lb_conn_status != NULL)
+  // Exec status comes in two files: lb_exec and hb_exec, plus the sw update marker
+  char lb_exec_filename_with_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  char hb_exec_filename_with_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  char sw_status_filename_with_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  if ((snprintf(lb_exec_filename_with_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s",
+                ctx->bot_base_file_path, NEPI_EDGE_LB_EXEC_STAT_FILE_PATH) >= NEPI_EDGE_MAX_FILE_PATH_LENGTH) ||
+      (snprintf(hb_exec_filename_with_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s",
+                ctx->bot_base_file_path, NEPI_EDGE_HB_EXEC_STAT_FILE_PATH) >= NEPI_EDGE_MAX_FILE_PATH_LENGTH) ||
+      (snprintf(sw_status_filename_with_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s",
+                ctx->bot_base_file_path, NEPI_EDGE_SW_UPDATE_STAT_FILE_PATH) >= NEPI_EDGE_MAX_FILE_PATH_LENGTH))
   {
-    ++(*lb_counts);
-    lb_conn_status = lb_conn_status->next;
+    return NEPI_EDGE_RET_INVALID_BOT_PATH;
   }
 
-  struct NEPI_EDGE_HB_Connection_Status *hb_conn_status = p->hb_conn_status;
-  *hb_counts = 0;
-  while (hb_conn_status != NULL)
+  // Read each individually
+  NEPI_EDGE_RET_t ret = readExecStatusFile(lb_exec_filename_with_path, &(p->lb_file), only_if_changed,
+                                           json_walk_exec_lb_status_callback, p->lb_conn_status,
+                                           sizeof(struct NEPI_EDGE_LB_Connection_Status), &(p->lb_conn_count),
+                                           NEPI_EDGE_MAX_LB_CONNECTIONS_PER_EXEC, &updated);
+  // A part that was reread but failed has been cleared, which is still a change for the caller. The remaining parts are
+  // read regardless and the first error is returned once they all have been.
+  if (1 == updated) *updated_parts |= NEPI_EDGE_EXEC_STATUS_PART_LB;
+
+  const NEPI_EDGE_RET_t hb_ret = readExecStatusFile(hb_exec_filename_with_path, &(p->hb_file), only_if_changed,
+                                                    json_walk_exec_hb_status_callback, p->hb_conn_status,
+                                                    sizeof(struct NEPI_EDGE_HB_Connection_Status), &(p->hb_conn_count),
+                                                    NEPI_EDGE_MAX_HB_CONNECTIONS_PER_EXEC, &updated);
+  if (NEPI_EDGE_RET_OK == ret) ret = hb_ret;
+  if (1 == updated) *updated_parts |= NEPI_EDGE_EXEC_STATUS_PART_HB;
+
+  // Check if the sw update status file exists to inform caller if software has been updated... existence
+  // of this file is the indicator
+  NEPI_EDGE_Exec_Status_File_Id_t sw_update_file_id;
+  getExecStatusFileId(sw_status_filename_with_path, &sw_update_file_id);
+  if ((0 == only_if_changed) || (0 == NEPI_EDGE_ExecStatusFileIdsMatch(&sw_update_file_id, &(p->sw_update_file_id))))
   {
-    ++(*hb_counts);
-    hb_conn_status = hb_conn_status->next;
+    p->software_updated = sw_update_file_id.exists;
+    p->sw_update_file_id = sw_update_file_id;
+    *updated_parts |= NEPI_EDGE_EXEC_STATUS_PART_SW_UPDATE;
   }
 
-  return NEPI_EDGE_RET_OK;
+  return ret;
 }
 
-NEPI_EDGE_RET_t NEPI_EDGE_SoftwareWasUpdated(NEPI_EDGE_Exec_Status_t exec_status, uint8_t *software_was_updated)
+NEPI_EDGE_RET_t NEPI_EDGE_ImportExecStatus(NEPI_EDGE_Exec_Status_t exec_status)
 {
+  return NEPI_EDGE_ImportExecStatusCtx(&default_context, exec_status);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_ImportExecStatusCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Exec_Status_t exec_status)
+{
+  VALIDATE_CONTEXT(context)
   VALIDATE_OPAQUE_TYPE(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status)
 
-  *software_was_updated = p->software_updated;
+  uint32_t updated_parts;
+  return readExecStatus(ctx, p, 0, &updated_parts);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_RefreshExecStatus(NEPI_EDGE_Exec_Status_t exec_status, uint32_t *updated_parts)
+{
+  return NEPI_EDGE_RefreshExecStatusCtx(&default_context, exec_status, updated_parts);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_RefreshExecStatusCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Exec_Status_t exec_status,
+                                               uint32_t *updated_parts)
+{
+  VALIDATE_CONTEXT(context)
+  VALIDATE_OPAQUE_TYPE(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status)
+
+  return readExecStatus(ctx, p, 1, updated_parts);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetCounts(NEPI_EDGE_Exec_Status_t exec_status, size_t *lb_counts, size_t *hb_counts)
+{
+  VALIDATE_OPAQUE_TYPE(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status)
+
+  *lb_counts = p->lb_conn_count;
+  *hb_counts = p->hb_conn_count;
 
   return NEPI_EDGE_RET_OK;
 }
 
-static NEPI_EDGE_RET_t getLBStatusByIndex(struct NEPI_EDGE_Exec_Status *exec_status, struct NEPI_EDGE_LB_Connection_Status **lb_conn_status, size_t lb_index)
+NEPI_EDGE_RET_t NEPI_EDGE_SoftwareWasUpdated(NEPI_EDGE_Exec_Status_t exec_status, uint8_t *software_was_updated)
 {
-  *lb_conn_status = exec_status->lb_conn_status;
-  if (lb_conn_status == NULL) return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
+  VALIDATE_OPAQUE_TYPE(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status)
+
+  *software_was_updated = p->software_updated;
 
-  for (size_t i = 0; i < lb_index; ++i)
-  {
-    if ((*lb_conn_status)->next != NULL)
-    {
-      *lb_conn_status = (*lb_conn_status)->next;
-    }
-    else
-    {
-      return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
-    }
-  }
   return NEPI_EDGE_RET_OK;
 }
 
@@ -856,7 +1065,8 @@ NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetLBCommsGetWarnErrCount(NEPI_EDGE_Exec_Sta
   return NEPI_EDGE_RET_OK;
 }
 
-static NEPI_EDGE_RET_t getWarning(struct NEPI_EDGE_Connection_Status_Common_Hdr *hdr, size_t warning_index, char **warning_msg)
+static NEPI_EDGE_RET_t getWarning(NEPI_EDGE_Exec_Status_File_t *file, struct NEPI_EDGE_Connection_Status_Common_Hdr *hdr,
+                                  size_t warning_index, char **warning_msg)
 {
   if ((0 == (hdr->fields_set & NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Warnings)) ||
       (warning_index >= hdr->warning_count))
@@ -864,7 +1074,7 @@ static NEPI_EDGE_RET_t getWarning(struct NEPI_EDGE_Connection_Status_Common_Hdr
     return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
   }
 
-  *warning_msg = hdr->warnings[warning_index];
+  *warning_msg = file->strings[hdr->first_warning + warning_index];
   return NEPI_EDGE_RET_OK;
 }
 
@@ -872,10 +1082,11 @@ NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetLBCommsGetWarning(NEPI_EDGE_Exec_Status_t
 {
   EXTRACT_LB_CONNECTION_STATUS(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status, lb_index)
 
-  return getWarning(&(lb_conn_status->hdr), warning_index, warning_msg);
+  return getWarning(&(p->lb_file), &(lb_conn_status->hdr), warning_index, warning_msg);
 }
 
-static NEPI_EDGE_RET_t getError(struct NEPI_EDGE_Connection_Status_Common_Hdr *hdr, size_t error_index, char **error_msg)
+static NEPI_EDGE_RET_t getError(NEPI_EDGE_Exec_Status_File_t *file, struct NEPI_EDGE_Connection_Status_Common_Hdr *hdr,
+                                size_t error_index, char **error_msg)
 {
   if ((0 == (hdr->fields_set & NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Errors)) ||
       (error_index >= hdr->error_count))
@@ -883,7 +1094,7 @@ static NEPI_EDGE_RET_t getError(struct NEPI_EDGE_Connection_Status_Common_Hdr *h
     return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
   }
 
-  *error_msg = hdr->errors[error_index];
+  *error_msg = file->strings[hdr->first_error + error_index];
   return NEPI_EDGE_RET_OK;
 }
 
@@ -891,13 +1102,11 @@ NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetLBCommsGetError(NEPI_EDGE_Exec_Status_t e
 {
   EXTRACT_LB_CONNECTION_STATUS(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status, lb_index)
 
-  return getError(&(lb_conn_status->hdr), error_index, error_msg);
+  return getError(&(p->lb_file), &(lb_conn_status->hdr), error_index, error_msg);
 }
 
-NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetLBCommsStatistics(NEPI_EDGE_Exec_Status_t exec_status, size_t lb_index, size_t *msgs_sent, size_t *pkts_sent, size_t *msgs_rcvd)
+static void getLBStatistics(struct NEPI_EDGE_LB_Connection_Status *lb_conn_status, size_t *msgs_sent, size_t *pkts_sent, size_t *msgs_rcvd)
 {
-  EXTRACT_LB_CONNECTION_STATUS(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status, lb_index)
-
   // Initialize all to zero
   *msgs_sent = 0;
   *pkts_sent = 0;
@@ -915,26 +1124,13 @@ NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetLBCommsStatistics(NEPI_EDGE_Exec_Status_t
   {
     *msgs_rcvd = lb_conn_status->messages_received;
   }
-
-  return NEPI_EDGE_RET_OK;
 }
 
-static NEPI_EDGE_RET_t getHBStatusByIndex(struct NEPI_EDGE_Exec_Status *exec_status, struct NEPI_EDGE_HB_Connection_Status **hb_conn_status, size_t hb_index)
+NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetLBCommsStatistics(NEPI_EDGE_Exec_Status_t exec_status, size_t lb_index, size_t *msgs_sent, size_t *pkts_sent, size_t *msgs_rcvd)
 {
-  *hb_conn_status = exec_status->hb_conn_status;
-  if (hb_conn_status == NULL) return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
+  EXTRACT_LB_CONNECTION_STATUS(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status, lb_index)
 
-  for (size_t i = 0; i < hb_index; ++i)
-  {
-    if ((*hb_conn_status)->next != NULL)
-    {
-      *hb_conn_status = (*hb_conn_status)->next;
-    }
-    else
-    {
-      return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
-    }
-  }
+  getLBStatistics(lb_conn_status, msgs_sent, pkts_sent, msgs_rcvd);
   return NEPI_EDGE_RET_OK;
 }
 
@@ -975,20 +1171,18 @@ NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetHBCommsGetWarning(NEPI_EDGE_Exec_Status_t
 {
   EXTRACT_HB_CONNECTION_STATUS(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status, hb_index)
 
-  return getWarning(&(hb_conn_status->hdr), warning_index, warning_msg);
+  return getWarning(&(p->hb_file), &(hb_conn_status->hdr), warning_index, warning_msg);
 }
 
 NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetHBCommsGetError(NEPI_EDGE_Exec_Status_t exec_status, size_t hb_index, size_t error_index, char **error_msg)
 {
   EXTRACT_HB_CONNECTION_STATUS(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status, hb_index)
 
-  return getError(&(hb_conn_status->hdr), error_index, error_msg);
+  return getError(&(p->hb_file), &(hb_conn_status->hdr), error_index, error_msg);
 }
 
-NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetHBCommsStatistics(NEPI_EDGE_Exec_Status_t exec_status, size_t hb_index, size_t *datasent_kB, size_t *datareceived_kB)
+static void getHBStatistics(struct NEPI_EDGE_HB_Connection_Status *hb_conn_status, size_t *datasent_kB, size_t *datareceived_kB)
 {
-  EXTRACT_HB_CONNECTION_STATUS(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status, hb_index)
-
   *datasent_kB = 0;
   *datareceived_kB = 0;
 
@@ -1001,7 +1195,13 @@ NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetHBCommsStatistics(NEPI_EDGE_Exec_Status_t
   {
     *datareceived_kB = hb_conn_status->datareceived_kB;
   }
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetHBCommsStatistics(NEPI_EDGE_Exec_Status_t exec_status, size_t hb_index, size_t *datasent_kB, size_t *datareceived_kB)
+{
+  EXTRACT_HB_CONNECTION_STATUS(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status, hb_index)
 
+  getHBStatistics(hb_conn_status, datasent_kB, datareceived_kB);
   return NEPI_EDGE_RET_OK;
 }
 
@@ -1016,3 +1216,55 @@ NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetHBCommsDirection(NEPI_EDGE_Exec_Status_t
 
   return NEPI_EDGE_RET_OK;
 }
+
+static void getConnectionCommon(NEPI_EDGE_Exec_Status_File_t *file, struct NEPI_EDGE_Connection_Status_Common_Hdr *hdr,
+                                NEPI_EDGE_Exec_Status_Connection_Common_t *common)
+{
+  char *comms_type, *start_time, *stop_time;
+  getCommsType(hdr, &comms_type);
+  getCommsTimestamps(hdr, &start_time, &stop_time);
+  common->comms_type = comms_type;
+  common->start_time_rfc3339 = start_time;
+  common->stop_time_rfc3339 = stop_time;
+  getCommsStatus(hdr, &(common->status));
+  getWarnErrCount(hdr, &(common->warning_count), &(common->error_count));
+  common->warnings = (common->warning_count > 0)? (const char *const *)(file->strings + hdr->first_warning) : NULL;
+  common->errors = (common->error_count > 0)? (const char *const *)(file->strings + hdr->first_error) : NULL;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetConnections(NEPI_EDGE_Exec_Status_t exec_status,
+                                                   NEPI_EDGE_Exec_Status_LB_Connection_t *lb_conns, size_t max_lb_conns,
+                                                   size_t *lb_count,
+                                                   NEPI_EDGE_Exec_Status_HB_Connection_t *hb_conns, size_t max_hb_conns,
+                                                   size_t *hb_count)
+{
+  VALIDATE_OPAQUE_TYPE(exec_status, NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS, NEPI_EDGE_Exec_Status)
+
+  *lb_count = (p->lb_conn_count < max_lb_conns)? p->lb_conn_count : max_lb_conns;
+  for (size_t i = 0; i < *lb_count; ++i)
+  {
+    struct NEPI_EDGE_LB_Connection_Status *lb_conn_status = &(p->lb_conn_status[i]);
+    getConnectionCommon(&(p->lb_file), &(lb_conn_status->hdr), &(lb_conns[i].common));
+    getLBStatistics(lb_conn_status, &(lb_conns[i].msgs_sent), &(lb_conns[i].pkts_sent), &(lb_conns[i].msgs_rcvd));
+    // Entries start zeroed, so these read 0 where the bot left them out
+    lb_conns[i].stat_msgs_sent = lb_conn_status->stat_messages_sent;
+    lb_conns[i].data_msgs_sent = lb_conn_status->data_messages_sent;
+    lb_conns[i].gen_msgs_sent = lb_conn_status->gen_messages_sent;
+    lb_conns[i].cfg_msgs_rcvd = lb_conn_status->cfg_messages_received;
+    lb_conns[i].gen_msgs_rcvd = lb_conn_status->gen_messages_received;
+  }
+
+  *hb_count = (p->hb_conn_count < max_hb_conns)? p->hb_conn_count : max_hb_conns;
+  for (size_t i = 0; i < *hb_count; ++i)
+  {
+    struct NEPI_EDGE_HB_Connection_Status *hb_conn_status = &(p->hb_conn_status[i]);
+    getConnectionCommon(&(p->hb_file), &(hb_conn_status->hdr), &(hb_conns[i].common));
+    hb_conns[i].direction = (0 != (hb_conn_status->hdr.fields_set & NEPI_EDGE_HB_Connection_Status_Fields_Dtype))?
+      hb_conn_status->direction : NEPI_EDGE_HB_DIRECTION_UNKNOWN;
+    getHBStatistics(hb_conn_status, &(hb_conns[i].datasent_kB), &(hb_conns[i].datareceived_kB));
+    hb_conns[i].num_dirs = hb_conn_status->num_dirs;
+    hb_conns[i].num_files = hb_conn_status->num_files;
+  }
+
+  return NEPI_EDGE_RET_OK;
+}
@@ -11,12 +11,20 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
 
 #include "nepi_edge_sdk_link.h"
+#include "nepi_edge_export_staging_impl.h"
+#include "nepi_edge_bot_process_impl.h"
+#include "nepi_edge_bot_config_impl.h"
 
 // In case we want to provide arena allocator, etc. someday, don't call
 // malloc() and free() directly
 #define NEPI_EDGE_MALLOC(x) malloc((x))
+#define NEPI_EDGE_REALLOC(x,y) realloc((x),(y))
 #define NEPI_EDGE_FREE(x) free((x))
 
 #define VALIDATE_OPAQUE_TYPE(x,t,s) \
@@ -28,7 +36,10 @@ NEPI_EDGE_RET_t NEPI_EDGE_SDKCheckPath(const char* path);
 
 typedef enum NEPI_EDGE_OPAQUE_TYPE_ID
 {
-  NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS
+  NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_STATUS,
+  NEPI_EDGE_OPAQUE_TYPE_ID_CONTEXT,
+  NEPI_EDGE_OPAQUE_TYPE_ID_EXEC_HISTORY,
+  NEPI_EDGE_OPAQUE_TYPE_ID_BOT_CONFIG
 } NEPI_EDGE_OPAQUE_TYPE_ID;
 
 typedef struct NEPI_EDGE_Opaque_Helper
@@ -36,30 +47,55 @@ typedef struct NEPI_EDGE_Opaque_Helper
   NEPI_EDGE_OPAQUE_TYPE_ID msg_id;
 } NEPI_EDGE_Opaque_Helper_t;
 
-#define NEPI_EDGE_MAX_LB_CONNECTIONS_PER_EXEC     32
+#define NEPI_EDGE_NUID_STRLENGTH    16
 
-#define NEPI_EDGE_MAX_COMMS_TYPE_STRLENGTH   32
-#define NEPI_EDGE_MAX_COMMS_ERROR_STRLENGTH       64
-#define NEPI_EDGE_MAX_COMMS_ERROR_CNT             8
+// Everything tied to one bot installation. The API calls without a Ctx suffix operate on the default context.
+struct NEPI_EDGE_Context
+{
+  char bot_base_file_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  char bot_nuid[NEPI_EDGE_NUID_STRLENGTH];
+  NEPI_EDGE_Bot_Process_t bot; // A one-shot bot started by StartBot
+  struct NEPI_EDGE_Resident_Bot *resident; // NULL unless StartBotResident is in effect
+  pthread_rwlock_t resident_lock; // Held shared while resident is in use, exclusively to start or free it
+  uint32_t resident_generation; // Bumped by each StartBotResident, so a stop can tell its bot from a later one
+  NEPI_EDGE_Bot_Run_History_t bot_run_history; // Both kinds of bot
+  NEPI_EDGE_Bot_Restart_Policy_t bot_restart_policy; // Copied by the next StartBotResident
+  NEPI_EDGE_Bot_Start_Options_t bot_start_options; // Read by StartBot, copied by the next StartBotResident
+
+  char hb_targ_data_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH]; // Empty unless an HB data folder is linked
+
+  // Both are used by the async export writer thread as well as the caller's
+  atomic_uint general_do_file_count;
+  atomic_int bytes_encoding; // NEPI_EDGE_LB_Bytes_Encoding_t
+
+  NEPI_EDGE_Staging_State_t staging;
+  NEPI_EDGE_Bot_Config_Cache_t bot_config;
+
+  NEPI_EDGE_Opaque_Helper_t opaque_helper;
+};
+
+// Like VALIDATE_OPAQUE_TYPE, but the resolved pointer is named ctx so it can sit alongside a message's p
+#define VALIDATE_CONTEXT(x) \
+  if (NULL == (x)) return NEPI_EDGE_RET_UNINIT_OBJ;\
+  struct NEPI_EDGE_Context *ctx = (struct NEPI_EDGE_Context*)(x);\
+  if (ctx->opaque_helper.msg_id != NEPI_EDGE_OPAQUE_TYPE_ID_CONTEXT) return NEPI_EDGE_RET_WRONG_OBJ_TYPE;
 
 #define NEPI_EDGE_COMMS_STATUS_STRING_SUCCESS       "success"
 #define NEPI_EDGE_COMMS_STATUS_STRING_CONN_FAILED   "connfailed"
 #define NEPI_EDGE_COMMS_STATUS_STRING_DISABLED      "disabled"
 
+// Strings point into the pool of the status file the entry came from, and warnings/errors are runs of its string table
 struct NEPI_EDGE_Connection_Status_Common_Hdr
 {
-  char comms_type[NEPI_EDGE_MAX_COMMS_TYPE_STRLENGTH];
-  NEPI_EDGE_COMMS_STATUS_t status;
-  char start_time_rfc3339[NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH];
-  char stop_time_rfc3339[NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH];
-  char warnings[NEPI_EDGE_MAX_COMMS_ERROR_CNT][NEPI_EDGE_MAX_COMMS_ERROR_STRLENGTH];
-  size_t warning_count;
-  uint8_t currently_parsing_warnings; // helper
-  char errors[NEPI_EDGE_MAX_COMMS_ERROR_CNT][NEPI_EDGE_MAX_COMMS_ERROR_STRLENGTH];
-  size_t error_count;
-  uint8_t currently_parsing_errors; // helper
-
+  char *comms_type;
+  char *start_time_rfc3339;
+  char *stop_time_rfc3339;
+  uint32_t first_warning;
+  uint32_t warning_count;
+  uint32_t first_error;
+  uint32_t error_count;
   uint32_t fields_set;
+  NEPI_EDGE_COMMS_STATUS_t status;
 };
 
 typedef enum NEPI_EDGE_Connection_Status_Common_Hdr_Fields_Bitmask
@@ -80,15 +116,23 @@ struct NEPI_EDGE_LB_Connection_Status
   uint32_t messages_sent;
   uint32_t packets_sent;
   uint32_t messages_received;
-
-  struct NEPI_EDGE_LB_Connection_Status *next; // Linked list helper
+  uint32_t stat_messages_sent;
+  uint32_t data_messages_sent;
+  uint32_t gen_messages_sent;
+  uint32_t cfg_messages_received;
+  uint32_t gen_messages_received;
 };
 
 typedef enum NEPI_EDGE_LB_Connection_Status_Fields_Bitmask
 {
   NEPI_EDGE_LB_Connection_Status_Fields_Messages_Sent = (1u << 6),
   NEPI_EDGE_LB_Connection_Status_Fields_Packets_Sent = (1u << 7),
-  NEPI_EDGE_LB_Connection_Status_Fields_Messages_Received = (1u << 8)
+  NEPI_EDGE_LB_Connection_Status_Fields_Messages_Received = (1u << 8),
+  NEPI_EDGE_LB_Connection_Status_Fields_Stat_Messages_Sent = (1u << 9),
+  NEPI_EDGE_LB_Connection_Status_Fields_Data_Messages_Sent = (1u << 10),
+  NEPI_EDGE_LB_Connection_Status_Fields_Gen_Messages_Sent = (1u << 11),
+  NEPI_EDGE_LB_Connection_Status_Fields_Cfg_Messages_Received = (1u << 12),
+  NEPI_EDGE_LB_Connection_Status_Fields_Gen_Messages_Received = (1u << 13)
 } NEPI_EDGE_LB_Connection_Status_Fields_Bitmask_t;
 
 struct NEPI_EDGE_HB_Connection_Status
@@ -98,8 +142,8 @@ struct NEPI_EDGE_HB_Connection_Status
   uint32_t datasent_kB;
   uint32_t datareceived_kB;
   NEPI_EDGE_HB_DIRECTION_t direction;
-
-  struct NEPI_EDGE_HB_Connection_Status *next; // Linked list helper
+  uint32_t num_dirs;
+  uint32_t num_files;
 };
 
 typedef enum NEPI_EDGE_HB_Connection_Status_Fields_Bitmask
@@ -107,15 +151,52 @@ typedef enum NEPI_EDGE_HB_Connection_Status_Fields_Bitmask
   NEPI_EDGE_HB_Connection_Status_Fields_Data_Sent = (1u << 6),
   NEPI_EDGE_HB_Connection_Status_Fields_Data_Received = (1u << 7),
   NEPI_EDGE_HB_Connection_Status_Fields_Dtype = (1u << 8),
+  NEPI_EDGE_HB_Connection_Status_Fields_Num_Dirs = (1u << 9),
+  NEPI_EDGE_HB_Connection_Status_Fields_Num_Files = (1u << 10)
 } NEPI_EDGE_HB_Connection_Status_Fields_Bitmask_t;
 
+// What a status file looked like when last read, to tell whether it has changed since
+typedef struct
+{
+  uint8_t known; // 0 until read, and again after a failed read
+  uint8_t exists;
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  struct timespec mtime;
+} NEPI_EDGE_Exec_Status_File_Id_t;
+
+// 1 if both are known and describe the same file contents (or the same absence)
+uint8_t NEPI_EDGE_ExecStatusFileIdsMatch(const NEPI_EDGE_Exec_Status_File_Id_t *a, const NEPI_EDGE_Exec_Status_File_Id_t *b);
+
+// One status file's last read. Its strings are NUL-terminated back to back in pool, which is sized up front to the
+// file's length; that bounds the strings it contains, so pool is never reallocated mid-read and pointers into it hold.
+// Warnings and errors are also listed in strings, each entry's in a contiguous run.
+typedef struct
+{
+  NEPI_EDGE_Exec_Status_File_Id_t id;
+
+  char *pool;
+  size_t pool_size;
+  size_t pool_used;
+
+  char **strings;
+  size_t strings_size;
+  size_t string_count;
+} NEPI_EDGE_Exec_Status_File_t;
+
 struct NEPI_EDGE_Exec_Status
 {
-  struct NEPI_EDGE_LB_Connection_Status *lb_conn_status; // Linked list
+  struct NEPI_EDGE_LB_Connection_Status lb_conn_status[NEPI_EDGE_MAX_LB_CONNECTIONS_PER_EXEC];
+  size_t lb_conn_count;
+  NEPI_EDGE_Exec_Status_File_t lb_file;
 
-  struct NEPI_EDGE_HB_Connection_Status *hb_conn_status; // Linked list
+  struct NEPI_EDGE_HB_Connection_Status hb_conn_status[NEPI_EDGE_MAX_HB_CONNECTIONS_PER_EXEC];
+  size_t hb_conn_count;
+  NEPI_EDGE_Exec_Status_File_t hb_file;
 
   uint8_t software_updated;
+  NEPI_EDGE_Exec_Status_File_Id_t sw_update_file_id;
 
   NEPI_EDGE_Opaque_Helper_t opaque_helper;
 };
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#include "nepi_edge_timestamp_impl.h"
+
+#define SECS_PER_DAY  86400
+
+// Proleptic Gregorian calendar <-> days since 1970-01-01; see H. Hinnant, "chrono-Compatible Low-Level Date Algorithms"
+static int64_t days_from_civil(int64_t year, int month, int day)
+{
+  year -= (month <= 2)? 1 : 0;
+  const int64_t era = ((year >= 0)? year : (year - 399)) / 400;
+  const int64_t year_of_era = year - (era * 400);
+  const int64_t day_of_year = ((153 * (month + ((month > 2)? -3 : 9)) + 2) / 5) + day - 1;
+  const int64_t day_of_era = (year_of_era * 365) + (year_of_era / 4) - (year_of_era / 100) + day_of_year;
+  return (era * 146097) + day_of_era - 719468;
+}
+
+static void civil_from_days(int64_t days, int64_t *year, int *month, int *day)
+{
+  days += 719468;
+  const int64_t era = ((days >= 0)? days : (days - 146096)) / 146097;
+  const int64_t day_of_era = days - (era * 146097);
+  const int64_t year_of_era = (day_of_era - (day_of_era / 1460) + (day_of_era / 36524) - (day_of_era / 146096)) / 365;
+  const int64_t day_of_year = day_of_era - ((365 * year_of_era) + (year_of_era / 4) - (year_of_era / 100));
+  const int64_t mp = ((5 * day_of_year) + 2) / 153;
+  *day = (int)(day_of_year - (((153 * mp) + 2) / 5) + 1);
+  *month = (int)((mp < 10)? (mp + 3) : (mp - 9));
+  *year = year_of_era + (era * 400) + ((*month <= 2)? 1 : 0);
+}
+
+static int is_leap_year(int64_t year)
+{
+  return ((0 == (year % 4)) && (0 != (year % 100))) || (0 == (year % 400));
+}
+
+// Parse exactly digit_count decimal digits; returns the advanced pointer or NULL
+static const char* parse_fixed_digits(const char *s, int digit_count, int *val)
+{
+  int v = 0;
+  for (int i = 0; i < digit_count; ++i)
+  {
+    const unsigned d = (unsigned)(s[i] - '0');
+    if (d > 9) return NULL;
+    v = (v * 10) + (int)d;
+  }
+  *val = v;
+  return s + digit_count;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_TimestampParseRFC3339(const char *timestamp_rfc3339, int64_t *epoch_ns)
+{
+  if ((NULL == timestamp_rfc3339) || (NULL == epoch_ns)) return NEPI_EDGE_RET_BAD_PARAM;
+
+  const char *s = timestamp_rfc3339;
+  int year, month, day, hour, minute, second;
+
+  // Date and time are fixed-width, so just walk the string once
+  if (NULL == (s = parse_fixed_digits(s, 4, &year))) return NEPI_EDGE_RET_BAD_PARAM;
+  if ('-' != *s++) return NEPI_EDGE_RET_BAD_PARAM;
+  if (NULL == (s = parse_fixed_digits(s, 2, &month))) return NEPI_EDGE_RET_BAD_PARAM;
+  if ('-' != *s++) return NEPI_EDGE_RET_BAD_PARAM;
+  if (NULL == (s = parse_fixed_digits(s, 2, &day))) return NEPI_EDGE_RET_BAD_PARAM;
+  if (('T' != *s) && ('t' != *s) && (' ' != *s)) return NEPI_EDGE_RET_BAD_PARAM;
+  ++s;
+  if (NULL == (s = parse_fixed_digits(s, 2, &hour))) return NEPI_EDGE_RET_BAD_PARAM;
+  if (':' != *s++) return NEPI_EDGE_RET_BAD_PARAM;
+  if (NULL == (s = parse_fixed_digits(s, 2, &minute))) return NEPI_EDGE_RET_BAD_PARAM;
+  if (':' != *s++) return NEPI_EDGE_RET_BAD_PARAM;
+  if (NULL == (s = parse_fixed_digits(s, 2, &second))) return NEPI_EDGE_RET_BAD_PARAM;
+
+  static const int days_in_month[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  if ((month < 1) || (month > 12)) return NEPI_EDGE_RET_BAD_PARAM;
+  const int month_days = days_in_month[month - 1] + (((2 == month) && is_leap_year(year))? 1 : 0);
+  if ((day < 1) || (day > month_days)) return NEPI_EDGE_RET_BAD_PARAM;
+  if ((hour > 23) || (minute > 59) || (second > 60)) return NEPI_EDGE_RET_BAD_PARAM; // 60 is a leap second
+
+  // Fractional seconds -- any number of digits, truncated to nanoseconds
+  int64_t frac_ns = 0;
+  if (('.' == *s) || (',' == *s))
+  {
+    ++s;
+    int64_t scale = NEPI_EDGE_NSEC_PER_SEC;
+    const char *frac_start = s;
+    while ((unsigned)(*s - '0') <= 9)
+    {
+      if (scale > 1)
+      {
+        scale /= 10;
+        frac_ns += (*s - '0') * scale;
+      }
+      ++s;
+    }
+    if (s == frac_start) return NEPI_EDGE_RET_BAD_PARAM;
+  }
+
+  // UTC offset
+  int64_t offset_s = 0;
+  if (('+' == *s) || ('-' == *s))
+  {
+    const int sign = ('-' == *s)? -1 : 1;
+    int offset_hour, offset_minute;
+    ++s;
+    if (NULL == (s = parse_fixed_digits(s, 2, &offset_hour))) return NEPI_EDGE_RET_BAD_PARAM;
+    if (':' == *s) ++s;
+    if (NULL == (s = parse_fixed_digits(s, 2, &offset_minute))) return NEPI_EDGE_RET_BAD_PARAM;
+    if ((offset_hour > 23) || (offset_minute > 59)) return NEPI_EDGE_RET_BAD_PARAM;
+    offset_s = sign * ((offset_hour * 3600) + (offset_minute * 60));
+  }
+  else if (('Z' == *s) || ('z' == *s))
+  {
+    ++s;
+  }
+  if ('\0' != *s) return NEPI_EDGE_RET_BAD_PARAM;
+
+  const int64_t local_s = (days_from_civil(year, month, day) * SECS_PER_DAY) + (hour * 3600) + (minute * 60) + second;
+  *epoch_ns = ((local_s - offset_s) * NEPI_EDGE_NSEC_PER_SEC) + frac_ns;
+  return NEPI_EDGE_RET_OK;
+}
+
+static char* format_fixed_digits(char *d, int64_t val, int digit_count)
+{
+  for (int i = digit_count - 1; i >= 0; --i)
+  {
+    d[i] = (char)('0' + (val % 10));
+    val /= 10;
+  }
+  return d + digit_count;
+}
+
+void NEPI_EDGE_TimestampFormatRFC3339(int64_t epoch_ns, char timestamp_rfc3339[NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH])
+{
+  // Floor division so that pre-1970 times still get a non-negative fractional part
+  int64_t epoch_s = epoch_ns / NEPI_EDGE_NSEC_PER_SEC;
+  int64_t frac_ns = epoch_ns % NEPI_EDGE_NSEC_PER_SEC;
+  if (frac_ns < 0)
+  {
+    frac_ns += NEPI_EDGE_NSEC_PER_SEC;
+    --epoch_s;
+  }
+  int64_t days = epoch_s / SECS_PER_DAY;
+  int64_t secs_of_day = epoch_s % SECS_PER_DAY;
+  if (secs_of_day < 0)
+  {
+    secs_of_day += SECS_PER_DAY;
+    --days;
+  }
+
+  int64_t year;
+  int month, day;
+  civil_from_days(days, &year, &month, &day);
+
+  char *d = timestamp_rfc3339;
+  d = format_fixed_digits(d, year, 4);
+  *d++ = '-';
+  d = format_fixed_digits(d, month, 2);
+  *d++ = '-';
+  d = format_fixed_digits(d, day, 2);
+  *d++ = ' ';
+  d = format_fixed_digits(d, secs_of_day / 3600, 2);
+  *d++ = ':';
+  d = format_fixed_digits(d, (secs_of_day / 60) % 60, 2);
+  *d++ = ':';
+  d = format_fixed_digits(d, secs_of_day % 60, 2);
+  *d++ = '.';
+  d = format_fixed_digits(d, frac_ns, 9);
+  *d++ = '+';
+  *d++ = '0';
+  *d++ = '0';
+  *d++ = ':';
+  *d++ = '0';
+  *d++ = '0';
+  *d = '\0';
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#ifndef __NEPI_EDGE_TIMESTAMP_IMPL_H
+#define __NEPI_EDGE_TIMESTAMP_IMPL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "nepi_edge_sdk_link.h"
+
+#define NEPI_EDGE_NSEC_PER_MSEC  1000000LL
+#define NEPI_EDGE_NSEC_PER_SEC   1000000000LL
+
+// Parse an RFC3339 timestamp, e.g., 2020-08-21 09:50:25.431396857-04:00, into nanoseconds since the Unix epoch (UTC).
+// The date/time separator may be 'T', 't', or a space; fractional seconds beyond nanosecond resolution are truncated.
+// A missing UTC offset is taken as UTC. Returns NEPI_EDGE_RET_BAD_PARAM if the string is malformed.
+NEPI_EDGE_RET_t NEPI_EDGE_TimestampParseRFC3339(const char *timestamp_rfc3339, int64_t *epoch_ns);
+
+// Format nanoseconds since the Unix epoch as e.g., 2020-08-21 13:50:25.431396857+00:00 (the date --rfc-3339=ns layout)
+void NEPI_EDGE_TimestampFormatRFC3339(int64_t epoch_ns, char timestamp_rfc3339[NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH]);
+
+#endif //__NEPI_EDGE_TIMESTAMP_IMPL_H
@@ -9,34 +9,45 @@
 #include <unistd.h>
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "nepi_edge_sdk_link.h"
 #include "nepi_edge_sdk_link_impl.h"
 #include "nepi_edge_hb_interface.h"
 
-static char targ_data_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH] = {'\0'};
-
 NEPI_EDGE_RET_t NEPI_EDGE_HBLinkDataFolder(const char* data_folder_path)
 {
+  return NEPI_EDGE_HBLinkDataFolderCtx(NEPI_EDGE_GetDefaultContext(), data_folder_path);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_HBLinkDataFolderCtx(NEPI_EDGE_Context_t context, const char* data_folder_path)
+{
+  VALIDATE_CONTEXT(context)
+
   // First, check existence of the source data folder, and create it if necessary
   NEPI_EDGE_RET_t ret = NEPI_EDGE_SDKCheckPath(data_folder_path);
   if (NEPI_EDGE_RET_OK != ret) return ret;
 
   // Now, create/update the target data link
-  snprintf(targ_data_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s",
-           NEPI_EDGE_GetBotBaseFilePath(), NEPI_EDGE_HB_DO_DATA_FOLDER_PATH);
+  char targ_data_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  if (snprintf(targ_data_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s",
+               ctx->bot_base_file_path, NEPI_EDGE_HB_DO_DATA_FOLDER_PATH) >= NEPI_EDGE_MAX_FILE_PATH_LENGTH)
+  {
+    return NEPI_EDGE_RET_INVALID_BOT_PATH; // Any earlier link is left as it was
+  }
+  strcpy(ctx->hb_targ_data_path, targ_data_path);
 
   // Check if it exists -- if so, we must delete it first
-  if (0 == access( targ_data_path, F_OK))
+  if (0 == access( ctx->hb_targ_data_path, F_OK))
   {
-    if (0 != remove(targ_data_path))
+    if (0 != remove(ctx->hb_targ_data_path))
     {
       return NEPI_EDGE_RET_FILE_DELETE_ERROR;
     }
   }
 
   // Now create the symlink
-  if (0 != symlink(data_folder_path, targ_data_path))
+  if (0 != symlink(data_folder_path, ctx->hb_targ_data_path))
   {
       return NEPI_EDGE_RET_SYMLINK_CREATE_ERROR;
   }
@@ -46,13 +57,20 @@ NEPI_EDGE_RET_t NEPI_EDGE_HBLinkDataFolder(const char* data_folder_path)
 
 NEPI_EDGE_RET_t NEPI_EDGE_HBUnlinkDataFolder(void)
 {
-  if (targ_data_path[0] != '\0')
+  return NEPI_EDGE_HBUnlinkDataFolderCtx(NEPI_EDGE_GetDefaultContext());
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_HBUnlinkDataFolderCtx(NEPI_EDGE_Context_t context)
+{
+  VALIDATE_CONTEXT(context)
+
+  if (ctx->hb_targ_data_path[0] != '\0')
   {
-    if (0 != remove(targ_data_path))
+    if (0 != remove(ctx->hb_targ_data_path))
     {
       return NEPI_EDGE_RET_FILE_DELETE_ERROR;
     }
-    targ_data_path[0] = '\0';
+    ctx->hb_targ_data_path[0] = '\0';
   }
   return NEPI_EDGE_RET_OK;
 }
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#include <string.h>
+
+#include "nepi_edge_lb_interface.h"
+#include "nepi_lb_interface_impl.h"
+#include "nepi_edge_sdk_link_impl.h"
+
+// Open addressing with linear probing. Slots hold (param position + 1) so that zero marks an empty slot.
+
+static size_t hash_string_id(const char *id)
+{
+  // FNV-1a
+  uint64_t h = 14695981039346656037ULL;
+  for (const unsigned char *c = (const unsigned char*)id; *c != '\0'; ++c)
+  {
+    h ^= *c;
+    h *= 1099511628211ULL;
+  }
+  return (size_t)h;
+}
+
+static size_t hash_number_id(uint32_t id)
+{
+  // Fibonacci hashing spreads sequential ids across the table
+  return (size_t)((uint64_t)id * 11400714819323198485ULL >> 16);
+}
+
+static size_t hash_param_id(NEPI_EDGE_LB_Param_Id_Type_t id_type, NEPI_EDGE_LB_Param_Id_t id)
+{
+  return (NEPI_EDGE_LB_PARAM_ID_TYPE_STRING == id_type)? hash_string_id(id.id_string) : hash_number_id(id.id_number);
+}
+
+static int param_id_matches(const NEPI_EDGE_LB_Param_t *param, NEPI_EDGE_LB_Param_Id_Type_t id_type, NEPI_EDGE_LB_Param_Id_t id)
+{
+  if (param->id_type != id_type) return 0;
+  if (NEPI_EDGE_LB_PARAM_ID_TYPE_STRING == id_type) return (0 == strcmp(param->id.id_string, id.id_string));
+  return (param->id.id_number == id.id_number);
+}
+
+void NEPI_EDGE_LBConfigIndexFree(struct NEPI_EDGE_LB_Config *p)
+{
+  if (NULL != p->id_index)
+  {
+    NEPI_EDGE_FREE(p->id_index);
+  }
+  p->id_index = NULL;
+  p->id_index_capacity = 0;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigIndexBuild(struct NEPI_EDGE_LB_Config *p)
+{
+  NEPI_EDGE_LBConfigIndexFree(p);
+  if (0 == p->param_count) return NEPI_EDGE_RET_OK;
+
+  // Keep the load factor at or below 1/2
+  size_t capacity = 16;
+  while (capacity < (2 * p->param_count)) capacity <<= 1;
+
+  p->id_index = NEPI_EDGE_MALLOC(capacity * sizeof(size_t));
+  if (NULL == p->id_index) return NEPI_EDGE_RET_MALLOC_ERR;
+  memset(p->id_index, 0, capacity * sizeof(size_t));
+  p->id_index_capacity = capacity;
+
+  const size_t mask = capacity - 1;
+  for (size_t i = 0; i < p->param_count; ++i)
+  {
+    const NEPI_EDGE_LB_Param_t *param = &(p->params[i]);
+    if (NEPI_EDGE_LB_PARAM_ID_TYPE_UNKNOWN == param->id_type) continue;
+
+    size_t slot = hash_param_id(param->id_type, param->id) & mask;
+    while (0 != p->id_index[slot])
+    {
+      // Duplicate identifier: the later entry replaces the earlier one
+      if (param_id_matches(&(p->params[p->id_index[slot] - 1]), param->id_type, param->id)) break;
+      slot = (slot + 1) & mask;
+    }
+    p->id_index[slot] = i + 1;
+  }
+
+  return NEPI_EDGE_RET_OK;
+}
+
+const NEPI_EDGE_LB_Param_t* NEPI_EDGE_LBConfigIndexFind(const struct NEPI_EDGE_LB_Config *p,
+                                                        NEPI_EDGE_LB_Param_Id_Type_t id_type, NEPI_EDGE_LB_Param_Id_t id)
+{
+  if (NULL == p->id_index) return NULL;
+
+  const size_t mask = p->id_index_capacity - 1;
+  size_t slot = hash_param_id(id_type, id) & mask;
+  while (0 != p->id_index[slot])
+  {
+    const NEPI_EDGE_LB_Param_t *param = &(p->params[p->id_index[slot] - 1]);
+    if (param_id_matches(param, id_type, id)) return param;
+    slot = (slot + 1) & mask;
+  }
+  return NULL;
+}
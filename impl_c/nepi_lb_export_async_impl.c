@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2024 Numurus, LLC <https://www.numurus.com>.
+ *
+ * This file is part of nepi-engine
+ * (see https://github.com/nepi-engine).
+ *
+ * License: 3-clause BSD, see https://opensource.org/licenses/BSD-3-Clause
+ */
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+
+#include "nepi_edge_lb_interface.h"
+#include "nepi_lb_interface_impl.h"
+#include "nepi_edge_sdk_link_impl.h"
+
+#define ENSURE_FIELD_PRESENT(p,f) \
+  if (0 == ((p)->opaque_helper.fields_set & (f))) return NEPI_EDGE_RET_REQUIRED_FIELD_MISSING;
+
+typedef enum NEPI_EDGE_Async_Item_Type
+{
+  NEPI_EDGE_ASYNC_ITEM_DATA,
+  NEPI_EDGE_ASYNC_ITEM_GENERAL,
+  NEPI_EDGE_ASYNC_ITEM_STOP
+} NEPI_EDGE_Async_Item_Type_t;
+
+typedef struct NEPI_EDGE_Async_Item
+{
+  NEPI_EDGE_Async_Item_Type_t type;
+  struct NEPI_EDGE_Context *ctx; // Exported against this context
+  void *obj; // Status or general, owned by the queue once enqueued
+  NEPI_EDGE_LB_Data_Snippet_t *snippets; // Private copy of the caller's handle array
+  size_t snippet_count;
+} NEPI_EDGE_Async_Item_t;
+
+// Bounded multi-producer queue after D. Vyukov: each cell carries a sequence number that tells
+// producers and the consumer whose turn it is, so enqueue/dequeue are a single CAS on the happy path
+typedef struct NEPI_EDGE_Async_Cell
+{
+  atomic_size_t sequence;
+  NEPI_EDGE_Async_Item_t item;
+} NEPI_EDGE_Async_Cell_t;
+
+static NEPI_EDGE_Async_Cell_t *queue_cells = NULL;
+static size_t queue_mask = 0;
+static atomic_size_t enqueue_pos;
+static atomic_size_t dequeue_pos;
+
+// The queue itself never blocks; these let the writer sleep while it's empty and producers wait while it's full
+static sem_t items_available;
+static sem_t slots_available;
+
+static pthread_t writer_thread;
+static atomic_uint async_running;
+// Producers between their running check and their push; stop waits for them before queueing the stop request
+static atomic_size_t producers_active;
+static pthread_mutex_t producers_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t producers_done_cond = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t async_control_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Flush bookkeeping
+static atomic_size_t items_enqueued;
+static size_t items_completed = 0;
+static NEPI_EDGE_RET_t first_writer_error = NEPI_EDGE_RET_OK;
+static pthread_mutex_t completion_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t completion_cond = PTHREAD_COND_INITIALIZER;
+
+static int queue_push(const NEPI_EDGE_Async_Item_t *item)
+{
+  size_t pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+  for (;;)
+  {
+    NEPI_EDGE_Async_Cell_t *cell = &(queue_cells[pos & queue_mask]);
+    const size_t seq = atomic_load_explicit(&(cell->sequence), memory_order_acquire);
+    const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+    if (0 == diff)
+    {
+      if (atomic_compare_exchange_weak_explicit(&enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+      {
+        cell->item = *item;
+        atomic_store_explicit(&(cell->sequence), pos + 1, memory_order_release);
+        return 0;
+      }
+      // pos was reloaded by the failed CAS
+    }
+    else if (diff < 0)
+    {
+      return -1; // Full
+    }
+    else
+    {
+      pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+    }
+  }
+}
+
+static int queue_pop(NEPI_EDGE_Async_Item_t *item)
+{
+  size_t pos = atomic_load_explicit(&dequeue_pos, memory_order_relaxed);
+  for (;;)
+  {
+    NEPI_EDGE_Async_Cell_t *cell = &(queue_cells[pos & queue_mask]);
+    const size_t seq = atomic_load_explicit(&(cell->sequence), memory_order_acquire);
+    const intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+    if (0 == diff)
+    {
+      if (atomic_compare_exchange_weak_explicit(&dequeue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+      {
+        *item = cell->item;
+        atomic_store_explicit(&(cell->sequence), pos + queue_mask + 1, memory_order_release);
+        return 0;
+      }
+    }
+    else if (diff < 0)
+    {
+      return -1; // Empty
+    }
+    else
+    {
+      pos = atomic_load_explicit(&dequeue_pos, memory_order_relaxed);
+    }
+  }
+}
+
+static void release_item(NEPI_EDGE_Async_Item_t *item)
+{
+  switch (item->type)
+  {
+  case NEPI_EDGE_ASYNC_ITEM_DATA:
+    for (size_t i = 0; i < item->snippet_count; ++i)
+    {
+      NEPI_EDGE_LBDataSnippetDestroy(item->snippets[i]);
+    }
+    if (NULL != item->snippets) NEPI_EDGE_FREE(item->snippets);
+    NEPI_EDGE_LBStatusDestroy(item->obj);
+    break;
+  case NEPI_EDGE_ASYNC_ITEM_GENERAL:
+    NEPI_EDGE_LBGeneralDestroy(item->obj);
+    break;
+  default:
+    break;
+  }
+}
+
+static void* writer_thread_main(void *arg)
+{
+  (void)arg;
+  for (;;)
+  {
+    while (0 != sem_wait(&items_available)) {} // Retry on EINTR
+
+    NEPI_EDGE_Async_Item_t item;
+    if (0 != queue_pop(&item)) continue; // Can't happen -- the semaphore counts published items
+
+    NEPI_EDGE_RET_t ret = NEPI_EDGE_RET_OK;
+    if (NEPI_EDGE_ASYNC_ITEM_DATA == item.type)
+    {
+      ret = NEPI_EDGE_LBExportDataCtx(item.ctx, item.obj, item.snippets, item.snippet_count);
+    }
+    else if (NEPI_EDGE_ASYNC_ITEM_GENERAL == item.type)
+    {
+      ret = NEPI_EDGE_LBExportGeneralCtx(item.ctx, item.obj);
+    }
+    release_item(&item);
+
+    sem_post(&slots_available);
+
+    pthread_mutex_lock(&completion_lock);
+    ++items_completed;
+    if ((NEPI_EDGE_RET_OK == first_writer_error) && (NEPI_EDGE_RET_OK != ret)) first_writer_error = ret;
+    pthread_cond_broadcast(&completion_cond);
+    pthread_mutex_unlock(&completion_lock);
+
+    if (NEPI_EDGE_ASYNC_ITEM_STOP == item.type) break;
+  }
+  return NULL;
+}
+
+// Every producer leaves through here once announced. Only the last one out after a stop has begun needs to say so.
+static void producer_done(void)
+{
+  if ((1 == atomic_fetch_sub(&producers_active, 1)) && (0 == atomic_load(&async_running)))
+  {
+    pthread_mutex_lock(&producers_lock);
+    pthread_cond_broadcast(&producers_done_cond);
+    pthread_mutex_unlock(&producers_lock);
+  }
+}
+
+static NEPI_EDGE_RET_t enqueue(const NEPI_EDGE_Async_Item_t *item, NEPI_EDGE_Async_Full_Policy_t full_policy)
+{
+  // Announced before the running check, so a concurrent stop either sees this producer or is seen by it
+  atomic_fetch_add(&producers_active, 1);
+  if (0 == atomic_load(&async_running))
+  {
+    producer_done();
+    return NEPI_EDGE_RET_ASYNC_EXPORT_NOT_RUNNING;
+  }
+
+  if (NEPI_EDGE_ASYNC_FULL_WAIT == full_policy)
+  {
+    while (0 != sem_wait(&slots_available)) {}
+  }
+  else if (0 != sem_trywait(&slots_available))
+  {
+    producer_done();
+    return NEPI_EDGE_RET_WOULD_BLOCK;
+  }
+
+  // Stop posts extra slots to wake waiting producers, so one taken after it began may not be backed by the queue
+  if (0 == atomic_load(&async_running))
+  {
+    producer_done();
+    return NEPI_EDGE_RET_ASYNC_EXPORT_NOT_RUNNING;
+  }
+
+  // A slot is reserved, so the push can't find the queue full
+  atomic_fetch_add(&items_enqueued, 1);
+  queue_push(item);
+  sem_post(&items_available);
+  producer_done();
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBStartAsyncExport(size_t queue_depth)
+{
+  if (0 == queue_depth) return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
+
+  pthread_mutex_lock(&async_control_lock);
+  if (0 != atomic_load(&async_running))
+  {
+    pthread_mutex_unlock(&async_control_lock);
+    return NEPI_EDGE_RET_ASYNC_EXPORT_ALREADY_RUNNING;
+  }
+
+  // Round up to a power of two so positions can be masked; one extra slot holds the stop request
+  size_t capacity = 2;
+  while (capacity < queue_depth + 1) capacity <<= 1;
+
+  queue_cells = NEPI_EDGE_MALLOC(capacity * sizeof(NEPI_EDGE_Async_Cell_t));
+  if (NULL == queue_cells)
+  {
+    pthread_mutex_unlock(&async_control_lock);
+    return NEPI_EDGE_RET_MALLOC_ERR;
+  }
+  for (size_t i = 0; i < capacity; ++i)
+  {
+    atomic_init(&(queue_cells[i].sequence), i);
+  }
+  queue_mask = capacity - 1;
+  atomic_init(&enqueue_pos, 0);
+  atomic_init(&dequeue_pos, 0);
+  atomic_init(&items_enqueued, 0);
+  items_completed = 0;
+  first_writer_error = NEPI_EDGE_RET_OK;
+
+  sem_init(&items_available, 0, 0);
+  sem_init(&slots_available, 0, (unsigned int)queue_depth);
+
+  if (0 != pthread_create(&writer_thread, NULL, writer_thread_main, NULL))
+  {
+    sem_destroy(&items_available);
+    sem_destroy(&slots_available);
+    NEPI_EDGE_FREE(queue_cells);
+    queue_cells = NULL;
+    pthread_mutex_unlock(&async_control_lock);
+    return NEPI_EDGE_RET_CANT_START_THREAD;
+  }
+
+  atomic_store(&async_running, 1);
+  pthread_mutex_unlock(&async_control_lock);
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBFlushAsyncExport(void)
+{
+  // Held for the whole wait, so a stop can't tear the writer down underneath it
+  pthread_mutex_lock(&async_control_lock);
+  if (0 == atomic_load(&async_running))
+  {
+    pthread_mutex_unlock(&async_control_lock);
+    return NEPI_EDGE_RET_ASYNC_EXPORT_NOT_RUNNING;
+  }
+
+  const size_t target = atomic_load(&items_enqueued);
+
+  pthread_mutex_lock(&completion_lock);
+  while (items_completed < target)
+  {
+    pthread_cond_wait(&completion_cond, &completion_lock);
+  }
+  const NEPI_EDGE_RET_t ret = first_writer_error;
+  first_writer_error = NEPI_EDGE_RET_OK;
+  pthread_mutex_unlock(&completion_lock);
+
+  pthread_mutex_unlock(&async_control_lock);
+  return ret;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBStopAsyncExport(void)
+{
+  pthread_mutex_lock(&async_control_lock);
+  if (0 == atomic_load(&async_running))
+  {
+    pthread_mutex_unlock(&async_control_lock);
+    return NEPI_EDGE_RET_ASYNC_EXPORT_NOT_RUNNING;
+  }
+
+  // New producers now turn away. Those already holding a slot finish their push; the rest, including any blocked
+  // waiting for one, are woken to see the flag and back out. Anyone announced after this count reads the flag as
+  // already cleared and never waits, so one spare slot per counted producer is enough to wake them all.
+  // The writer keeps draining meanwhile.
+  atomic_store(&async_running, 0);
+  const size_t announced = atomic_load(&producers_active);
+  for (size_t i = 0; i < announced; ++i)
+  {
+    sem_post(&slots_available);
+  }
+  pthread_mutex_lock(&producers_lock);
+  while (0 != atomic_load(&producers_active))
+  {
+    pthread_cond_wait(&producers_done_cond, &producers_lock);
+  }
+  pthread_mutex_unlock(&producers_lock);
+
+  // The stop request queues up behind everything already submitted, so this drains the queue.
+  // It uses the spare slot reserved at start, so it never waits on producers' slots.
+  NEPI_EDGE_Async_Item_t stop_item;
+  memset(&stop_item, 0, sizeof(stop_item));
+  stop_item.type = NEPI_EDGE_ASYNC_ITEM_STOP;
+  atomic_fetch_add(&items_enqueued, 1);
+  queue_push(&stop_item);
+  sem_post(&items_available);
+
+  pthread_join(writer_thread, NULL);
+
+  const NEPI_EDGE_RET_t ret = first_writer_error;
+
+  sem_destroy(&items_available);
+  sem_destroy(&slots_available);
+  NEPI_EDGE_FREE(queue_cells);
+  queue_cells = NULL;
+
+  pthread_mutex_unlock(&async_control_lock);
+  return ret;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportDataAsync(NEPI_EDGE_LB_Status_t status, const NEPI_EDGE_LB_Data_Snippet_t *snippets, size_t snippet_count,
+                                            NEPI_EDGE_Async_Full_Policy_t full_policy)
+{
+  return NEPI_EDGE_LBExportDataAsyncCtx(NEPI_EDGE_GetDefaultContext(), status, snippets, snippet_count, full_policy);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportDataAsyncCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_Status_t status,
+                                               const NEPI_EDGE_LB_Data_Snippet_t *snippets, size_t snippet_count,
+                                               NEPI_EDGE_Async_Full_Policy_t full_policy)
+{
+  VALIDATE_CONTEXT(context)
+
+  // Validate up front so that obvious mistakes are reported to the caller rather than lost on the writer thread
+  {
+    VALIDATE_OPAQUE_TYPE(status, NEPI_EDGE_LB_MSG_ID_STATUS, NEPI_EDGE_LB_Status)
+    ENSURE_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_Timestamp)
+  }
+  for (size_t i = 0; i < snippet_count; ++i)
+  {
+    VALIDATE_OPAQUE_TYPE(snippets[i], NEPI_EDGE_LB_MSG_ID_DATA, NEPI_EDGE_LB_Data_Snippet)
+    ENSURE_FIELD_PRESENT(p, NEPI_EDGE_LB_Data_Snippet_Fields_TypeAndInstance)
+  }
+
+  NEPI_EDGE_Async_Item_t item;
+  item.type = NEPI_EDGE_ASYNC_ITEM_DATA;
+  item.ctx = ctx;
+  item.obj = status;
+  item.snippet_count = snippet_count;
+  item.snippets = NULL;
+  if (snippet_count > 0)
+  {
+    item.snippets = NEPI_EDGE_MALLOC(snippet_count * sizeof(NEPI_EDGE_LB_Data_Snippet_t));
+    if (NULL == item.snippets) return NEPI_EDGE_RET_MALLOC_ERR;
+    memcpy(item.snippets, snippets, snippet_count * sizeof(NEPI_EDGE_LB_Data_Snippet_t));
+  }
+
+  const NEPI_EDGE_RET_t ret = enqueue(&item, full_policy);
+  if ((NEPI_EDGE_RET_OK != ret) && (NULL != item.snippets))
+  {
+    NEPI_EDGE_FREE(item.snippets); // Caller keeps ownership of the objects themselves
+  }
+  return ret;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportGeneralAsync(NEPI_EDGE_LB_General_t general, NEPI_EDGE_Async_Full_Policy_t full_policy)
+{
+  return NEPI_EDGE_LBExportGeneralAsyncCtx(NEPI_EDGE_GetDefaultContext(), general, full_policy);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportGeneralAsyncCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_General_t general,
+                                                  NEPI_EDGE_Async_Full_Policy_t full_policy)
+{
+  VALIDATE_CONTEXT(context)
+
+  {
+    VALIDATE_OPAQUE_TYPE(general, NEPI_EDGE_LB_MSG_ID_GENERAL, NEPI_EDGE_LB_General)
+    ENSURE_FIELD_PRESENT(p, NEPI_EDGE_LB_General_Fields_Payload)
+  }
+
+  NEPI_EDGE_Async_Item_t item;
+  item.type = NEPI_EDGE_ASYNC_ITEM_GENERAL;
+  item.ctx = ctx;
+  item.obj = general;
+  item.snippets = NULL;
+  item.snippet_count = 0;
+  return enqueue(&item, full_policy);
+}
@@ -17,6 +17,13 @@
 #include "nepi_edge_sdk_link.h"
 #include "nepi_edge_sdk_link_impl.h"
 #include "nepi_edge_errors.h"
+#include "nepi_edge_out_buf_impl.h"
+#include "nepi_edge_export_staging_impl.h"
+#include "nepi_edge_file_attach_impl.h"
+#include "nepi_edge_timestamp_impl.h"
+#include "nepi_edge_file_map_impl.h"
+#include "nepi_edge_json_keys_impl.h"
+#include "nepi_edge_base64_impl.h"
 
 #include "frozen/frozen.h"
 
@@ -28,136 +35,99 @@
 
 #define CHECK_FIELD_PRESENT(p,f) ((p)->opaque_helper.fields_set & (f))
 
-static long int month_to_days(long int month, long int year)
-{
-  long int days = 0;
-  if (month > 1) days += 31;
-  if (month > 2)
-  {
-    if ((year / 4 == 0) && (year / 100 != 0)) days += 29;
-    else days += 28;
-  }
-  if (month > 3) days += 31;
-  if (month > 4) days += 30;
-  if (month > 5) days += 31;
-  if (month > 6) days += 30;
-  if (month > 7) days += 31;
-  if (month > 8) days += 31;
-  if (month > 9) days += 30;
-  if (month > 10) days += 31;
-  if (month > 11) days += 30;
-
-  return days;
-}
-
-static int64_t subtract_rfc3339_timestamps(const char *tstamp_1, const char *tstamp_2)
-{
-  // Must copy the strings because strtok modifies them
-  char tstamp_1_copy[NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH];
-  strncpy(tstamp_1_copy, tstamp_1, NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH);
-  char tstamp_2_copy[NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH];
-  strncpy(tstamp_2_copy, tstamp_2, NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH);
-  char *tmp_tok;
-
-  // Parse the strings: e.g., 2020-08-21 09:50:25.431396857-04:00
-  // We'll assume that local offset (last token) is the same
-  //const char delimiters[5] = "-T:,";
-  const long int year_1 = strtol(strtok(tstamp_1_copy, "-"), NULL, 10);
-  tmp_tok = strtok(NULL, "-");
-  const long int month_1 = (tmp_tok == NULL)? 0 : strtol(tmp_tok, NULL, 10);
-  tmp_tok = strtok(NULL, " T");
-  const long int day_1 = (tmp_tok == NULL)? 0 : strtol(tmp_tok, NULL, 10);
-  tmp_tok = strtok(NULL, ":");
-  const long int hour_1 = (tmp_tok == NULL)? 0 : strtol(tmp_tok, NULL, 10);
-  tmp_tok = strtok(NULL, ":");
-  const long int min_1 = (tmp_tok == NULL)? 0 : strtol(tmp_tok, NULL, 10);
-  tmp_tok = strtok(NULL, "+-Z");
-  const double sec_1 = (tmp_tok == NULL)? 0.0 : strtod(tmp_tok, NULL);
-
-  const long int year_2 = strtol(strtok(tstamp_2_copy, "-"), NULL, 10);
-  tmp_tok = strtok(NULL, "-");
-  const long int month_2 = (tmp_tok == NULL)? 0 : strtol(tmp_tok, NULL, 10);
-  tmp_tok = strtok(NULL, " T");
-  const long int day_2 = (tmp_tok == NULL)? 0 : strtol(tmp_tok, NULL, 10);
-  tmp_tok = strtok(NULL, ":");
-  const long int hour_2 = (tmp_tok == NULL)? 0 : strtol(tmp_tok, NULL, 10);
-  tmp_tok = strtok(NULL, ":");
-  const long int min_2 = (tmp_tok == NULL)? 0 : strtol(tmp_tok, NULL, 10);
-  tmp_tok = strtok(NULL, "-+Z");
-  const double sec_2 = (tmp_tok == NULL)? 0 : strtod(tmp_tok, NULL);
-
-  const long int days_1 = ((year_1 * 365) + (year_1 / 4) - (year_1 / 100)) +
-                           month_to_days(month_1, year_1) + (day_1 - 1);
-  const long int days_2 = ((year_2 * 365) + (year_2 / 4) - (year_2 / 100)) +
-                           month_to_days(month_2, year_2) + (day_2 - 1);
-  const int64_t msecs_1 = (days_1 * 86400000) + (hour_1 * 3600000) + (min_1 * 60000) + ((int64_t)(sec_1 * 1000.0));
-  const int64_t msecs_2 = (days_2 * 86400000) + (hour_2 * 3600000) + (min_2 * 60000) + ((int64_t)(sec_2 * 1000.0));
-
-  return msecs_1 - msecs_2;
-}
-
-static void writeParamToJsonFile(FILE* open_file, const NEPI_EDGE_LB_Param_t *param)
+NEPI_EDGE_RET_t NEPI_EDGE_LBSetBytesEncoding(NEPI_EDGE_LB_Bytes_Encoding_t encoding)
+{
+  return NEPI_EDGE_LBSetBytesEncodingCtx(NEPI_EDGE_GetDefaultContext(), encoding);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBSetBytesEncodingCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_Bytes_Encoding_t encoding)
+{
+  VALIDATE_CONTEXT(context)
+
+  if ((encoding != NEPI_EDGE_LB_BYTES_ENCODING_DECIMAL) && (encoding != NEPI_EDGE_LB_BYTES_ENCODING_BASE64))
+  {
+    return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
+  }
+
+  atomic_store_explicit(&(ctx->bytes_encoding), encoding, memory_order_relaxed);
+  return NEPI_EDGE_RET_OK;
+}
+
+static void writeParamToJsonBuf(NEPI_EDGE_Out_Buf_t *buf, const NEPI_EDGE_LB_Param_t *param, NEPI_EDGE_LB_Bytes_Encoding_t bytes_encoding)
 {
   // First the identifier
-  fprintf(open_file, "\t\"identifier\":");
+  NEPI_EDGE_OutBufAppendStr(buf, "\t\"identifier\":");
   if (param->id_type == NEPI_EDGE_LB_PARAM_ID_TYPE_STRING)
   {
-    fprintf(open_file, "\"%s\",\n", param->id.id_string);
+    NEPI_EDGE_OutBufAppendChar(buf, '"');
+    NEPI_EDGE_OutBufAppendStr(buf, param->id.id_string);
+    NEPI_EDGE_OutBufAppendStr(buf, "\",\n");
   }
   else
   {
-    fprintf(open_file, "%u,\n", param->id.id_number);
+    NEPI_EDGE_OutBufAppendUInt64(buf, param->id.id_number);
+    NEPI_EDGE_OutBufAppendStr(buf, ",\n");
   }
   // Then the value
-  fprintf(open_file, "\t\"value\":");
+  NEPI_EDGE_OutBufAppendStr(buf, "\t\"value\":");
 
   switch(param->value_type)
   {
     case NEPI_EDGE_LB_PARAM_VALUE_TYPE_BOOL:
-      fprintf(open_file, "%s\n", (param->value.bool_val == 0)? "false" : "true");
+      NEPI_EDGE_OutBufAppendStr(buf, (param->value.bool_val == 0)? "false\n" : "true\n");
       break;
     case NEPI_EDGE_LB_PARAM_VALUE_TYPE_INT64:
-      fprintf(open_file, "%ld\n", param->value.int64_val);
+      NEPI_EDGE_OutBufAppendInt64(buf, param->value.int64_val);
+      NEPI_EDGE_OutBufAppendChar(buf, '\n');
       break;
     case NEPI_EDGE_LB_PARAM_VALUE_TYPE_UINT64:
-      fprintf(open_file, "%lu\n", param->value.uint64_val);
+      NEPI_EDGE_OutBufAppendUInt64(buf, param->value.uint64_val);
+      NEPI_EDGE_OutBufAppendChar(buf, '\n');
       break;
     case NEPI_EDGE_LB_PARAM_VALUE_TYPE_FLOAT:
-      fprintf(open_file, "%f\n", param->value.float_val);
+      NEPI_EDGE_OutBufAppendDouble(buf, param->value.float_val);
+      NEPI_EDGE_OutBufAppendChar(buf, '\n');
       break;
     case NEPI_EDGE_LB_PARAM_VALUE_TYPE_DOUBLE:
-      fprintf(open_file, "%f\n", param->value.double_val);
+      NEPI_EDGE_OutBufAppendDouble(buf, param->value.double_val);
+      NEPI_EDGE_OutBufAppendChar(buf, '\n');
       break;
     case NEPI_EDGE_LB_PARAM_VALUE_TYPE_STRING:
-      fprintf(open_file, "\"%s\"\n", param->value.string_val);
+      NEPI_EDGE_OutBufAppendChar(buf, '"');
+      NEPI_EDGE_OutBufAppendStr(buf, param->value.string_val);
+      NEPI_EDGE_OutBufAppendStr(buf, "\"\n");
       break;
     case NEPI_EDGE_LB_PARAM_VALUE_TYPE_BYTES:
     {
-      if (param->value.bytes_val.length > 0)
+      if (NEPI_EDGE_LB_BYTES_ENCODING_BASE64 == bytes_encoding)
       {
-        const size_t byte_count = param->value.bytes_val.length;
-        fprintf(open_file, "[");
-        for (size_t i = 0; i < byte_count; ++i)
-        {
-          fprintf(open_file, "%u%s", param->value.bytes_val.val[i], (i == byte_count - 1)? "]" : ",");
-        }
+        NEPI_EDGE_OutBufAppendStr(buf, "{\"b64\":\"");
+        NEPI_EDGE_OutBufAppendBase64(buf, param->value.bytes_val.val, param->value.bytes_val.length);
+        NEPI_EDGE_OutBufAppendStr(buf, "\"}\n");
+      }
+      else if (param->value.bytes_val.length > 0)
+      {
+        NEPI_EDGE_OutBufAppendChar(buf, '[');
+        NEPI_EDGE_OutBufAppendByteList(buf, param->value.bytes_val.val, param->value.bytes_val.length);
+        NEPI_EDGE_OutBufAppendChar(buf, ']');
       }
       else
       {
-        fprintf(open_file, "[]\n");
+        NEPI_EDGE_OutBufAppendStr(buf, "[]\n");
       }
     } break;
   }
 }
 
 
-NEPI_EDGE_RET_t NEPI_EDGE_LBStatusCreate(NEPI_EDGE_LB_Status_t *status, const char* timestamp_rfc3339)
+// Everything but the timestamp string, which the callers fill in
+static NEPI_EDGE_RET_t create_status(NEPI_EDGE_LB_Status_t *status, int64_t timestamp_ns)
 {
   *status = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_LB_Status));
   if (NULL == *status) return NEPI_EDGE_RET_MALLOC_ERR;
 
   struct NEPI_EDGE_LB_Status *p = (struct NEPI_EDGE_LB_Status*)(*status);
-  strncpy(p->timestamp_rfc3339, timestamp_rfc3339, NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH);
+  p->timestamp_ns = timestamp_ns;
   p->opaque_helper.msg_id = NEPI_EDGE_LB_MSG_ID_STATUS;
   p->opaque_helper.fields_set = NEPI_EDGE_LB_Status_Fields_Timestamp;
 
@@ -165,6 +135,32 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBStatusCreate(NEPI_EDGE_LB_Status_t *status, const ch
   return NEPI_EDGE_RET_OK;
 }
 
+NEPI_EDGE_RET_t NEPI_EDGE_LBStatusCreate(NEPI_EDGE_LB_Status_t *status, const char* timestamp_rfc3339)
+{
+  int64_t timestamp_ns;
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_TimestampParseRFC3339(timestamp_rfc3339, &timestamp_ns);
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+
+  ret = create_status(status, timestamp_ns);
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+
+  // The string is kept verbatim -- it names the export folder and is echoed in the status file
+  struct NEPI_EDGE_LB_Status *p = (struct NEPI_EDGE_LB_Status*)(*status);
+  strncpy(p->timestamp_rfc3339, timestamp_rfc3339, NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH);
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBStatusCreateNs(NEPI_EDGE_LB_Status_t *status, int64_t timestamp_ns)
+{
+  const NEPI_EDGE_RET_t ret = create_status(status, timestamp_ns);
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+
+  // Only the folder name and status file need the string
+  struct NEPI_EDGE_LB_Status *p = (struct NEPI_EDGE_LB_Status*)(*status);
+  NEPI_EDGE_TimestampFormatRFC3339(timestamp_ns, p->timestamp_rfc3339);
+  return NEPI_EDGE_RET_OK;
+}
+
 NEPI_EDGE_RET_t NEPI_EDGE_LBStatusDestroy(NEPI_EDGE_LB_Status_t status)
 {
   VALIDATE_OPAQUE_TYPE(status, NEPI_EDGE_LB_MSG_ID_STATUS, NEPI_EDGE_LB_Status)
@@ -185,7 +181,18 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBStatusSetNavSatFixTime(NEPI_EDGE_LB_Status_t status,
 {
   VALIDATE_OPAQUE_TYPE(status, NEPI_EDGE_LB_MSG_ID_STATUS, NEPI_EDGE_LB_Status)
 
-  strncpy(p->navsat_fix_time_rfc3339, timestamp_rfc3339, NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH);
+  const NEPI_EDGE_RET_t ret = NEPI_EDGE_TimestampParseRFC3339(timestamp_rfc3339, &(p->navsat_fix_time_ns));
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+  p->opaque_helper.fields_set |= NEPI_EDGE_LB_Status_Fields_NavSatFixTime;
+
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBStatusSetNavSatFixTimeNs(NEPI_EDGE_LB_Status_t status, int64_t timestamp_ns)
+{
+  VALIDATE_OPAQUE_TYPE(status, NEPI_EDGE_LB_MSG_ID_STATUS, NEPI_EDGE_LB_Status)
+
+  p->navsat_fix_time_ns = timestamp_ns;
   p->opaque_helper.fields_set |= NEPI_EDGE_LB_Status_Fields_NavSatFixTime;
 
   return NEPI_EDGE_RET_OK;
@@ -312,7 +319,18 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBDataSnippetSetDataTimestamp(NEPI_EDGE_LB_Data_Snippe
 {
   VALIDATE_OPAQUE_TYPE(snippet, NEPI_EDGE_LB_MSG_ID_DATA, NEPI_EDGE_LB_Data_Snippet)
 
-  strncpy(p->data_time_rfc3339, data_time_rfc3339, NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH);
+  const NEPI_EDGE_RET_t ret = NEPI_EDGE_TimestampParseRFC3339(data_time_rfc3339, &(p->data_time_ns));
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+  p->opaque_helper.fields_set |= NEPI_EDGE_LB_Data_Snippet_Fields_Data_Time;
+
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBDataSnippetSetDataTimestampNs(NEPI_EDGE_LB_Data_Snippet_t snippet, int64_t data_time_ns)
+{
+  VALIDATE_OPAQUE_TYPE(snippet, NEPI_EDGE_LB_MSG_ID_DATA, NEPI_EDGE_LB_Data_Snippet)
+
+  p->data_time_ns = data_time_ns;
   p->opaque_helper.fields_set |= NEPI_EDGE_LB_Data_Snippet_Fields_Data_Time;
 
   return NEPI_EDGE_RET_OK;
@@ -400,120 +418,98 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBDataSnippetSetDataFile(NEPI_EDGE_LB_Data_Snippet_t s
   return NEPI_EDGE_RET_OK;
 }
 
-static NEPI_EDGE_RET_t export_status(const NEPI_EDGE_LB_Status_t status, const char* data_path)
+static NEPI_EDGE_RET_t export_status(const NEPI_EDGE_LB_Status_t status, const char* data_path, uint8_t sync_to_disk)
 {
   // Get the status timestamp; we'll need this later
   VALIDATE_OPAQUE_TYPE(status, NEPI_EDGE_LB_MSG_ID_STATUS, NEPI_EDGE_LB_Status)
   ENSURE_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_Timestamp)
 
-  // Now create the status file
-  char tmp_filename[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-  snprintf(tmp_filename, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", data_path, NEPI_EDGE_LB_STATUS_FILENAME);
-  FILE *status_file = fopen(tmp_filename, "w");
-  if (NULL == status_file) return NEPI_EDGE_RET_FILE_OPEN_ERR;
-
-  // Write the JSON -- Units and resolution are as-described in NEPI Capabilities Document
+  // Build the JSON in memory -- Units and resolution are as-described in NEPI Capabilities Document
+  NEPI_EDGE_Out_Buf_t buf;
+  NEPI_EDGE_OutBufInit(&buf);
 
   // Timestamp - RFC3339 String
-  fprintf(status_file, "{\n");
-  fprintf(status_file, "\t\"timestamp\":\"%s\"", p->timestamp_rfc3339); // Timestamp is required and verified above
+  NEPI_EDGE_OutBufAppendStr(&buf, "{\n\t\"timestamp\":\"");
+  NEPI_EDGE_OutBufAppendStr(&buf, p->timestamp_rfc3339); // Timestamp is required and verified above
+  NEPI_EDGE_OutBufAppendChar(&buf, '"');
 
   // All other fields are optional
 
   // Nav Sat Fix Time - Milliseconds difference from Timestamp (positive means later)
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_NavSatFixTime))
   {
-    const int64_t navsat_delta_ms = subtract_rfc3339_timestamps(p->timestamp_rfc3339, p->navsat_fix_time_rfc3339);
-    fprintf(status_file, ",\n\t\"navsat_fix_time_offset\":%ld", navsat_delta_ms);
+    const int64_t navsat_delta_ms = (p->timestamp_ns - p->navsat_fix_time_ns) / NEPI_EDGE_NSEC_PER_MSEC;
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"navsat_fix_time_offset\":");
+    NEPI_EDGE_OutBufAppendInt64(&buf, navsat_delta_ms);
   }
 
   // Latitude - Floating point degrees
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_Latitude))
   {
-    fprintf(status_file, ",\n\t\"latitude\":%f", p->latitude_deg);
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"latitude\":");
+    NEPI_EDGE_OutBufAppendDouble(&buf, p->latitude_deg);
   }
 
   // Longitude - Floating point degrees
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_Longitude))
   {
-    fprintf(status_file, ",\n\t\"longitude\":%f", p->longitude_deg);
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"longitude\":");
+    NEPI_EDGE_OutBufAppendDouble(&buf, p->longitude_deg);
   }
 
   // Heading - Millidegrees, Heading Ref - True North = 1, Mag. North = 0
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_HeadingAndRef))
   {
-    //fprintf(status_file, ",\n\t\"heading\":%f", p->heading_deg);
-    fprintf(status_file, ",\n\t\"heading\":%d", (int)(round(1000.0 * p->heading_deg)));
-    fprintf(status_file, ",\n\t\"heading_ref\":%d", (p->heading_ref == NEPI_EDGE_HEADING_REF_TRUE_NORTH)? 1 : 0);
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"heading\":");
+    NEPI_EDGE_OutBufAppendInt64(&buf, (int)(round(1000.0 * p->heading_deg)));
+    NEPI_EDGE_OutBufAppendStr(&buf, (p->heading_ref == NEPI_EDGE_HEADING_REF_TRUE_NORTH)? ",\n\t\"heading_ref\":1" : ",\n\t\"heading_ref\":0");
   }
 
   // Roll Angle - Millidegrees
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_RollAngle))
   {
-    //fprintf(status_file, ",\n\t\"roll_angle\":%f", p->roll_angle_deg);
-    fprintf(status_file, ",\n\t\"roll_angle\":%d", (int)(round(1000.0 * p->roll_angle_deg)));
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"roll_angle\":");
+    NEPI_EDGE_OutBufAppendInt64(&buf, (int)(round(1000.0 * p->roll_angle_deg)));
   }
 
   // Pitch Angle - Millidegrees
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_PitchAngle))
   {
-    //fprintf(status_file, ",\n\t\"pitch_angle\":%f", p->pitch_angle_deg);
-    fprintf(status_file, ",\n\t\"pitch_angle\":%d", (int)(round(1000.0 * p->pitch_angle_deg)));
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"pitch_angle\":");
+    NEPI_EDGE_OutBufAppendInt64(&buf, (int)(round(1000.0 * p->pitch_angle_deg)));
   }
 
   // Temperature - Decidegrees Celsius
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_Temperature))
   {
-    //fprintf(status_file, ",\n\t\"temperature\":%f", p->temperature_c);
-    fprintf(status_file, ",\n\t\"temperature\":%d", (int)(round(10 * p->temperature_c)));
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"temperature\":");
+    NEPI_EDGE_OutBufAppendInt64(&buf, (int)(round(10 * p->temperature_c)));
   }
 
   // Power State - [0, 100](%)
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_PowerState))
   {
-    fprintf(status_file, ",\n\t\"power_state\":%u", p->power_state_percentage);
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"power_state\":");
+    NEPI_EDGE_OutBufAppendUInt64(&buf, p->power_state_percentage);
   }
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_DeviceStatus))
   {
-    fprintf(status_file, ",\n\t\"device_status\":[");
-    for (size_t i = 0; i < p->device_status_entry_count; ++i)
-    {
-      fprintf(status_file, "%u%s", p->device_status_entries[i], (i == p->device_status_entry_count - 1)? "]" : ",");
-    }
-  }
-  fprintf(status_file, "\n}");
-
-  fclose(status_file);
-  return NEPI_EDGE_RET_OK;
-}
-
-static int copy_file(const char *src_filename, const char *destination_filename)
-{
-  FILE *src = fopen(src_filename, "r");
-  FILE *dest = fopen(destination_filename, "w");
-
-  if (src == NULL || dest == NULL)
-  {
-    return -1;
-  }
-
-  char cpy_buf[BUFSIZ];
-  size_t block_byte_count = 0;
-  while ((block_byte_count = fread(cpy_buf, sizeof(char), sizeof(cpy_buf), src)) > 0)
-  {
-    if (fwrite(cpy_buf, sizeof(char), block_byte_count, dest) != block_byte_count)
-    {
-      return -1;
-    }
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"device_status\":[");
+    NEPI_EDGE_OutBufAppendByteList(&buf, p->device_status_entries, p->device_status_entry_count);
+    if (p->device_status_entry_count > 0) NEPI_EDGE_OutBufAppendChar(&buf, ']');
   }
+  NEPI_EDGE_OutBufAppendStr(&buf, "\n}");
 
-  fclose(src);
-  fclose(dest);
-
-  return 0;
+  // Now create the status file in a single write
+  char tmp_filename[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  snprintf(tmp_filename, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", data_path, NEPI_EDGE_LB_STATUS_FILENAME);
+  const NEPI_EDGE_RET_t ret = NEPI_EDGE_OutBufWriteFile(&buf, tmp_filename, sync_to_disk);
+  NEPI_EDGE_OutBufFree(&buf);
+  return ret;
 }
 
-static NEPI_EDGE_RET_t export_data_snippet(NEPI_EDGE_LB_Data_Snippet_t snippet, const char* data_path, const struct NEPI_EDGE_LB_Status* status)
+static NEPI_EDGE_RET_t export_data_snippet(NEPI_EDGE_LB_Data_Snippet_t snippet, const char* data_path, const struct NEPI_EDGE_LB_Status* status,
+                                           uint8_t sync_to_disk, uint8_t *data_file_moved)
 {
   VALIDATE_OPAQUE_TYPE(snippet, NEPI_EDGE_LB_MSG_ID_DATA, NEPI_EDGE_LB_Data_Snippet)
   ENSURE_FIELD_PRESENT(p, NEPI_EDGE_LB_Data_Snippet_Fields_TypeAndInstance)
@@ -533,149 +529,287 @@ static NEPI_EDGE_RET_t export_data_snippet(NEPI_EDGE_LB_Data_Snippet_t snippet,
       strncpy(data_filename, (data_filename_ptr + 1), NEPI_EDGE_MAX_FILE_PATH_LENGTH);
     }
     char new_filename_with_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-    snprintf(new_filename_with_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", data_path, data_filename);
+    if (snprintf(new_filename_with_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", data_path, data_filename) >=
+        NEPI_EDGE_MAX_FILE_PATH_LENGTH)
+    {
+      return NEPI_EDGE_RET_ARG_TOO_LONG;
+    }
 
     // Copy or move it, depending on what was specified when the data file was added
     if (p->delete_on_export)
     {
-      if (-1 == rename(p->data_file, new_filename_with_path))
-      {
-        return NEPI_EDGE_RET_FILE_MOVE_ERROR;
-      }
+      const NEPI_EDGE_RET_t move_ret = NEPI_EDGE_AttachMove(p->data_file, new_filename_with_path, sync_to_disk);
+      if (NEPI_EDGE_RET_OK != move_ret) return move_ret;
+      *data_file_moved = 1;
     }
     else
     {
-      if (-1 == copy_file(p->data_file, new_filename_with_path))
-      {
-        return NEPI_EDGE_RET_FILE_MOVE_ERROR;
-      }
+      const NEPI_EDGE_RET_t copy_ret = NEPI_EDGE_AttachCopy(p->data_file, new_filename_with_path, sync_to_disk);
+      if (NEPI_EDGE_RET_OK != copy_ret) return copy_ret;
     }
 
     // Update the filename in the data structure
     strncpy(p->data_file, data_filename, NEPI_EDGE_MAX_FILE_PATH_LENGTH);
   }
 
-  char tmp_filename[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-  snprintf(tmp_filename, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%c%c%c%u.json", data_path, p->type[0], p->type[1], p->type[2], p->instance);
-  FILE *snippet_file = fopen(tmp_filename, "w");
-  if (NULL == snippet_file) return NEPI_EDGE_RET_FILE_OPEN_ERR;
+  // Now build the JSON -- Units and resolution are as-described in NEPI Capabilities Document
+  NEPI_EDGE_Out_Buf_t buf;
+  NEPI_EDGE_OutBufInit(&buf);
 
-  // Now write the JSON -- Units and resolution are as-described in NEPI Capabilities Document
-  fprintf(snippet_file, "{\n");
-  fprintf(snippet_file, "\t\"type\":\"%c%c%c\"", p->type[0], p->type[1], p->type[2]);
-  fprintf(snippet_file, ",\n\t\"instance\":%u", p->instance);
+  NEPI_EDGE_OutBufAppendStr(&buf, "{\n\t\"type\":\"");
+  NEPI_EDGE_OutBufAppend(&buf, p->type, NEPI_EDGE_DATA_SNIPPET_TYPE_LENGTH);
+  NEPI_EDGE_OutBufAppendStr(&buf, "\",\n\t\"instance\":");
+  NEPI_EDGE_OutBufAppendUInt64(&buf, p->instance);
 
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Data_Snippet_Fields_Data_Time))
   {
-    int64_t data_time_delta_ms = subtract_rfc3339_timestamps(status->timestamp_rfc3339, p->data_time_rfc3339);
-    fprintf(snippet_file, ",\n\t\"data_time_offset\":%ld", data_time_delta_ms);
+    const int64_t data_time_delta_ms = (status->timestamp_ns - p->data_time_ns) / NEPI_EDGE_NSEC_PER_MSEC;
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"data_time_offset\":");
+    NEPI_EDGE_OutBufAppendInt64(&buf, data_time_delta_ms);
   }
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Data_Snippet_Fields_Latitude))
   {
-    fprintf(snippet_file, ",\n\t\"latitude_offset\":%f", p->latitude_deg - status->latitude_deg);
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"latitude_offset\":");
+    NEPI_EDGE_OutBufAppendDouble(&buf, p->latitude_deg - status->latitude_deg);
   }
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Data_Snippet_Fields_Longitude))
   {
-    fprintf(snippet_file, ",\n\t\"longitude_offset\":%f", p->longitude_deg - status->longitude_deg);
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"longitude_offset\":");
+    NEPI_EDGE_OutBufAppendDouble(&buf, p->longitude_deg - status->longitude_deg);
   }
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Data_Snippet_Fields_Heading))
   {
-    //fprintf(snippet_file, ",\n\t\"heading_offset\":%f", p->heading_deg - status->heading_deg);
-    fprintf(snippet_file, ",\n\t\"heading_offset\":%d", (int)(round(1000.0f * (p->heading_deg - status->heading_deg))));
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"heading_offset\":");
+    NEPI_EDGE_OutBufAppendInt64(&buf, (int)(round(1000.0f * (p->heading_deg - status->heading_deg))));
   }
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Data_Snippet_Fields_RollAngle))
   {
-    //fprintf(snippet_file, ",\n\t\"roll_offset\":%f", p->roll_angle_deg - status->roll_angle_deg);
-    fprintf(snippet_file, ",\n\t\"roll_offset\":%d", (int)(round(1000.0f * (p->roll_angle_deg - status->roll_angle_deg))));
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"roll_offset\":");
+    NEPI_EDGE_OutBufAppendInt64(&buf, (int)(round(1000.0f * (p->roll_angle_deg - status->roll_angle_deg))));
   }
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Data_Snippet_Fields_PitchAngle))
   {
-    //fprintf(snippet_file, ",\n\t\"pitch_offset\":%f", p->pitch_angle_deg - status->pitch_angle_deg);
-    fprintf(snippet_file, ",\n\t\"pitch_offset\":%d", (int)(round(1000.0f * (p->pitch_angle_deg - status->pitch_angle_deg))));
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"pitch_offset\":");
+    NEPI_EDGE_OutBufAppendInt64(&buf, (int)(round(1000.0f * (p->pitch_angle_deg - status->pitch_angle_deg))));
   }
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Data_Snippet_Fields_Scores))
   {
-    fprintf(snippet_file, ",\n\t\"quality_score\":%f", p->quality_score);
-    fprintf(snippet_file, ",\n\t\"type_score\":%f", p->type_score);
-    fprintf(snippet_file, ",\n\t\"event_score\":%f", p->event_score);
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"quality_score\":");
+    NEPI_EDGE_OutBufAppendDouble(&buf, p->quality_score);
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"type_score\":");
+    NEPI_EDGE_OutBufAppendDouble(&buf, p->type_score);
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"event_score\":");
+    NEPI_EDGE_OutBufAppendDouble(&buf, p->event_score);
   }
   if (CHECK_FIELD_PRESENT(p, NEPI_EDGE_LB_Data_Snippet_Fields_DataFile))
   {
-    fprintf(snippet_file, ",\n\t\"data_file\":\"%s\"", p->data_file);
+    NEPI_EDGE_OutBufAppendStr(&buf, ",\n\t\"data_file\":\"");
+    NEPI_EDGE_OutBufAppendStr(&buf, p->data_file);
+    NEPI_EDGE_OutBufAppendChar(&buf, '"');
   }
 
-  fprintf(snippet_file, "\n}");
+  NEPI_EDGE_OutBufAppendStr(&buf, "\n}");
 
-  fclose(snippet_file);
-  return NEPI_EDGE_RET_OK;
+  char tmp_filename[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  // The sequence suffix keeps same-type snippets from different producers apart when their exports are merged
+  snprintf(tmp_filename, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%c%c%c%u-%u.json", data_path, p->type[0], p->type[1], p->type[2], p->instance,
+           NEPI_EDGE_StagingNextSequence());
+  const NEPI_EDGE_RET_t ret = NEPI_EDGE_OutBufWriteFile(&buf, tmp_filename, sync_to_disk);
+  NEPI_EDGE_OutBufFree(&buf);
+  return ret;
 }
 
-NEPI_EDGE_RET_t NEPI_EDGE_LBExportData(const NEPI_EDGE_LB_Status_t status, const NEPI_EDGE_LB_Data_Snippet_t *snippets, size_t snippet_count)
+// Write one status and its snippets into a fresh staging folder under data_root. On failure, nothing is left
+// to publish and the staging folder has already been discarded. data_file_moved is set if a caller's data file was
+// moved in, so that a failed publish doesn't delete it.
+static NEPI_EDGE_RET_t stage_export(const char *data_root, uint8_t sync_to_disk, const NEPI_EDGE_LB_Status_t status,
+                                    const NEPI_EDGE_LB_Data_Snippet_t *snippets, size_t snippet_count, char *staging_path,
+                                    uint8_t *data_file_moved)
 {
   VALIDATE_OPAQUE_TYPE(status, NEPI_EDGE_LB_MSG_ID_STATUS, NEPI_EDGE_LB_Status)
   ENSURE_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_Timestamp)
 
-  // Ensure the data path exists
-  char data_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-  snprintf(data_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s/%s",
-           NEPI_EDGE_GetBotBaseFilePath(), NEPI_EDGE_LB_DATA_FOLDER_PATH,
-           p->timestamp_rfc3339);
-
-  NEPI_EDGE_RET_t ret = NEPI_EDGE_SDKCheckPath(data_path);
+  *data_file_moved = 0;
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_StagingCreate(data_root, staging_path);
   if (NEPI_EDGE_RET_OK != ret) return ret;
 
   // Export the status
-  ret = export_status(status, data_path);
-  if (ret != NEPI_EDGE_RET_OK) return ret;
+  ret = export_status(status, staging_path, sync_to_disk);
 
   // Now export each of the data snippets
-  for (size_t i = 0; i < snippet_count; ++i)
+  for (size_t i = 0; (NEPI_EDGE_RET_OK == ret) && (i < snippet_count); ++i)
   {
-    ret = export_data_snippet(snippets[i], data_path, p);
-    if (ret != NEPI_EDGE_RET_OK) return ret;
+    ret = export_data_snippet(snippets[i], staging_path, p, sync_to_disk, data_file_moved);
   }
 
-  return NEPI_EDGE_RET_OK;
+  if (NEPI_EDGE_RET_OK != ret)
+  {
+    // Never delete a caller's data file that was already moved in
+    NEPI_EDGE_StagingDiscard(staging_path, *data_file_moved);
+  }
+  return ret;
 }
 
-NEPI_EDGE_RET_t NEPI_EDGE_LBConfigCreate(NEPI_EDGE_LB_Config_t *config)
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportData(const NEPI_EDGE_LB_Status_t status, const NEPI_EDGE_LB_Data_Snippet_t *snippets, size_t snippet_count)
 {
-  *config = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_LB_Config));
-  if (NULL == *config) return NEPI_EDGE_RET_MALLOC_ERR;
+  return NEPI_EDGE_LBExportDataCtx(NEPI_EDGE_GetDefaultContext(), status, snippets, snippet_count);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportDataCtx(NEPI_EDGE_Context_t context, const NEPI_EDGE_LB_Status_t status,
+                                          const NEPI_EDGE_LB_Data_Snippet_t *snippets, size_t snippet_count)
+{
+  VALIDATE_CONTEXT(context)
+  VALIDATE_OPAQUE_TYPE(status, NEPI_EDGE_LB_MSG_ID_STATUS, NEPI_EDGE_LB_Status)
+  ENSURE_FIELD_PRESENT(p, NEPI_EDGE_LB_Status_Fields_Timestamp)
+
+  // Ensure the data root exists
+  char data_root[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  if (snprintf(data_root, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", ctx->bot_base_file_path, NEPI_EDGE_LB_DATA_FOLDER_PATH) >=
+      NEPI_EDGE_MAX_FILE_PATH_LENGTH)
+  {
+    return NEPI_EDGE_RET_INVALID_BOT_PATH;
+  }
+
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_SDKCheckPath(data_root);
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+
+  // Everything is written into a hidden staging folder first so that the bot can never see a half-finished export
+  char staging_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  uint8_t data_file_moved;
+  ret = stage_export(data_root, NEPI_EDGE_StagingSyncEachFile(&(ctx->staging)), status, snippets, snippet_count, staging_path,
+                     &data_file_moved);
+  if (NEPI_EDGE_RET_OK != ret) return ret;
+
+  // And publish the whole export at once
+  return NEPI_EDGE_StagingPublish(&(ctx->staging), data_root, staging_path, p->timestamp_rfc3339, data_file_moved);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportDataBatch(const NEPI_EDGE_LB_Export_Group_t *groups, size_t group_count)
+{
+  return NEPI_EDGE_LBExportDataBatchCtx(NEPI_EDGE_GetDefaultContext(), groups, group_count);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportDataBatchCtx(NEPI_EDGE_Context_t context, const NEPI_EDGE_LB_Export_Group_t *groups, size_t group_count)
+{
+  VALIDATE_CONTEXT(context)
+  if ((NULL == groups) && (group_count > 0)) return NEPI_EDGE_RET_UNINIT_OBJ;
+  if (0 == group_count) return NEPI_EDGE_RET_OK;
+
+  // Resolve and check the data root once for the whole batch
+  char data_root[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  if (snprintf(data_root, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", ctx->bot_base_file_path, NEPI_EDGE_LB_DATA_FOLDER_PATH) >=
+      NEPI_EDGE_MAX_FILE_PATH_LENGTH)
+  {
+    return NEPI_EDGE_RET_INVALID_BOT_PATH;
+  }
+
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_SDKCheckPath(data_root);
+  if (NEPI_EDGE_RET_OK != ret) return ret;
 
-  struct NEPI_EDGE_LB_Config *p = (struct NEPI_EDGE_LB_Config*)(*config);
+  NEPI_EDGE_Staged_Export_t *staged = NEPI_EDGE_MALLOC(group_count * sizeof(NEPI_EDGE_Staged_Export_t));
+  if (NULL == staged) return NEPI_EDGE_RET_MALLOC_ERR;
 
+  // Stage in order, stopping at the first failure
+  const uint8_t sync_to_disk = NEPI_EDGE_StagingSyncEachFile(&(ctx->staging));
+  size_t staged_count = 0;
+  for (; staged_count < group_count; ++staged_count)
+  {
+    const NEPI_EDGE_LB_Export_Group_t *group = &(groups[staged_count]);
+    ret = stage_export(data_root, sync_to_disk, group->status, group->snippets, group->snippet_count, staged[staged_count].staging_path,
+                       &(staged[staged_count].keep_contents));
+    if (NEPI_EDGE_RET_OK != ret) break;
+    // stage_export validated the status, so this is safe
+    staged[staged_count].final_name = ((struct NEPI_EDGE_LB_Status*)group->status)->timestamp_rfc3339;
+  }
+
+  // Groups ahead of a failure are still published, just as a loop over NEPI_EDGE_LBExportData would have
+  const NEPI_EDGE_RET_t publish_ret = NEPI_EDGE_StagingPublishBatch(&(ctx->staging), data_root, staged, staged_count);
+  NEPI_EDGE_FREE(staged);
+
+  return (NEPI_EDGE_RET_OK != ret)? ret : publish_ret;
+}
+
+static void init_config(struct NEPI_EDGE_LB_Config *p)
+{
   p->opaque_helper.msg_id = NEPI_EDGE_LB_MSG_ID_CONFIG;
   p->opaque_helper.fields_set = 0;
   p->params = NULL;
-
-  return NEPI_EDGE_RET_OK;
+  p->param_count = 0;
+  p->param_capacity = 0;
+  p->id_index = NULL;
+  p->id_index_capacity = 0;
+  p->file_maps = NULL;
 }
 
-NEPI_EDGE_RET_t NEPI_EDGE_LBConfigDestroy(NEPI_EDGE_LB_Config_t config)
+static void free_config_params(struct NEPI_EDGE_LB_Config *p)
 {
-  VALIDATE_OPAQUE_TYPE(config, NEPI_EDGE_LB_MSG_ID_CONFIG, NEPI_EDGE_LB_Config)
-
-  NEPI_EDGE_LB_Param_t *param = p->params;
-  NEPI_EDGE_LB_Param_t *tmp;
-  while (param != NULL)
+  for (size_t i = 0; i < p->param_count; ++i)
   {
-    tmp = param;
-    if (param->id_type == NEPI_EDGE_LB_PARAM_ID_TYPE_STRING)
+    NEPI_EDGE_LB_Param_t *param = &(p->params[i]);
+    if ((param->id_type == NEPI_EDGE_LB_PARAM_ID_TYPE_STRING) && (0 == param->id_borrowed))
     {
       NEPI_EDGE_FREE(param->id.id_string);
     }
     if (param->value_type == NEPI_EDGE_LB_PARAM_VALUE_TYPE_STRING)
     {
-      NEPI_EDGE_FREE(param->value.string_val);
+      if (0 == param->value_borrowed) NEPI_EDGE_FREE(param->value.string_val);
     }
     else if (param->value_type == NEPI_EDGE_LB_PARAM_VALUE_TYPE_BYTES)
     {
       NEPI_EDGE_FREE(param->value.bytes_val.val);
     }
-    param = param->next;
-    NEPI_EDGE_FREE(tmp); // Make sure to free the param, itself
   }
+  if (NULL != p->params)
+  {
+    NEPI_EDGE_FREE(p->params);
+  }
+  p->params = NULL;
+  p->param_count = 0;
+  p->param_capacity = 0;
+  NEPI_EDGE_LBConfigIndexFree(p);
+
+  // Only now that nothing borrows from them
+  NEPI_EDGE_FileMapCloseAll(p->file_maps);
+  p->file_maps = NULL;
+}
+
+// Start a new, empty param at the end of the array; returns NULL on allocation failure
+static NEPI_EDGE_LB_Param_t* append_config_param(struct NEPI_EDGE_LB_Config *p)
+{
+  if (p->param_count == p->param_capacity)
+  {
+    const size_t new_capacity = (0 == p->param_capacity)? 16 : (2 * p->param_capacity);
+    NEPI_EDGE_LB_Param_t *new_params = NEPI_EDGE_REALLOC(p->params, new_capacity * sizeof(NEPI_EDGE_LB_Param_t));
+    if (NULL == new_params) return NULL;
+    p->params = new_params;
+    p->param_capacity = new_capacity;
+  }
+
+  NEPI_EDGE_LB_Param_t *param = &(p->params[p->param_count]);
+  ++(p->param_count);
+  param->id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_UNKNOWN;
+  param->value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_UNKNOWN;
+  param->id_borrowed = 0;
+  param->value_borrowed = 0;
+  param->parsing_byte_array = 0;
+  return param;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigCreate(NEPI_EDGE_LB_Config_t *config)
+{
+  *config = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_LB_Config));
+  if (NULL == *config) return NEPI_EDGE_RET_MALLOC_ERR;
+
+  init_config((struct NEPI_EDGE_LB_Config*)(*config));
+
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigDestroy(NEPI_EDGE_LB_Config_t config)
+{
+  VALIDATE_OPAQUE_TYPE(config, NEPI_EDGE_LB_MSG_ID_CONFIG, NEPI_EDGE_LB_Config)
+
+  free_config_params(p);
 
   NEPI_EDGE_FREE(config);
   config = NULL;
@@ -691,26 +825,7 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBConfigDestroyArray(NEPI_EDGE_LB_Config_t *config_arr
     NEPI_EDGE_LB_Config_t config_entry = (struct NEPI_EDGE_LB_Config*)config_array + i;
     VALIDATE_OPAQUE_TYPE(config_entry, NEPI_EDGE_LB_MSG_ID_CONFIG, NEPI_EDGE_LB_Config)
 
-    NEPI_EDGE_LB_Param_t *param = p->params;
-    NEPI_EDGE_LB_Param_t *tmp;
-    while (param != NULL)
-    {
-      tmp = param;
-      if (param->id_type == NEPI_EDGE_LB_PARAM_ID_TYPE_STRING)
-      {
-        NEPI_EDGE_FREE(param->id.id_string);
-      }
-      if (param->value_type == NEPI_EDGE_LB_PARAM_VALUE_TYPE_STRING)
-      {
-        NEPI_EDGE_FREE(param->value.string_val);
-      }
-      else if (param->value_type == NEPI_EDGE_LB_PARAM_VALUE_TYPE_BYTES)
-      {
-        NEPI_EDGE_FREE(param->value.bytes_val.val);
-      }
-      param = param->next;
-      NEPI_EDGE_FREE(tmp); // Make sure to free the param, itself
-    }
+    free_config_params(p);
   }
 
   // Now free the array block
@@ -719,14 +834,23 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBConfigDestroyArray(NEPI_EDGE_LB_Config_t *config_arr
   return NEPI_EDGE_RET_OK;
 }
 
+// Imported strings are used in place. The JSON is walked from a writable file map, and a string token's callback runs
+// while the walk sits on its closing quote, which it then steps over without reading again, so that quote can become
+// the terminator.
+static char* borrow_token_string(const struct json_token* token, uint8_t *borrowed)
+{
+  char *str = (char*)token->ptr;
+  str[token->len] = '\0';
+  *borrowed = 1;
+  return str;
+}
+
 static void parse_param_identifier(const struct json_token* token, NEPI_EDGE_LB_Param_t *param)
 {
   if (token->type == JSON_TYPE_STRING)
   {
     param->id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_STRING;
-    param->id.id_string = NEPI_EDGE_MALLOC(token->len + 1); // Freed in the Destroy method
-    memcpy(param->id.id_string, token->ptr, token->len);
-    param->id.id_string[token->len] = '\0';
+    param->id.id_string = borrow_token_string(token, &(param->id_borrowed));
   }
   else if (token->type == JSON_TYPE_NUMBER)
   {
@@ -735,32 +859,78 @@ static void parse_param_identifier(const struct json_token* token, NEPI_EDGE_LB_
   }
 }
 
-static void parse_param_value(const struct json_token* token, NEPI_EDGE_LB_Param_t *param)
+static inline int is_json_space(char c)
+{
+  return (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t');
+}
+
+// Decode a whole JSON byte array from its token span, "[" through "]", in a single pass. The output is sized up front
+// from the comma count, and each element is accumulated digit by digit rather than through strtol. Like the
+// per-element strtol it replaces, values wrap modulo 256. Anything other than an integer element is rejected.
+static NEPI_EDGE_RET_t decode_byte_array(const char *span, size_t span_len, NEPI_EDGE_LB_Param_Bytes_t *bytes)
 {
-  static uint8_t in_byte_array = 0; // This method is stateful
+  const char *c = span + 1;
+  const char *end = span + span_len - 1; // The closing bracket
+
+  bytes->val = NULL;
+  bytes->length = 0;
+
+  while ((c < end) && is_json_space(*c)) ++c;
+  if (c == end) return NEPI_EDGE_RET_OK; // Empty array
+
+  size_t capacity = 1;
+  for (const char *comma = c; NULL != (comma = memchr(comma, ',', end - comma)); ++comma)
+  {
+    ++capacity;
+  }
+  uint8_t *val = NEPI_EDGE_MALLOC(capacity);
+  if (NULL == val) return NEPI_EDGE_RET_MALLOC_ERR;
 
-  if (0 != in_byte_array)
+  size_t length = 0;
+  while (c < end)
   {
-    if (token->type == JSON_TYPE_NUMBER)
+    const uint8_t negative = ('-' == *c);
+    if (negative) ++c;
+
+    if ((c == end) || ((unsigned)(*c - '0') > 9)) break; // Not an integer
+    uint8_t v = 0;
+    do
     {
-      // Check if we need to allocate more memory
-      if (0 == (param->value.bytes_val.length % NEPI_EDGE_BYTE_ARRAY_BLOCK_SIZE))
-      {
-        // Free the existing memory
-        if (param->value.bytes_val.length > 0)
-        {
-          NEPI_EDGE_FREE(param->value.bytes_val.val);
-        }
-        // Allocate a larger block of memory
-        param->value.bytes_val.val = NEPI_EDGE_MALLOC(param->value.bytes_val.length + NEPI_EDGE_BYTE_ARRAY_BLOCK_SIZE);
-      }
+      v = (uint8_t)((v * 10) + (*c - '0'));
+      ++c;
+    } while ((c < end) && ((unsigned)(*c - '0') <= 9));
+    val[length++] = negative? (uint8_t)(0 - v) : v;
+
+    while ((c < end) && is_json_space(*c)) ++c;
+    if (c == end) break;
+    if (',' != *c) break;
+    ++c;
+    while ((c < end) && is_json_space(*c)) ++c;
+  }
 
-      param->value.bytes_val.val[param->value.bytes_val.length] = strtol(token->ptr, NULL, 10);
-      ++(param->value.bytes_val.length);
-    }
-    else if (token->type == JSON_TYPE_ARRAY_END)
+  if ((c != end) || (length != capacity))
+  {
+    NEPI_EDGE_FREE(val);
+    return NEPI_EDGE_RET_INVALID_FILE_FORMAT;
+  }
+
+  bytes->val = val;
+  bytes->length = length;
+  return NEPI_EDGE_RET_OK;
+}
+
+static void parse_param_value(const struct json_token* token, NEPI_EDGE_LB_Param_t *param)
+{
+  if (0 != param->parsing_byte_array)
+  {
+    // Individual elements are skipped; the closing token spans the whole array, so decode it all at once
+    if (token->type == JSON_TYPE_ARRAY_END)
     {
-      in_byte_array = 0;
+      param->parsing_byte_array = 0;
+      if (NEPI_EDGE_RET_OK == decode_byte_array(token->ptr, token->len, &(param->value.bytes_val)))
+      {
+        param->value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_BYTES;
+      }
     }
     return;
   }
@@ -769,16 +939,11 @@ static void parse_param_value(const struct json_token* token, NEPI_EDGE_LB_Param
   if (token->type == JSON_TYPE_STRING)
   {
     param->value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_STRING;
-    param->value.string_val = NEPI_EDGE_MALLOC(token->len + 1); // Freed in the Destroy method
-    memcpy(param->value.string_val, token->ptr, token->len);
-    param->value.string_val[token->len] = '\0';
+    param->value.string_val = borrow_token_string(token, &(param->value_borrowed));
   }
   else if (token->type == JSON_TYPE_ARRAY_START)
   {
-    param->value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_BYTES;
-    //param->value.bytes_val.val = NEPI_EDGE_MALLOC(NEPI_EDGE_BYTE_ARRAY_BLOCK_SIZE);
-    param->value.bytes_val.length = 0;
-    in_byte_array = 1; // Method state variable
+    param->parsing_byte_array = 1; // Value type is set once the array is decoded
   }
   else if (token->type == JSON_TYPE_NUMBER)
   {
@@ -815,74 +980,86 @@ static void parse_param_value(const struct json_token* token, NEPI_EDGE_LB_Param
   }
 }
 
+// A base64 byte array arrives as the string inside "value":{"b64":"..."}. The string holds no JSON escapes, so it is
+// decoded straight from the token. A malformed string leaves the value type UNKNOWN.
+static void parse_param_base64(const struct json_token* token, NEPI_EDGE_LB_Param_t *param)
+{
+  if (token->type != JSON_TYPE_STRING) return;
+
+  NEPI_EDGE_LB_Param_Bytes_t *bytes = &(param->value.bytes_val);
+  bytes->val = NULL;
+  bytes->length = 0;
+  if (token->len > 0)
+  {
+    uint8_t *val = NEPI_EDGE_MALLOC(NEPI_EDGE_BASE64_DECODED_MAX_LENGTH(token->len) + 1);
+    if (NULL == val) return;
+    size_t length;
+    if (NEPI_EDGE_RET_OK != NEPI_EDGE_Base64Decode(token->ptr, token->len, val, &length))
+    {
+      NEPI_EDGE_FREE(val);
+      return;
+    }
+    bytes->val = val;
+    bytes->length = length;
+  }
+  param->value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_BYTES;
+}
+
 static void json_walk_config_callback(void *callback_data, const char *name, size_t name_len, const char *path, const struct json_token *token)
 {
+  (void)path; // Keys are matched by name alone
   if (token->type == JSON_TYPE_OBJECT_START || token->type == JSON_TYPE_OBJECT_END) return;
 
   struct NEPI_EDGE_LB_Config *p = (struct NEPI_EDGE_LB_Config*)callback_data;
 
-  char tmp_name[1024];
-  size_t tmp_len = (name_len < 1024)? name_len : 1024;
-  strncpy(tmp_name, name, tmp_len);
-  tmp_name[tmp_len] = '\0';
+  const NEPI_EDGE_Json_Key_t key = NEPI_EDGE_JsonKeyLookup(name, name_len);
+
+  if (NEPI_EDGE_JSON_KEY_PARAMS == key) return; // The start of the params array, nothing to do
 
-  if (0 == strcmp(tmp_name, "params")) return; // The start of the params array, nothing to do
+  // The param being filled in is always the tail of the array
+  NEPI_EDGE_LB_Param_t *param = (p->param_count > 0)? &(p->params[p->param_count - 1]) : NULL;
 
-  // Find the last valid entry in the param linked list
-  NEPI_EDGE_LB_Param_t *param = p->params;
-  if (param != NULL)
+  if (NEPI_EDGE_JSON_KEY_IDENTIFIER == key)
   {
-    while (param->next != NULL)
+    // Check if this is a new param entry and if so, start the next one
+    if ((NULL == param) || (param->id_type != NEPI_EDGE_LB_PARAM_ID_TYPE_UNKNOWN))
     {
-      param = param->next;
+      param = append_config_param(p);
+      if (NULL == param) return;
     }
-  }
-  else // First entry, so allocate and initialize
-  {
-    p->params = NEPI_EDGE_MALLOC(sizeof(NEPI_EDGE_LB_Param_t));
-    p->params->next = NULL;
-    p->params->id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_UNKNOWN;
-    p->params->value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_UNKNOWN;
-    param = p->params;
-    p->opaque_helper.fields_set |= NEPI_EDGE_LB_Config_Fields_Params;
-  }
 
-  if (0 == strcmp(tmp_name, "identifier"))
+    parse_param_identifier(token, param);
+    p->opaque_helper.fields_set |= NEPI_EDGE_LB_Config_Fields_Params; // No harm in setting this every time
+  }
+  else if (NEPI_EDGE_JSON_KEY_VALUE == key)
   {
-    // Check if this is a new param entry and if so, close out the last one and create the new one
-    if (param->id_type != NEPI_EDGE_LB_PARAM_ID_TYPE_UNKNOWN)
+    // Check if this is a new param entry and if so, start the next one
+    if ((NULL == param) || (param->value_type != NEPI_EDGE_LB_PARAM_VALUE_TYPE_UNKNOWN))
     {
-      param->next = NEPI_EDGE_MALLOC(sizeof(NEPI_EDGE_LB_Param_t));
-      param = param->next;
-      param->next = NULL;
-      param->id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_UNKNOWN;
-      param->value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_UNKNOWN;
+      param = append_config_param(p);
+      if (NULL == param) return;
     }
 
-    parse_param_identifier(token, param);
+    parse_param_value(token, param);
     p->opaque_helper.fields_set |= NEPI_EDGE_LB_Config_Fields_Params; // No harm in setting this every time
   }
-  else if (0 == strcmp(tmp_name, "value"))
+  else if (NEPI_EDGE_JSON_KEY_B64 == key)
   {
-    // Check if this is a new param entry and if so, close out the last one and create the new one
-    if (param->value_type != NEPI_EDGE_LB_PARAM_VALUE_TYPE_UNKNOWN)
+    // Same as a plain value -- the enclosing "value" object itself is skipped above
+    if ((NULL == param) || (param->value_type != NEPI_EDGE_LB_PARAM_VALUE_TYPE_UNKNOWN))
     {
-      param->next = NEPI_EDGE_MALLOC(sizeof(NEPI_EDGE_LB_Param_t));
-      param = param->next;
-      param->next = NULL;
-      param->id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_UNKNOWN;
-      param->value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_UNKNOWN;
+      param = append_config_param(p);
+      if (NULL == param) return;
     }
 
-    parse_param_value(token, param);
+    parse_param_base64(token, param);
     p->opaque_helper.fields_set |= NEPI_EDGE_LB_Config_Fields_Params; // No harm in setting this every time
   }
-  else if ((token->type == JSON_TYPE_NUMBER) && (path[strlen(path) - 1] == ']'))
+  else if (NULL == param)
   {
-    // Might be inside a byte-array, in that case this will be a JSON_NUMBER and the last path character will be a closing bracket
-    parse_param_value(token, param);
+    return; // Nothing to attach array content to
   }
-  else if (token->type == JSON_TYPE_ARRAY_END) // Must catch this one to update the state in parse_param_value
+  else if (token->type == JSON_TYPE_ARRAY_END) // Must catch this one to decode a byte array in parse_param_value
   {
     parse_param_value(token, param);
   }
@@ -890,19 +1067,31 @@ static void json_walk_config_callback(void *callback_data, const char *name, siz
 
 NEPI_EDGE_RET_t NEPI_EDGE_LBImportConfig(NEPI_EDGE_LB_Config_t config, const char* filename)
 {
+  return NEPI_EDGE_LBImportConfigCtx(NEPI_EDGE_GetDefaultContext(), config, filename);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBImportConfigCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_Config_t config, const char* filename)
+{
+  VALIDATE_CONTEXT(context)
   VALIDATE_OPAQUE_TYPE(config, NEPI_EDGE_LB_MSG_ID_CONFIG, NEPI_EDGE_LB_Config)
 
   // First read the file into a string
   char filename_with_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-  snprintf(filename_with_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s/%s",
-           NEPI_EDGE_GetBotBaseFilePath(), NEPI_EDGE_LB_CONFIG_FOLDER_PATH, filename);
-  char *json_string = json_fread(filename_with_path);
-  if (NULL == json_string) return NEPI_EDGE_RET_INVALID_FILE_FORMAT;
-  //printf("%s\n", json_string); // Debugging
-  json_walk(json_string, strlen(json_string), json_walk_config_callback, p);
-  free(json_string); // Must free the frozen-malloc'd string
+  if (snprintf(filename_with_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s/%s",
+               ctx->bot_base_file_path, NEPI_EDGE_LB_CONFIG_FOLDER_PATH, filename) >= NEPI_EDGE_MAX_FILE_PATH_LENGTH)
+  {
+    return NEPI_EDGE_RET_ARG_TOO_LONG;
+  }
+  NEPI_EDGE_File_Map_t *map;
+  if (NEPI_EDGE_RET_OK != NEPI_EDGE_FileMapOpen(filename_with_path, &map)) return NEPI_EDGE_RET_INVALID_FILE_FORMAT;
+  //printf("%s\n", map->data); // Debugging
+  json_walk(map->data, map->length, json_walk_config_callback, p);
+  // Imported string params point into the map, so the config keeps it until destroyed
+  map->next = p->file_maps;
+  p->file_maps = map;
 
-  return NEPI_EDGE_RET_OK;
+  // Index covers everything imported so far, including any earlier import into this same config
+  return NEPI_EDGE_LBConfigIndexBuild(p);
 }
 
 static NEPI_EDGE_RET_t NEPI_EDGE_LBConfigCreateArray(struct NEPI_EDGE_LB_Config **config_array, size_t config_count)
@@ -912,75 +1101,121 @@ static NEPI_EDGE_RET_t NEPI_EDGE_LBConfigCreateArray(struct NEPI_EDGE_LB_Config
 
   for (size_t i = 0; i < config_count; ++i)
   {
-    struct NEPI_EDGE_LB_Config *p = *config_array + i;
-
-    p->opaque_helper.msg_id = NEPI_EDGE_LB_MSG_ID_CONFIG;
-    p->opaque_helper.fields_set = 0;
-    p->params = NULL;
+    init_config(*config_array + i);
   }
 
   return NEPI_EDGE_RET_OK;
 }
 
-static NEPI_EDGE_RET_t countJsonFilesInFolder(const char *path, size_t *count)
+static int compareFilenames(const void *a, const void *b)
+{
+  return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+static void freeFileList(char **filenames, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    NEPI_EDGE_FREE(filenames[i]);
+  }
+  NEPI_EDGE_FREE(filenames);
+}
+
+// Collect the names of the JSON files in a folder, sorted by name so that import order (and hence
+// config precedence) does not depend on the filesystem's directory ordering
+static NEPI_EDGE_RET_t listJsonFilesInFolder(const char *path, char ***filenames, size_t *count)
 {
   DIR *dir = opendir(path);
   if (dir == NULL) return NEPI_EDGE_RET_FILE_OPEN_ERR;
 
-  struct dirent *de;
+  *filenames = NULL;
   *count = 0;
-  while (de = readdir(dir))
+  size_t capacity = 0;
+
+  struct dirent *de;
+  while (NULL != (de = readdir(dir)))
   {
-    // Check that it is a JSON file and if so, count it
+    // Check that it is a JSON file and if so, add it
     const char *dot = strrchr(de->d_name, '.');
-    if ((dot != NULL) && (0 == strncmp(dot, ".json", 5)))
+    if ((dot == NULL) || (0 != strncmp(dot, ".json", 5))) continue;
+
+    if (*count == capacity)
+    {
+      capacity = (0 == capacity)? 8 : (2 * capacity);
+      char **new_filenames = NEPI_EDGE_REALLOC(*filenames, capacity * sizeof(char*));
+      if (NULL == new_filenames)
+      {
+        closedir(dir);
+        freeFileList(*filenames, *count);
+        return NEPI_EDGE_RET_MALLOC_ERR;
+      }
+      *filenames = new_filenames;
+    }
+
+    const size_t name_len = strlen(de->d_name);
+    char *name = NEPI_EDGE_MALLOC(name_len + 1);
+    if (NULL == name)
     {
-      ++(*count);
+      closedir(dir);
+      freeFileList(*filenames, *count);
+      return NEPI_EDGE_RET_MALLOC_ERR;
     }
+    memcpy(name, de->d_name, name_len + 1);
+    (*filenames)[(*count)++] = name;
   }
   closedir(dir);
+
+  if (*count > 1)
+  {
+    qsort(*filenames, *count, sizeof(char*), compareFilenames);
+  }
+  return NEPI_EDGE_RET_OK;
 }
 
 NEPI_EDGE_RET_t NEPI_EDGE_LBImportAllConfig(NEPI_EDGE_LB_General_t **config_array, size_t *config_count)
 {
+  return NEPI_EDGE_LBImportAllConfigCtx(NEPI_EDGE_GetDefaultContext(), config_array, config_count);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBImportAllConfigCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_Config_t **config_array, size_t *config_count)
+{
+  VALIDATE_CONTEXT(context)
+
   // Get the path to the Config DT folder
   char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-  snprintf(path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", NEPI_EDGE_GetBotBaseFilePath(), NEPI_EDGE_LB_CONFIG_FOLDER_PATH);
+  if (snprintf(path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", ctx->bot_base_file_path, NEPI_EDGE_LB_CONFIG_FOLDER_PATH) >=
+      NEPI_EDGE_MAX_FILE_PATH_LENGTH)
+  {
+    return NEPI_EDGE_RET_INVALID_BOT_PATH;
+  }
 
-  // Get the number of JSON files so that we can do the array allocation
+  // Get the JSON files so that we can do the array allocation
+  char **filenames;
   size_t config_file_count;
-  NEPI_EDGE_RET_t ret = countJsonFilesInFolder(path, &config_file_count);
+  NEPI_EDGE_RET_t ret = listJsonFilesInFolder(path, &filenames, &config_file_count);
   if (NEPI_EDGE_RET_OK != ret) return ret;
 
   ret = NEPI_EDGE_LBConfigCreateArray((struct NEPI_EDGE_LB_Config**)config_array, config_file_count);
-  if (ret != NEPI_EDGE_RET_OK) return ret;
+  if (ret != NEPI_EDGE_RET_OK)
+  {
+    freeFileList(filenames, config_file_count);
+    return ret;
+  }
 
   // Update the output count at this point so that if a failure occurs below this, the caller still knows
   // how much space to deallocate
   *config_count = config_file_count;
 
-  // Now open the directory stream, processing each JSON file in turn
-  DIR *dir = opendir(path);
-  if (dir == NULL) return NEPI_EDGE_RET_FILE_OPEN_ERR;
-
-  struct dirent *de;
-  size_t config_index = 0;
-  while (de = readdir(dir))
+  // Now process each JSON file in turn
+  for (size_t config_index = 0; config_index < config_file_count; ++config_index)
   {
-    // Check that it is a JSON file and if so, process it
-    const char *dot = strrchr(de->d_name, '.');
-    if ((dot != NULL) && (0 == strncmp(dot, ".json", 5)))
-    {
-      NEPI_EDGE_LB_Config_t config_entry = (struct NEPI_EDGE_LB_Config*)(*config_array) + config_index;
-      ret = NEPI_EDGE_LBImportConfig(config_entry, de->d_name);
-      if (ret != NEPI_EDGE_RET_OK) return ret;
-
-      ++config_index;
-    }
+    NEPI_EDGE_LB_Config_t config_entry = (struct NEPI_EDGE_LB_Config*)(*config_array) + config_index;
+    ret = NEPI_EDGE_LBImportConfigCtx(ctx, config_entry, filenames[config_index]);
+    if (ret != NEPI_EDGE_RET_OK) break;
   }
-  closedir(dir);
+  freeFileList(filenames, config_file_count);
 
-  return NEPI_EDGE_RET_OK;
+  return ret;
 }
 
 NEPI_EDGE_RET_t NEPI_EDGE_LBConfigGetArrayEntry(NEPI_EDGE_LB_Config_t *config_array, size_t index, NEPI_EDGE_LB_Config_t **config_entry)
@@ -995,13 +1230,7 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBConfigGetParamCount(NEPI_EDGE_LB_Config_t *config, s
 {
   VALIDATE_OPAQUE_TYPE(config, NEPI_EDGE_LB_MSG_ID_CONFIG, NEPI_EDGE_LB_Config)
 
-  *item_count = 0;
-  NEPI_EDGE_LB_Param_t *param = p->params;
-  while(param != NULL)
-  {
-    ++(*item_count);
-    param = param->next;
-  }
+  *item_count = p->param_count;
 
   return NEPI_EDGE_RET_OK;
 }
@@ -1013,17 +1242,9 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBConfigGetParam(NEPI_EDGE_LB_Config_t config, size_t
 
   VALIDATE_OPAQUE_TYPE(config, NEPI_EDGE_LB_MSG_ID_CONFIG, NEPI_EDGE_LB_Config)
 
-  // First, navigate through linked list to the correct param (item)
-  NEPI_EDGE_LB_Param_t *param = p->params;
-  size_t count = 0;
-  while(param != NULL)
-  {
-    if (count == item_index) break;
-    param = param->next;
-    ++count;
-  }
-  if (count != item_index) return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
+  if (item_index >= p->param_count) return NEPI_EDGE_RET_ARG_OUT_OF_RANGE;
 
+  const NEPI_EDGE_LB_Param_t *param = &(p->params[item_index]);
   *id_type = param->id_type;
   *id = param->id;
   *value_type = param->value_type;
@@ -1031,34 +1252,129 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBConfigGetParam(NEPI_EDGE_LB_Config_t config, size_t
   return NEPI_EDGE_RET_OK;
 }
 
-NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralCreate(NEPI_EDGE_LB_General_t *general)
+static NEPI_EDGE_RET_t find_config_param(NEPI_EDGE_LB_Config_t *config_array, size_t count,
+                                         NEPI_EDGE_LB_Param_Id_Type_t id_type, NEPI_EDGE_LB_Param_Id_t id,
+                                         NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value)
 {
-  *general = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_LB_General));
-  if (NULL == *general) return NEPI_EDGE_RET_MALLOC_ERR;
+  if ((NULL == value_type) || (NULL == value)) return NEPI_EDGE_RET_UNINIT_OBJ;
 
-  struct NEPI_EDGE_LB_General *p = (struct NEPI_EDGE_LB_General*)(*general);
-  p->opaque_helper.msg_id = NEPI_EDGE_LB_MSG_ID_GENERAL;
-  p->opaque_helper.fields_set = 0;
+  // Later entries take precedence, so search from the back
+  for (size_t i = count; i > 0; --i)
+  {
+    NEPI_EDGE_LB_Config_t config_entry = (struct NEPI_EDGE_LB_Config*)config_array + (i - 1);
+    VALIDATE_OPAQUE_TYPE(config_entry, NEPI_EDGE_LB_MSG_ID_CONFIG, NEPI_EDGE_LB_Config)
 
+    const NEPI_EDGE_LB_Param_t *param = NEPI_EDGE_LBConfigIndexFind(p, id_type, id);
+    if (NULL != param)
+    {
+      *value_type = param->value_type;
+      *value = param->value;
+      return NEPI_EDGE_RET_OK;
+    }
+  }
+  return NEPI_EDGE_RET_PARAM_NOT_FOUND;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigFindParamStr(NEPI_EDGE_LB_Config_t config, const char *id,
+                                               NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value)
+{
+  return NEPI_EDGE_LBConfigArrayFindParamStr(config, 1, id, value_type, value);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigFindParamInt(NEPI_EDGE_LB_Config_t config, uint32_t id,
+                                               NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value)
+{
+  return NEPI_EDGE_LBConfigArrayFindParamInt(config, 1, id, value_type, value);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigArrayFindParamStr(NEPI_EDGE_LB_Config_t *config_array, size_t count, const char *id,
+                                                    NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value)
+{
+  if (NULL == id) return NEPI_EDGE_RET_BAD_PARAM;
+
+  NEPI_EDGE_LB_Param_Id_t param_id;
+  param_id.id_string = (char*)id; // Only read
+  return find_config_param(config_array, count, NEPI_EDGE_LB_PARAM_ID_TYPE_STRING, param_id, value_type, value);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigArrayFindParamInt(NEPI_EDGE_LB_Config_t *config_array, size_t count, uint32_t id,
+                                                    NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value)
+{
+  NEPI_EDGE_LB_Param_Id_t param_id;
+  param_id.id_number = id;
+  return find_config_param(config_array, count, NEPI_EDGE_LB_PARAM_ID_TYPE_NUMBER, param_id, value_type, value);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigParamIterInit(NEPI_EDGE_LB_Config_t config, NEPI_EDGE_LB_Param_Iterator_t *iter)
+{
+  VALIDATE_OPAQUE_TYPE(config, NEPI_EDGE_LB_MSG_ID_CONFIG, NEPI_EDGE_LB_Config)
+  if (NULL == iter) return NEPI_EDGE_RET_UNINIT_OBJ;
+
+  iter->config = config;
+  iter->index = 0;
   return NEPI_EDGE_RET_OK;
 }
 
-NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralDestroy(NEPI_EDGE_LB_General_t general)
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigParamIterNext(NEPI_EDGE_LB_Param_Iterator_t *iter,
+                                                NEPI_EDGE_LB_Param_Id_Type_t *id_type, NEPI_EDGE_LB_Param_Id_t *id,
+                                                NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value)
 {
-  VALIDATE_OPAQUE_TYPE(general, NEPI_EDGE_LB_MSG_ID_GENERAL, NEPI_EDGE_LB_General)
+  if (NULL == iter) return NEPI_EDGE_RET_UNINIT_OBJ;
+
+  const NEPI_EDGE_RET_t ret = NEPI_EDGE_LBConfigGetParam(iter->config, iter->index, id_type, id, value_type, value);
+  if (NEPI_EDGE_RET_OK == ret) ++(iter->index);
+  return ret;
+}
 
+static void init_general(struct NEPI_EDGE_LB_General *p)
+{
+  p->opaque_helper.msg_id = NEPI_EDGE_LB_MSG_ID_GENERAL;
+  p->opaque_helper.fields_set = 0;
+  p->param.id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_UNKNOWN;
+  p->param.value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_UNKNOWN;
+  p->param.id_borrowed = 0;
+  p->param.value_borrowed = 0;
+  p->param.parsing_byte_array = 0;
+  p->file_maps = NULL;
+}
+
+static void free_general_param(struct NEPI_EDGE_LB_General *p)
+{
   // Depending on identifier and value type, might need to free some internal pointers that
   // are malloc'd when the fields are populated
-  if (p->param.id_type == NEPI_EDGE_LB_PARAM_ID_TYPE_STRING)
+  if ((p->param.id_type == NEPI_EDGE_LB_PARAM_ID_TYPE_STRING) && (0 == p->param.id_borrowed))
   {
     NEPI_EDGE_FREE(p->param.id.id_string);
   }
-  if (p->param.value_type == NEPI_EDGE_LB_PARAM_VALUE_TYPE_STRING ||
-      p->param.value_type == NEPI_EDGE_LB_PARAM_VALUE_TYPE_BYTES)
+  if (p->param.value_type == NEPI_EDGE_LB_PARAM_VALUE_TYPE_STRING)
+  {
+    if (0 == p->param.value_borrowed) NEPI_EDGE_FREE(p->param.value.string_val);
+  }
+  else if (p->param.value_type == NEPI_EDGE_LB_PARAM_VALUE_TYPE_BYTES)
   {
-    NEPI_EDGE_FREE(p->param.value.string_val);
+    NEPI_EDGE_FREE(p->param.value.bytes_val.val);
   }
 
+  NEPI_EDGE_FileMapCloseAll(p->file_maps);
+  p->file_maps = NULL;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralCreate(NEPI_EDGE_LB_General_t *general)
+{
+  *general = NEPI_EDGE_MALLOC(sizeof(struct NEPI_EDGE_LB_General));
+  if (NULL == *general) return NEPI_EDGE_RET_MALLOC_ERR;
+
+  init_general((struct NEPI_EDGE_LB_General*)(*general));
+
+  return NEPI_EDGE_RET_OK;
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralDestroy(NEPI_EDGE_LB_General_t general)
+{
+  VALIDATE_OPAQUE_TYPE(general, NEPI_EDGE_LB_MSG_ID_GENERAL, NEPI_EDGE_LB_General)
+
+  free_general_param(p);
+
   NEPI_EDGE_FREE(general);
   general = NULL;
 
@@ -1073,15 +1389,7 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralDestroyArray(NEPI_EDGE_LB_General_t *general_
     NEPI_EDGE_LB_General_t general_entry = (struct NEPI_EDGE_LB_General*)general_array + i;
     VALIDATE_OPAQUE_TYPE(general_entry, NEPI_EDGE_LB_MSG_ID_GENERAL, NEPI_EDGE_LB_General)
 
-    if (p->param.id_type == NEPI_EDGE_LB_PARAM_ID_TYPE_STRING)
-    {
-      NEPI_EDGE_FREE(p->param.id.id_string);
-    }
-    if (p->param.value_type == NEPI_EDGE_LB_PARAM_VALUE_TYPE_STRING ||
-        p->param.value_type == NEPI_EDGE_LB_PARAM_VALUE_TYPE_BYTES)
-    {
-      NEPI_EDGE_FREE(p->param.value.string_val);
-    }
+    free_general_param(p);
   }
 
   // Now free the type_array
@@ -1096,6 +1404,7 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralSetPayloadStrBool(NEPI_EDGE_LB_General_t gene
 
   p->param.id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_STRING;
   p->param.id.id_string = NEPI_EDGE_MALLOC(strlen(id) + 1);
+  p->param.id_borrowed = 0;
   strcpy(p->param.id.id_string,id);
   p->param.value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_BOOL;
   p->param.value.bool_val = (val == 0)? 0 : 1;
@@ -1110,6 +1419,7 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralSetPayloadStrInt64(NEPI_EDGE_LB_General_t gen
 
   p->param.id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_STRING;
   p->param.id.id_string = NEPI_EDGE_MALLOC(strlen(id) + 1);
+  p->param.id_borrowed = 0;
   strcpy(p->param.id.id_string,id);
   p->param.value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_INT64;
   p->param.value.int64_val = val;
@@ -1124,6 +1434,7 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralSetPayloadStrUInt64(NEPI_EDGE_LB_General_t ge
 
   p->param.id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_STRING;
   p->param.id.id_string = NEPI_EDGE_MALLOC(strlen(id) + 1);
+  p->param.id_borrowed = 0;
   strcpy(p->param.id.id_string,id);
   p->param.value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_UINT64;
   p->param.value.uint64_val = val;
@@ -1138,6 +1449,7 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralSetPayloadStrFloat(NEPI_EDGE_LB_General_t gen
 
   p->param.id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_STRING;
   p->param.id.id_string = NEPI_EDGE_MALLOC(strlen(id) + 1);
+  p->param.id_borrowed = 0;
   strcpy(p->param.id.id_string,id);
   p->param.value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_FLOAT;
   p->param.value.float_val = val;
@@ -1152,6 +1464,7 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralSetPayloadStrDouble(NEPI_EDGE_LB_General_t ge
 
   p->param.id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_STRING;
   p->param.id.id_string = NEPI_EDGE_MALLOC(strlen(id) + 1);
+  p->param.id_borrowed = 0;
   strcpy(p->param.id.id_string,id);
   p->param.value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_DOUBLE;
   p->param.value.double_val = val;
@@ -1166,9 +1479,11 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralSetPayloadStrStr(NEPI_EDGE_LB_General_t gener
 
   p->param.id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_STRING;
   p->param.id.id_string = NEPI_EDGE_MALLOC(strlen(id) + 1);
+  p->param.id_borrowed = 0;
   strcpy(p->param.id.id_string,id);
   p->param.value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_STRING;
   p->param.value.string_val = NEPI_EDGE_MALLOC(strlen(val) + 1);
+  p->param.value_borrowed = 0;
   strcpy(p->param.value.string_val, val);
   p->opaque_helper.fields_set |= NEPI_EDGE_LB_General_Fields_Payload;
 
@@ -1181,6 +1496,7 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralSetPayloadStrBytes(NEPI_EDGE_LB_General_t gen
 
   p->param.id_type = NEPI_EDGE_LB_PARAM_ID_TYPE_STRING;
   p->param.id.id_string = NEPI_EDGE_MALLOC(strlen(id) + 1);
+  p->param.id_borrowed = 0;
   strcpy(p->param.id.id_string,id);
   p->param.value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_BYTES;
   p->param.value.bytes_val.val = NEPI_EDGE_MALLOC(length);
@@ -1264,6 +1580,7 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralSetPayloadIntStr(NEPI_EDGE_LB_General_t gener
   p->param.id.id_number = id;
   p->param.value_type = NEPI_EDGE_LB_PARAM_VALUE_TYPE_STRING;
   p->param.value.string_val = NEPI_EDGE_MALLOC(strlen(val) + 1);
+  p->param.value_borrowed = 0;
   strcpy(p->param.value.string_val, val);
   p->opaque_helper.fields_set |= NEPI_EDGE_LB_General_Fields_Payload;
 
@@ -1287,55 +1604,61 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralSetPayloadIntBytes(NEPI_EDGE_LB_General_t gen
 
 NEPI_EDGE_RET_t NEPI_EDGE_LBExportGeneral(NEPI_EDGE_LB_General_t general)
 {
-  static uint32_t general_do_file_count = 0;
+  return NEPI_EDGE_LBExportGeneralCtx(NEPI_EDGE_GetDefaultContext(), general);
+}
 
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportGeneralCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_General_t general)
+{
+  VALIDATE_CONTEXT(context)
   VALIDATE_OPAQUE_TYPE(general, NEPI_EDGE_LB_MSG_ID_GENERAL, NEPI_EDGE_LB_General)
 
-  char path_qualified_filename[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-  snprintf(path_qualified_filename, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s/general_do_%u.json",
-           NEPI_EDGE_GetBotBaseFilePath(), NEPI_EDGE_LB_GENERAL_DO_FOLDER_PATH, general_do_file_count);
-
-  FILE *general_do_file = fopen(path_qualified_filename, "w");
-  if (NULL == general_do_file) return NEPI_EDGE_RET_FILE_OPEN_ERR;
-
   ENSURE_FIELD_PRESENT(p, NEPI_EDGE_LB_General_Fields_Payload)
 
-  fprintf(general_do_file, "{\n");
-  writeParamToJsonFile(general_do_file, &(p->param));
-  fprintf(general_do_file, "\n}");
+  NEPI_EDGE_Out_Buf_t buf;
+  NEPI_EDGE_OutBufInit(&buf);
+  NEPI_EDGE_OutBufAppendStr(&buf, "{\n");
+  writeParamToJsonBuf(&buf, &(p->param), atomic_load_explicit(&(ctx->bytes_encoding), memory_order_relaxed));
+  NEPI_EDGE_OutBufAppendStr(&buf, "\n}");
 
-  fclose(general_do_file);
+  // Claim the file number up front so that concurrent exports never share a name. A failed export leaves a gap.
+  const unsigned int file_number = atomic_fetch_add(&(ctx->general_do_file_count), 1);
 
-  ++general_do_file_count; // Always increment to ensure files have unique names
-  return NEPI_EDGE_RET_OK;
+  char path_qualified_filename[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  NEPI_EDGE_RET_t ret = NEPI_EDGE_RET_INVALID_BOT_PATH;
+  if (snprintf(path_qualified_filename, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s/general_do_%u.json",
+               ctx->bot_base_file_path, NEPI_EDGE_LB_GENERAL_DO_FOLDER_PATH, file_number) < NEPI_EDGE_MAX_FILE_PATH_LENGTH)
+  {
+    ret = NEPI_EDGE_OutBufWriteFile(&buf, path_qualified_filename, 0);
+  }
+  NEPI_EDGE_OutBufFree(&buf);
+  return ret;
 }
 
 static void json_walk_general_callback(void *callback_data, const char *name, size_t name_len, const char *path, const struct json_token *token)
 {
+  (void)path; // Keys are matched by name alone
   if (token->type == JSON_TYPE_OBJECT_START || token->type == JSON_TYPE_OBJECT_END) return;
 
   struct NEPI_EDGE_LB_General *p = (struct NEPI_EDGE_LB_General*)callback_data;
 
-  char tmp_name[1024];
-  size_t tmp_len = (name_len < 1024)? name_len : 1024;
-  strncpy(tmp_name, name, tmp_len);
-  tmp_name[tmp_len] = '\0';
+  const NEPI_EDGE_Json_Key_t key = NEPI_EDGE_JsonKeyLookup(name, name_len);
 
-  if (0 == strcmp(tmp_name, "identifier"))
+  if (NEPI_EDGE_JSON_KEY_IDENTIFIER == key)
   {
     parse_param_identifier(token, &(p->param));
     p->opaque_helper.fields_set |= NEPI_EDGE_LB_Config_Fields_Params; // No harm in setting this every time
   }
-  else if (0 == strcmp(tmp_name, "value"))
+  else if (NEPI_EDGE_JSON_KEY_VALUE == key)
   {
     parse_param_value(token, &(p->param));
     p->opaque_helper.fields_set |= NEPI_EDGE_LB_Config_Fields_Params; // No harm in setting this every time
   }
-  else if ((token->type == JSON_TYPE_NUMBER) && (path[strlen(path) - 1] == ']')) // Inside a byte array
+  else if (NEPI_EDGE_JSON_KEY_B64 == key)
   {
-    parse_param_value(token, &(p->param));
+    parse_param_base64(token, &(p->param));
+    p->opaque_helper.fields_set |= NEPI_EDGE_LB_Config_Fields_Params; // No harm in setting this every time
   }
-  else if (token->type == JSON_TYPE_ARRAY_END) // Must catch this one to update the state in parse_param_value
+  else if (token->type == JSON_TYPE_ARRAY_END) // Must catch this one to decode a byte array in parse_param_value
   {
     parse_param_value(token, &(p->param));
   }
@@ -1343,17 +1666,28 @@ static void json_walk_general_callback(void *callback_data, const char *name, si
 
 NEPI_EDGE_RET_t NEPI_EDGE_LBImportGeneral(NEPI_EDGE_LB_General_t general, const char* filename)
 {
+  return NEPI_EDGE_LBImportGeneralCtx(NEPI_EDGE_GetDefaultContext(), general, filename);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBImportGeneralCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_General_t general, const char* filename)
+{
+  VALIDATE_CONTEXT(context)
   VALIDATE_OPAQUE_TYPE(general, NEPI_EDGE_LB_MSG_ID_GENERAL, NEPI_EDGE_LB_General)
 
   // First read the file into a string
   char filename_with_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-  snprintf(filename_with_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s/%s",
-           NEPI_EDGE_GetBotBaseFilePath(), NEPI_EDGE_LB_GENERAL_DT_FOLDER_PATH, filename);
-  char *json_string = json_fread(filename_with_path);
-  if (NULL == json_string) return NEPI_EDGE_RET_INVALID_FILE_FORMAT;
-  //printf("%s\n", json_string); // Debugging
-  json_walk(json_string, strlen(json_string), json_walk_general_callback, p);
-  free(json_string); // Must free the frozen-malloc'd string
+  if (snprintf(filename_with_path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s/%s",
+               ctx->bot_base_file_path, NEPI_EDGE_LB_GENERAL_DT_FOLDER_PATH, filename) >= NEPI_EDGE_MAX_FILE_PATH_LENGTH)
+  {
+    return NEPI_EDGE_RET_ARG_TOO_LONG;
+  }
+  NEPI_EDGE_File_Map_t *map;
+  if (NEPI_EDGE_RET_OK != NEPI_EDGE_FileMapOpen(filename_with_path, &map)) return NEPI_EDGE_RET_INVALID_FILE_FORMAT;
+  //printf("%s\n", map->data); // Debugging
+  json_walk(map->data, map->length, json_walk_general_callback, p);
+  // Imported string params point into the map, so the general keeps it until destroyed
+  map->next = p->file_maps;
+  p->file_maps = map;
 
   return NEPI_EDGE_RET_OK;
 }
@@ -1365,9 +1699,7 @@ static NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralCreateArray(struct NEPI_EDGE_LB_Genera
 
   for (size_t i = 0; i < general_count; ++i)
   {
-    struct NEPI_EDGE_LB_General *p = *general_array + i;
-    p->opaque_helper.msg_id = NEPI_EDGE_LB_MSG_ID_GENERAL;
-    p->opaque_helper.fields_set = 0;
+    init_general(*general_array + i);
   }
 
   return NEPI_EDGE_RET_OK;
@@ -1375,46 +1707,48 @@ static NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralCreateArray(struct NEPI_EDGE_LB_Genera
 
 NEPI_EDGE_RET_t NEPI_EDGE_LBImportAllGeneral(NEPI_EDGE_LB_General_t **general_array, size_t *general_count)
 {
+  return NEPI_EDGE_LBImportAllGeneralCtx(NEPI_EDGE_GetDefaultContext(), general_array, general_count);
+}
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBImportAllGeneralCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_General_t **general_array, size_t *general_count)
+{
+  VALIDATE_CONTEXT(context)
+
   // Get the path to the General DT folder
   char path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
-  snprintf(path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", NEPI_EDGE_GetBotBaseFilePath(), NEPI_EDGE_LB_GENERAL_DT_FOLDER_PATH);
+  if (snprintf(path, NEPI_EDGE_MAX_FILE_PATH_LENGTH, "%s/%s", ctx->bot_base_file_path, NEPI_EDGE_LB_GENERAL_DT_FOLDER_PATH) >=
+      NEPI_EDGE_MAX_FILE_PATH_LENGTH)
+  {
+    return NEPI_EDGE_RET_INVALID_BOT_PATH;
+  }
 
-  // Now walk that directory to count the number of files so that we can do the array allocation
+  // Now list that directory so that we can do the array allocation
+  char **filenames;
   size_t general_file_count;
-  NEPI_EDGE_RET_t ret = countJsonFilesInFolder(path, &general_file_count);
+  NEPI_EDGE_RET_t ret = listJsonFilesInFolder(path, &filenames, &general_file_count);
   if (NEPI_EDGE_RET_OK != ret) return ret;
 
   ret = NEPI_EDGE_LBGeneralCreateArray((struct NEPI_EDGE_LB_General**)general_array, general_file_count);
-  if (ret != NEPI_EDGE_RET_OK) return ret;
+  if (ret != NEPI_EDGE_RET_OK)
+  {
+    freeFileList(filenames, general_file_count);
+    return ret;
+  }
 
   // Update the output count at this point so that if a failure occurs below this, the caller still knows
   // how much space to deallocate
   *general_count = general_file_count;
 
-  // Now open the directory stream, processing each JSON file in turn
-  DIR *dir = opendir(path);
-  if (dir == NULL) return NEPI_EDGE_RET_FILE_OPEN_ERR;
-
-  struct dirent *de;
-  size_t general_index = 0;
-  while (de = readdir(dir))
+  // Now process each JSON file in turn
+  for (size_t general_index = 0; general_index < general_file_count; ++general_index)
   {
-    // Check that it is a JSON file and if so, process it
-    const char *dot = strrchr(de->d_name, '.');
-    if ((dot != NULL) && (0 == strncmp(dot, ".json", 5)))
-    {
-      NEPI_EDGE_LB_General_t general_entry = (struct NEPI_EDGE_LB_General*)(*general_array) + general_index;
-      ret = NEPI_EDGE_LBImportGeneral(general_entry, de->d_name);
-      if (ret != NEPI_EDGE_RET_OK)
-      {
-        return ret;
-      }
-      ++general_index;
-    }
+    NEPI_EDGE_LB_General_t general_entry = (struct NEPI_EDGE_LB_General*)(*general_array) + general_index;
+    ret = NEPI_EDGE_LBImportGeneralCtx(ctx, general_entry, filenames[general_index]);
+    if (ret != NEPI_EDGE_RET_OK) break;
   }
-  closedir(dir);
+  freeFileList(filenames, general_file_count);
 
-  return NEPI_EDGE_RET_OK;
+  return ret;
 }
 
 NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralGetArrayEntry(NEPI_EDGE_LB_General_t *general_array, size_t index, NEPI_EDGE_LB_General_t **general_entry)
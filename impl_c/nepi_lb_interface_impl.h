@@ -14,6 +14,7 @@
 
 #include "nepi_edge_lb_consts.h"
 #include "nepi_edge_sdk_link.h"
+#include "nepi_edge_file_map_impl.h"
 
 typedef enum NEPI_EDGE_LB_MSG_ID
 {
@@ -32,7 +33,9 @@ typedef struct NEPI_EDGE_LB_Opaque_Helper
 struct NEPI_EDGE_LB_Status
 {
   char timestamp_rfc3339[NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH]; // Obtained e.g., via date --rtc3339=ns
-  char navsat_fix_time_rfc3339[NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH];
+  // Timestamps are parsed once when set; exports only ever subtract these
+  int64_t timestamp_ns; // Since the Unix epoch, UTC
+  int64_t navsat_fix_time_ns;
   float latitude_deg;
   float longitude_deg;
   float heading_deg;
@@ -65,7 +68,7 @@ struct NEPI_EDGE_LB_Data_Snippet
 {
   char type[NEPI_EDGE_DATA_SNIPPET_TYPE_LENGTH];
   uint32_t instance;
-  char data_time_rfc3339[NEPI_EDGE_MAX_TSTAMP_STRING_LENGTH];
+  int64_t data_time_ns; // Since the Unix epoch, UTC
   float latitude_deg;
   float longitude_deg;
   float heading_deg;
@@ -101,7 +104,9 @@ typedef struct NEPI_EDGE_LB_Param
   NEPI_EDGE_LB_Param_Value_Type_t value_type;
   NEPI_EDGE_LB_Param_Value_t value;
 
-  struct NEPI_EDGE_LB_Param *next; // Linked list pointer for use in the CONFIG struct
+  uint8_t id_borrowed; // String id points into the owning object's file_maps rather than the heap
+  uint8_t value_borrowed; // Likewise for a string value
+  uint8_t parsing_byte_array; // Import state: between the value's ARRAY_START and ARRAY_END
 } NEPI_EDGE_LB_Param_t;
 
 typedef enum NEPI_EDGE_LB_Config_Fields_Bitmask
@@ -111,11 +116,22 @@ typedef enum NEPI_EDGE_LB_Config_Fields_Bitmask
 
 struct NEPI_EDGE_LB_Config
 {
-  NEPI_EDGE_LB_Param_t *params; // Linked list
+  NEPI_EDGE_LB_Param_t *params; // Contiguous; the entry being parsed is always the last one
+  size_t param_count;
+  size_t param_capacity;
+  size_t *id_index; // Hash index over param identifiers; see nepi_lb_config_index_impl.c
+  size_t id_index_capacity;
+  NEPI_EDGE_File_Map_t *file_maps; // One per import, kept for the config's lifetime
 
   NEPI_EDGE_LB_Opaque_Helper_t opaque_helper;
 };
 
+// Identifier index, rebuilt after each import. Later duplicates of an identifier shadow earlier ones.
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigIndexBuild(struct NEPI_EDGE_LB_Config *p);
+void NEPI_EDGE_LBConfigIndexFree(struct NEPI_EDGE_LB_Config *p);
+const NEPI_EDGE_LB_Param_t* NEPI_EDGE_LBConfigIndexFind(const struct NEPI_EDGE_LB_Config *p,
+                                                        NEPI_EDGE_LB_Param_Id_Type_t id_type, NEPI_EDGE_LB_Param_Id_t id);
+
 typedef enum NEPI_EDGE_LB_General_Fields_Bitmask
 {
   NEPI_EDGE_LB_General_Fields_Payload = (1u << 0),
@@ -124,6 +140,7 @@ typedef enum NEPI_EDGE_LB_General_Fields_Bitmask
 struct NEPI_EDGE_LB_General
 {
   NEPI_EDGE_LB_Param_t param;
+  NEPI_EDGE_File_Map_t *file_maps;
 
   NEPI_EDGE_LB_Opaque_Helper_t opaque_helper;
 };
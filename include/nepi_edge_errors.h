@@ -33,6 +33,13 @@ typedef enum NEPI_EDGE_RET
   NEPI_EDGE_RET_CANT_START_BOT = -19,
   NEPI_EDGE_RET_BOT_EXEC_UNDETERMINED = -20,
   NEPI_EDGE_RET_CANT_KILL_BOT = -21,
+  NEPI_EDGE_RET_FILE_WRITE_ERROR = -22,
+  NEPI_EDGE_RET_WOULD_BLOCK = -23,
+  NEPI_EDGE_RET_ASYNC_EXPORT_NOT_RUNNING = -24,
+  NEPI_EDGE_RET_ASYNC_EXPORT_ALREADY_RUNNING = -25,
+  NEPI_EDGE_RET_CANT_START_THREAD = -26,
+  NEPI_EDGE_RET_PARAM_NOT_FOUND = -27,
+  NEPI_EDGE_RET_TIMED_OUT = -28,
 } NEPI_EDGE_RET_t;
 
 #endif //__NEPI_EDGE_ERRORS_H
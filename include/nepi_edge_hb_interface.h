@@ -10,8 +10,11 @@
 #define __NEPI_EDGE_HB_INTERFACE_H
 
 #include "nepi_edge_errors.h"
+#include "nepi_edge_sdk_link.h"
 
 NEPI_EDGE_RET_t NEPI_EDGE_HBLinkDataFolder(const char* data_folder_path);
+NEPI_EDGE_RET_t NEPI_EDGE_HBLinkDataFolderCtx(NEPI_EDGE_Context_t context, const char* data_folder_path);
 NEPI_EDGE_RET_t NEPI_EDGE_HBUnlinkDataFolder(void);
+NEPI_EDGE_RET_t NEPI_EDGE_HBUnlinkDataFolderCtx(NEPI_EDGE_Context_t context);
 
 #endif
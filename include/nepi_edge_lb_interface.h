@@ -14,6 +14,7 @@
 
 #include "nepi_edge_lb_consts.h"
 #include "nepi_edge_errors.h"
+#include "nepi_edge_sdk_link.h"
 
 /* **************** Config/General Retreival Types and Support API **************** */
 typedef enum NEPI_EDGE_LB_Param_Id_Type
@@ -60,10 +61,14 @@ typedef union NEPI_EDGE_LB_Param_Value
 
 /* **************** Status and Data Message API **************** */
 typedef void* NEPI_EDGE_LB_Status_t;
+// Timestamps are RFC3339 strings, e.g., 2020-08-21 09:50:25.431396857-04:00; malformed strings return NEPI_EDGE_RET_BAD_PARAM.
+// The *Ns variants take nanoseconds since the Unix epoch (e.g., from clock_gettime(CLOCK_REALTIME)) and skip string handling.
 NEPI_EDGE_RET_t NEPI_EDGE_LBStatusCreate(NEPI_EDGE_LB_Status_t *status, const char* timestamp_rfc3339);
+NEPI_EDGE_RET_t NEPI_EDGE_LBStatusCreateNs(NEPI_EDGE_LB_Status_t *status, int64_t timestamp_ns);
 NEPI_EDGE_RET_t NEPI_EDGE_LBStatusDestroy(NEPI_EDGE_LB_Status_t status);
 
 NEPI_EDGE_RET_t NEPI_EDGE_LBStatusSetNavSatFixTime(NEPI_EDGE_LB_Status_t status, const char* timestamp_rfc3339);
+NEPI_EDGE_RET_t NEPI_EDGE_LBStatusSetNavSatFixTimeNs(NEPI_EDGE_LB_Status_t status, int64_t timestamp_ns);
 NEPI_EDGE_RET_t NEPI_EDGE_LBStatusSetLatitude(NEPI_EDGE_LB_Status_t status, float latitude_deg);
 NEPI_EDGE_RET_t NEPI_EDGE_LBStatusSetLongitude(NEPI_EDGE_LB_Status_t status, float longitude_deg);
 NEPI_EDGE_RET_t NEPI_EDGE_LBStatusSetHeading(NEPI_EDGE_LB_Status_t status, NEPI_EDGE_Heading_Ref_t heading_ref, float heading_deg);
@@ -78,6 +83,7 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBDataSnippetCreate(NEPI_EDGE_LB_Data_Snippet_t *snipp
 NEPI_EDGE_RET_t NEPI_EDGE_LBDataSnippetDestroy(NEPI_EDGE_LB_Data_Snippet_t snippet);
 
 NEPI_EDGE_RET_t NEPI_EDGE_LBDataSnippetSetDataTimestamp(NEPI_EDGE_LB_Data_Snippet_t snippet, const char* timestamp_rfc3339);
+NEPI_EDGE_RET_t NEPI_EDGE_LBDataSnippetSetDataTimestampNs(NEPI_EDGE_LB_Data_Snippet_t snippet, int64_t timestamp_ns);
 NEPI_EDGE_RET_t NEPI_EDGE_LBDataSnippetSetLatitude(NEPI_EDGE_LB_Data_Snippet_t snippet, float latitude_deg);
 NEPI_EDGE_RET_t NEPI_EDGE_LBDataSnippetSetLongitude(NEPI_EDGE_LB_Data_Snippet_t snippet, float longitude_deg);
 NEPI_EDGE_RET_t NEPI_EDGE_LBDataSnippetSetHeading(NEPI_EDGE_LB_Data_Snippet_t snippet, float heading_deg);
@@ -87,6 +93,71 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBDataSnippetSetScores(NEPI_EDGE_LB_Data_Snippet_t sni
 NEPI_EDGE_RET_t NEPI_EDGE_LBDataSnippetSetDataFile(NEPI_EDGE_LB_Data_Snippet_t snippet, const char *data_file_with_path, uint8_t delete_on_export);
 
 NEPI_EDGE_RET_t NEPI_EDGE_LBExportData(const NEPI_EDGE_LB_Status_t status, const NEPI_EDGE_LB_Data_Snippet_t *snippets, size_t snippet_count);
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportDataCtx(NEPI_EDGE_Context_t context, const NEPI_EDGE_LB_Status_t status,
+                                          const NEPI_EDGE_LB_Data_Snippet_t *snippets, size_t snippet_count);
+
+// Export several status/snippet groups (e.g., a few seconds of buffered detections) in one pass. Groups are
+// exported in order; if one fails, the groups before it are still published and its error is returned. A group that is
+// written out but then can't be published is dropped without holding back the others.
+typedef struct NEPI_EDGE_LB_Export_Group
+{
+  NEPI_EDGE_LB_Status_t status;
+  const NEPI_EDGE_LB_Data_Snippet_t *snippets;
+  size_t snippet_count;
+} NEPI_EDGE_LB_Export_Group_t;
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportDataBatch(const NEPI_EDGE_LB_Export_Group_t *groups, size_t group_count);
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportDataBatchCtx(NEPI_EDGE_Context_t context, const NEPI_EDGE_LB_Export_Group_t *groups, size_t group_count);
+
+/* **************** Export Durability API **************** */
+// Each export is written into a hidden staging folder and published into lb/data with a single rename(),
+// so the bot never observes a partially-written export. The sync policy controls crash durability:
+//   NONE         - No explicit flushing (default)
+//   PER_EXPORT   - Every file and folder is fsync'd before the export call returns
+//   GROUP_COMMIT - Staged exports are flushed together and published at most every commit_interval_ms;
+//                  a background thread publishes them once the interval has passed, or sooner on
+//                  NEPI_EDGE_LBCommitExports/NEPI_EDGE_StartBot
+typedef enum NEPI_EDGE_Export_Sync_Policy
+{
+  NEPI_EDGE_EXPORT_SYNC_NONE,
+  NEPI_EDGE_EXPORT_SYNC_PER_EXPORT,
+  NEPI_EDGE_EXPORT_SYNC_GROUP_COMMIT
+} NEPI_EDGE_Export_Sync_Policy_t;
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBSetExportSyncPolicy(NEPI_EDGE_Export_Sync_Policy_t policy, uint32_t commit_interval_ms);
+NEPI_EDGE_RET_t NEPI_EDGE_LBSetExportSyncPolicyCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Export_Sync_Policy_t policy,
+                                                   uint32_t commit_interval_ms);
+// Flush and publish any exports still held by the group-commit policy. If this succeeds, the first background
+// flush failure since the previous call is returned instead.
+NEPI_EDGE_RET_t NEPI_EDGE_LBCommitExports(void);
+NEPI_EDGE_RET_t NEPI_EDGE_LBCommitExportsCtx(NEPI_EDGE_Context_t context);
+
+/* **************** Asynchronous Export API **************** */
+// Opt-in background writer. The *Async export calls validate their arguments, hand them to a bounded queue,
+// and return immediately; a writer thread performs the export and then destroys the objects. On
+// NEPI_EDGE_RET_OK, ownership of the status, every snippet, and the general object passes to the SDK and the
+// caller must not touch or destroy them again. On any error the caller keeps ownership.
+// Stop may race with the *Async export calls: those that lose, including any blocked waiting for a slot, return
+// NEPI_EDGE_RET_ASYNC_EXPORT_NOT_RUNNING. There is one writer for the whole process; each queued export remembers
+// its context, which must stay alive until the export has been flushed.
+typedef enum NEPI_EDGE_Async_Full_Policy
+{
+  NEPI_EDGE_ASYNC_FULL_WOULD_BLOCK, // Return NEPI_EDGE_RET_WOULD_BLOCK immediately
+  NEPI_EDGE_ASYNC_FULL_WAIT         // Block until the writer frees a slot
+} NEPI_EDGE_Async_Full_Policy_t;
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBStartAsyncExport(size_t queue_depth);
+// Drains everything already queued, then stops the writer. Returns the first writer error since the last flush.
+NEPI_EDGE_RET_t NEPI_EDGE_LBStopAsyncExport(void);
+// Wait until everything queued before this call has been written, e.g., before NEPI_EDGE_StartBot.
+// Returns (and clears) the first error the writer encountered since the last flush. A stop requested meanwhile waits
+// for the flush to finish.
+NEPI_EDGE_RET_t NEPI_EDGE_LBFlushAsyncExport(void);
+
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportDataAsync(NEPI_EDGE_LB_Status_t status, const NEPI_EDGE_LB_Data_Snippet_t *snippets, size_t snippet_count,
+                                            NEPI_EDGE_Async_Full_Policy_t full_policy);
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportDataAsyncCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_Status_t status,
+                                               const NEPI_EDGE_LB_Data_Snippet_t *snippets, size_t snippet_count,
+                                               NEPI_EDGE_Async_Full_Policy_t full_policy);
 
 /* **************** Config Message API **************** */
 typedef void* NEPI_EDGE_LB_Config_t;
@@ -95,13 +166,40 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBConfigDestroy(NEPI_EDGE_LB_Config_t config);
 NEPI_EDGE_RET_t NEPI_EDGE_LBConfigDestroyArray(NEPI_EDGE_LB_Config_t *config_array, size_t count);
 
 NEPI_EDGE_RET_t NEPI_EDGE_LBImportConfig(NEPI_EDGE_LB_Config_t config, const char* filename);
+NEPI_EDGE_RET_t NEPI_EDGE_LBImportConfigCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_Config_t config, const char* filename);
 NEPI_EDGE_RET_t NEPI_EDGE_LBImportAllConfig(NEPI_EDGE_LB_Config_t **config_array, size_t *count);
+NEPI_EDGE_RET_t NEPI_EDGE_LBImportAllConfigCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_Config_t **config_array, size_t *count);
 NEPI_EDGE_RET_t NEPI_EDGE_LBConfigGetArrayEntry(NEPI_EDGE_LB_Config_t *config_array, size_t index, NEPI_EDGE_LB_Config_t **config_entry);
 NEPI_EDGE_RET_t NEPI_EDGE_LBConfigGetParamCount(NEPI_EDGE_LB_Config_t *config, size_t *item_count);
 NEPI_EDGE_RET_t NEPI_EDGE_LBConfigGetParam(NEPI_EDGE_LB_Config_t config, size_t param_index,
                                            NEPI_EDGE_LB_Param_Id_Type_t *id_type, NEPI_EDGE_LB_Param_Id_t *id,
                                            NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value);
 
+// Lookup by identifier through a hash index built at import. If an identifier occurs more than once in a config,
+// the last occurrence wins. Returns NEPI_EDGE_RET_PARAM_NOT_FOUND if there is no such param.
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigFindParamStr(NEPI_EDGE_LB_Config_t config, const char *id,
+                                               NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value);
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigFindParamInt(NEPI_EDGE_LB_Config_t config, uint32_t id,
+                                               NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value);
+// As above, but merged across an array from NEPI_EDGE_LBImportAllConfig. That call imports config files in filename
+// (strcmp) order, and files later in that order take precedence, e.g., 10_site.json overrides 00_defaults.json.
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigArrayFindParamStr(NEPI_EDGE_LB_Config_t *config_array, size_t count, const char *id,
+                                                    NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value);
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigArrayFindParamInt(NEPI_EDGE_LB_Config_t *config_array, size_t count, uint32_t id,
+                                                    NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value);
+
+// Sequential access to every param of a config; Next returns NEPI_EDGE_RET_ARG_OUT_OF_RANGE once all have been visited.
+// Returned ids and values are owned by the config and remain valid until it is destroyed.
+typedef struct NEPI_EDGE_LB_Param_Iterator
+{
+  NEPI_EDGE_LB_Config_t config; // Set by NEPI_EDGE_LBConfigParamIterInit
+  size_t index;
+} NEPI_EDGE_LB_Param_Iterator_t;
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigParamIterInit(NEPI_EDGE_LB_Config_t config, NEPI_EDGE_LB_Param_Iterator_t *iter);
+NEPI_EDGE_RET_t NEPI_EDGE_LBConfigParamIterNext(NEPI_EDGE_LB_Param_Iterator_t *iter,
+                                                NEPI_EDGE_LB_Param_Id_Type_t *id_type, NEPI_EDGE_LB_Param_Id_t *id,
+                                                NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value);
+
 /* **************** General Message API **************** */
 typedef void* NEPI_EDGE_LB_General_t;
 NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralCreate(NEPI_EDGE_LB_General_t *general);
@@ -123,10 +221,28 @@ NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralSetPayloadIntDouble(NEPI_EDGE_LB_General_t ge
 NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralSetPayloadIntStr(NEPI_EDGE_LB_General_t general, uint32_t id, const char *val);
 NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralSetPayloadIntBytes(NEPI_EDGE_LB_General_t general, uint32_t id, const uint8_t *val, const size_t length);
 
+// Representation of byte-array payloads in exported General messages. Import accepts either form regardless.
+//   DECIMAL - "value":[222,173,190,239] (default, understood by every bot version)
+//   BASE64  - "value":{"b64":"3q2+7w=="} -- about a third the size; only select it if the bot accepts it
+typedef enum NEPI_EDGE_LB_Bytes_Encoding
+{
+  NEPI_EDGE_LB_BYTES_ENCODING_DECIMAL,
+  NEPI_EDGE_LB_BYTES_ENCODING_BASE64
+} NEPI_EDGE_LB_Bytes_Encoding_t;
+NEPI_EDGE_RET_t NEPI_EDGE_LBSetBytesEncoding(NEPI_EDGE_LB_Bytes_Encoding_t encoding);
+NEPI_EDGE_RET_t NEPI_EDGE_LBSetBytesEncodingCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_Bytes_Encoding_t encoding);
+
 NEPI_EDGE_RET_t NEPI_EDGE_LBExportGeneral(NEPI_EDGE_LB_General_t general);
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportGeneralCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_General_t general);
+// See the Asynchronous Export API above
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportGeneralAsync(NEPI_EDGE_LB_General_t general, NEPI_EDGE_Async_Full_Policy_t full_policy);
+NEPI_EDGE_RET_t NEPI_EDGE_LBExportGeneralAsyncCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_General_t general,
+                                                  NEPI_EDGE_Async_Full_Policy_t full_policy);
 
 NEPI_EDGE_RET_t NEPI_EDGE_LBImportGeneral(NEPI_EDGE_LB_General_t general, const char* filename);
+NEPI_EDGE_RET_t NEPI_EDGE_LBImportGeneralCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_General_t general, const char* filename);
 NEPI_EDGE_RET_t NEPI_EDGE_LBImportAllGeneral(NEPI_EDGE_LB_General_t **general_array, size_t *count);
+NEPI_EDGE_RET_t NEPI_EDGE_LBImportAllGeneralCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_LB_General_t **general_array, size_t *count);
 NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralGetArrayEntry(NEPI_EDGE_LB_General_t *general_array, size_t index, NEPI_EDGE_LB_General_t **general_entry);
 NEPI_EDGE_RET_t NEPI_EDGE_LBGeneralGetParam(NEPI_EDGE_LB_General_t general, NEPI_EDGE_LB_Param_Id_Type_t *id_type, NEPI_EDGE_LB_Param_Id_t *id,
                                             NEPI_EDGE_LB_Param_Value_Type_t *value_type, NEPI_EDGE_LB_Param_Value_t *value);
@@ -22,17 +22,169 @@
 #define NEPI_EDGE_HB_EXEC_STAT_FILE_PATH      "log/hb_execution_status.json"
 #define NEPI_EDGE_SW_UPDATE_STAT_FILE_PATH    "log/sw_update_status.yaml"
 
+/* **************** Context API **************** */
+// A context owns everything tied to one bot installation: its base path and NUID, the bot process, the HB data
+// link, and export settings and sequencing. Every call with a Ctx suffix takes the context to operate on; the
+// same call without the suffix uses a built-in default context, so existing single-bot code is unaffected.
+// Separate contexts share no state and may be driven from different threads. Calls on one context that export
+// may run concurrently; bot control and path changes on one context should come from a single thread.
+typedef void* NEPI_EDGE_Context_t;
+NEPI_EDGE_RET_t NEPI_EDGE_ContextCreate(NEPI_EDGE_Context_t *context);
+// Publishes any exports still held back by group-commit. Flush async exports queued for this context first.
+// A resident bot is stopped with a 1 s grace period. A one-shot bot still running returns
+// NEPI_EDGE_RET_BOT_ALREADY_RUNNING and leaves the context as it was; wait on or stop it first. The default context
+// can't be destroyed.
+NEPI_EDGE_RET_t NEPI_EDGE_ContextDestroy(NEPI_EDGE_Context_t context);
+NEPI_EDGE_Context_t NEPI_EDGE_GetDefaultContext(void);
+
 NEPI_EDGE_RET_t NEPI_EDGE_SetBotBaseFilePath(const char* path);
+NEPI_EDGE_RET_t NEPI_EDGE_SetBotBaseFilePathCtx(NEPI_EDGE_Context_t context, const char* path);
 const char* NEPI_EDGE_GetBotBaseFilePath(void);
+const char* NEPI_EDGE_GetBotBaseFilePathCtx(NEPI_EDGE_Context_t context); // NULL for an invalid context
 const char* NEPI_EDGE_GetBotNUID(void);
+const char* NEPI_EDGE_GetBotNUIDCtx(NEPI_EDGE_Context_t context); // NULL for an invalid context
 
 /* **************** Exec Control API **************** */
+// Launches <bot base>/bin/botmain/botmain without copying the host process. Launch failures are reported here:
+// NEPI_EDGE_RET_INVALID_BOT_PATH when botmain can't be found, NEPI_EDGE_RET_CANT_START_BOT when it can't be executed.
 NEPI_EDGE_RET_t NEPI_EDGE_StartBot(uint8_t run_lb, uint32_t lb_timeout_s, uint8_t run_hb, uint32_t hb_timeout_s);
+NEPI_EDGE_RET_t NEPI_EDGE_StartBotCtx(NEPI_EDGE_Context_t context, uint8_t run_lb, uint32_t lb_timeout_s, uint8_t run_hb, uint32_t hb_timeout_s);
 // TODO?
 //NEPI_EDGE_RET_t NEPI_EDGE_StartBotScript(uint8_t run_lb, uint32_t lb_timeout_s, uint8_t run_hb, uint32_t hb_timeout_s)
 //NEPI_EDGE_RET_t NEPI_EDGE_StartBotContainer(uint8_t run_lb, uint32_t lb_timeout_s, uint8_t run_hb, uint32_t hb_timeout_s)
 NEPI_EDGE_RET_t NEPI_EDGE_CheckBotRunning(uint8_t *bot_running);
+NEPI_EDGE_RET_t NEPI_EDGE_CheckBotRunningCtx(NEPI_EDGE_Context_t context, uint8_t *bot_running);
 NEPI_EDGE_RET_t NEPI_EDGE_StopBot(uint8_t force_kill);
+NEPI_EDGE_RET_t NEPI_EDGE_StopBotCtx(NEPI_EDGE_Context_t context, uint8_t force_kill);
+// Blocks until the bot exits (and reaps it, as CheckBotRunning does), or NEPI_EDGE_RET_TIMED_OUT after timeout_ms.
+// A negative timeout waits indefinitely, 0 just checks. Returns NEPI_EDGE_RET_OK right away if no bot is running.
+// Exit is signaled through a descriptor, so there are no wakeups while the bot runs.
+NEPI_EDGE_RET_t NEPI_EDGE_WaitBot(int32_t timeout_ms);
+NEPI_EDGE_RET_t NEPI_EDGE_WaitBotCtx(NEPI_EDGE_Context_t context, int32_t timeout_ms);
+// A descriptor that becomes readable (POLLIN/EPOLLIN) when the running bot exits, for the host's own poll/epoll
+// loop; -1 when no bot is running (or for an invalid context). It belongs to the SDK and is closed when the bot is
+// reaped by CheckBotRunning, WaitBot or StopBotGraceful, so remove it from any epoll set before then. Without pidfd
+// support (Linux < 5.3) it is a pipe that the bot holds open, and that may close before the bot has exited;
+// always confirm with CheckBotRunning.
+int NEPI_EDGE_GetBotFd(void);
+int NEPI_EDGE_GetBotFdCtx(NEPI_EDGE_Context_t context);
+// SIGINT, then SIGKILL if the bot hasn't exited after grace_ms; returns once the bot has been reaped
+NEPI_EDGE_RET_t NEPI_EDGE_StopBotGraceful(uint32_t grace_ms);
+NEPI_EDGE_RET_t NEPI_EDGE_StopBotGracefulCtx(NEPI_EDGE_Context_t context, uint32_t grace_ms);
+
+/* **************** Bot Run Accounting **************** */
+// Each bot process is accounted for when the SDK reaps it: by CheckBotRunning, WaitBot or StopBotGraceful for a
+// one-shot bot, or by the supervisor as soon as a resident bot exits. The most recent
+// NEPI_EDGE_BOT_RUN_HISTORY_LENGTH are kept per context.
+#define NEPI_EDGE_BOT_RUN_HISTORY_LENGTH  16
+
+typedef enum NEPI_EDGE_Bot_Exit_Cause
+{
+  NEPI_EDGE_BOT_EXIT_CAUSE_EXITED    = 0, // exit_value is the exit status
+  NEPI_EDGE_BOT_EXIT_CAUSE_SIGNALED  = 1  // exit_value is the terminating signal, e.g., SIGINT from StopBot
+} NEPI_EDGE_Bot_Exit_Cause_t;
+
+typedef struct NEPI_EDGE_Bot_Run_Stats
+{
+  uint64_t start_time_ms; // Unix epoch
+  // From launch until reaped, so for a one-shot bot only as prompt as the host's CheckBotRunning polling;
+  // WaitBot and GetBotFd reap at exit.
+  uint64_t wall_time_ms;
+  NEPI_EDGE_Bot_Exit_Cause_t exit_cause;
+  int32_t exit_value;
+  uint8_t resident; // A resident bot's figures cover the whole process, i.e. all of the runs it served
+
+  // As for getrusage(): the bot's own usage plus that of any children it waited for
+  uint64_t user_cpu_us;
+  uint64_t system_cpu_us;
+  uint64_t max_rss_kb;
+  uint64_t block_input_ops;
+  uint64_t block_output_ops;
+} NEPI_EDGE_Bot_Run_Stats_t;
+
+// NEPI_EDGE_RET_PARAM_NOT_FOUND before any bot has been reaped
+NEPI_EDGE_RET_t NEPI_EDGE_GetBotLastRun(NEPI_EDGE_Bot_Run_Stats_t *run);
+NEPI_EDGE_RET_t NEPI_EDGE_GetBotLastRunCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Bot_Run_Stats_t *run);
+// Copies up to max_runs of the recorded runs, newest first, and sets run_count to the number copied
+NEPI_EDGE_RET_t NEPI_EDGE_GetBotRunHistory(NEPI_EDGE_Bot_Run_Stats_t *runs, uint32_t max_runs, uint32_t *run_count);
+NEPI_EDGE_RET_t NEPI_EDGE_GetBotRunHistoryCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Bot_Run_Stats_t *runs, uint32_t max_runs,
+                                              uint32_t *run_count);
+
+/* **************** Bot Process Isolation **************** */
+// Scheduling and resource attributes applied to the bot process before botmain starts, so its compression and
+// database work doesn't compete with the host's own threads. By default the bot inherits the host's.
+#define NEPI_EDGE_BOT_NICE_INHERIT  127
+
+typedef enum NEPI_EDGE_Bot_IO_Class
+{
+  NEPI_EDGE_BOT_IO_CLASS_INHERIT      = 0,
+  NEPI_EDGE_BOT_IO_CLASS_REALTIME     = 1, // Needs CAP_SYS_ADMIN
+  NEPI_EDGE_BOT_IO_CLASS_BEST_EFFORT  = 2,
+  NEPI_EDGE_BOT_IO_CLASS_IDLE         = 3
+} NEPI_EDGE_Bot_IO_Class_t;
+
+typedef struct NEPI_EDGE_Bot_Start_Options
+{
+  uint64_t cpu_affinity_mask; // Bit n allows CPU n; 0 keeps the host's affinity
+  int8_t nice; // -20 to 19, or NEPI_EDGE_BOT_NICE_INHERIT. Going below the host's nice level needs CAP_SYS_NICE
+  NEPI_EDGE_Bot_IO_Class_t io_class; // As for ioprio_set()
+  uint8_t io_level; // 0 (highest) to 7, for the REALTIME and BEST_EFFORT classes
+
+  // Optional cgroup v2 placement: an absolute path in the unified hierarchy (e.g., /sys/fs/cgroup/nepi_bot), created
+  // if missing. Empty for none. The limits below are written to it at each launch; the controllers they need are
+  // enabled in the parent's cgroup.subtree_control, so the host needs write access there.
+  char cgroup_path[NEPI_EDGE_MAX_FILE_PATH_LENGTH];
+  uint64_t cgroup_memory_max_bytes; // memory.max; 0 leaves it as is
+  uint32_t cgroup_cpu_max_percent; // cpu.max, in percent of one CPU (e.g., 150 is one and a half); 0 leaves it as is
+} NEPI_EDGE_Bot_Start_Options_t;
+
+// Fill in options that change nothing; set just the fields of interest afterwards
+NEPI_EDGE_RET_t NEPI_EDGE_BotStartOptionsInit(NEPI_EDGE_Bot_Start_Options_t *options);
+// Used for every later StartBot and StartBotResident, including resident relaunches; NULL returns to the defaults.
+// Out-of-range fields return NEPI_EDGE_RET_ARG_OUT_OF_RANGE. If an option can't be applied at launch (permissions,
+// CPUs that aren't online, no cgroup v2) the launch fails with NEPI_EDGE_RET_CANT_START_BOT rather than running the
+// bot unisolated.
+NEPI_EDGE_RET_t NEPI_EDGE_SetBotStartOptions(const NEPI_EDGE_Bot_Start_Options_t *options);
+NEPI_EDGE_RET_t NEPI_EDGE_SetBotStartOptionsCtx(NEPI_EDGE_Context_t context, const NEPI_EDGE_Bot_Start_Options_t *options);
+
+/* **************** Resident Bot API **************** */
+// Resident mode keeps one bot process alive across many runs, so a run doesn't pay for bot startup (config load,
+// database open, link init). It is an alternative to StartBot; the one-shot calls above don't apply to a resident
+// bot, and StartBot returns NEPI_EDGE_RET_BOT_ALREADY_RUNNING while one is in effect.
+//
+// The bot is launched from the same bin/botmain folder with an environment of just
+//   NEPI_BOT_RESIDENT=1
+//   NEPI_BOT_TRIGGER_FD=<n>   -- its end of an AF_UNIX SOCK_SEQPACKET socket pair
+// Each TriggerBotRun sends one packet of newline-terminated assignments, the ones a one-shot launch puts in the
+// environment:
+//   RUN_LB_LINK=<0|1>\nLB_PROC_TIMEOUT=<s>\nRUN_HB_LINK=<0|1>\nHB_PROC_TIMEOUT=<s>\n
+// and the bot replies with a packet starting "RUN_COMPLETE" when that run is finished. Other packets from the bot are
+// ignored. The bot should exit on SIGINT or when its end of the socket reports EOF.
+//
+// A supervisor thread relaunches the bot whenever it exits on its own, after a backoff that starts at
+// initial_backoff_ms and doubles up to max_backoff_ms. It gives up after max_restarts consecutive relaunches without
+// a completed run (a completed run resets both the count and the backoff). Defaults: 5, 500 ms, 30 s. The policy
+// takes effect at the next StartBotResident.
+NEPI_EDGE_RET_t NEPI_EDGE_SetBotRestartPolicy(uint32_t max_restarts, uint32_t initial_backoff_ms, uint32_t max_backoff_ms);
+NEPI_EDGE_RET_t NEPI_EDGE_SetBotRestartPolicyCtx(NEPI_EDGE_Context_t context, uint32_t max_restarts, uint32_t initial_backoff_ms,
+                                                 uint32_t max_backoff_ms);
+// Launch failures are reported as for StartBot
+NEPI_EDGE_RET_t NEPI_EDGE_StartBotResident(void);
+NEPI_EDGE_RET_t NEPI_EDGE_StartBotResidentCtx(NEPI_EDGE_Context_t context);
+// Returns as soon as the trigger is sent. NEPI_EDGE_RET_BOT_ALREADY_RUNNING while the previous run is still going,
+// NEPI_EDGE_RET_BOT_NOT_RUNNING while the bot is down between relaunches (or the supervisor has given up).
+NEPI_EDGE_RET_t NEPI_EDGE_TriggerBotRun(uint8_t run_lb, uint32_t lb_timeout_s, uint8_t run_hb, uint32_t hb_timeout_s);
+NEPI_EDGE_RET_t NEPI_EDGE_TriggerBotRunCtx(NEPI_EDGE_Context_t context, uint8_t run_lb, uint32_t lb_timeout_s, uint8_t run_hb, uint32_t hb_timeout_s);
+// Waits for the last triggered run: NEPI_EDGE_RET_OK once complete, NEPI_EDGE_RET_BOT_EXEC_UNDETERMINED if the bot
+// exited first, NEPI_EDGE_RET_TIMED_OUT after timeout_ms (negative waits indefinitely), NEPI_EDGE_RET_BOT_NOT_RUNNING
+// if nothing has been triggered.
+NEPI_EDGE_RET_t NEPI_EDGE_WaitBotRun(int32_t timeout_ms);
+NEPI_EDGE_RET_t NEPI_EDGE_WaitBotRunCtx(NEPI_EDGE_Context_t context, int32_t timeout_ms);
+// SIGINT, then SIGKILL after grace_ms, and stop supervising. Needed to clean up even after the supervisor gives up.
+// Safe to call while other threads trigger or wait on the same bot; a pending WaitBotRun returns
+// NEPI_EDGE_RET_BOT_EXEC_UNDETERMINED.
+NEPI_EDGE_RET_t NEPI_EDGE_StopBotResident(uint32_t grace_ms);
+NEPI_EDGE_RET_t NEPI_EDGE_StopBotResidentCtx(NEPI_EDGE_Context_t context, uint32_t grace_ms);
 
 /* **************** Exec Status API **************** */
 typedef enum NEPI_EDGE_COMMS_STATUS
@@ -51,13 +203,82 @@ typedef enum NEPI_EDGE_HB_DIRECTION
   NEPI_EDGE_HB_DIRECTION_UNKNOWN = 2
 } NEPI_EDGE_HB_DIRECTION_t;
 
+// Connection entries past these are dropped on import
+#define NEPI_EDGE_MAX_LB_CONNECTIONS_PER_EXEC  32
+#define NEPI_EDGE_MAX_HB_CONNECTIONS_PER_EXEC  32
+
+// Connection entries as filled in by NEPI_EDGE_ExecStatusGetConnections, common parts first. Strings are NULL if the bot didn't report
+// them, and like those returned by the individual getters stay valid until the next import into or destroy of the
+// exec status they came from, or a refresh that updates their part.
+typedef struct
+{
+  const char *comms_type;
+  NEPI_EDGE_COMMS_STATUS_t status;
+  const char *start_time_rfc3339;
+  const char *stop_time_rfc3339;
+  size_t warning_count;
+  const char *const *warnings;
+  size_t error_count;
+  const char *const *errors;
+} NEPI_EDGE_Exec_Status_Connection_Common_t;
+
+typedef struct
+{
+  NEPI_EDGE_Exec_Status_Connection_Common_t common;
+  size_t msgs_sent;
+  size_t pkts_sent;
+  size_t msgs_rcvd;
+  // Breakdown of msgs_sent and msgs_rcvd by type
+  size_t stat_msgs_sent;
+  size_t data_msgs_sent;
+  size_t gen_msgs_sent;
+  size_t cfg_msgs_rcvd;
+  size_t gen_msgs_rcvd;
+} NEPI_EDGE_Exec_Status_LB_Connection_t;
+
+typedef struct
+{
+  NEPI_EDGE_Exec_Status_Connection_Common_t common;
+  NEPI_EDGE_HB_DIRECTION_t direction;
+  size_t datasent_kB;
+  size_t datareceived_kB;
+  size_t num_dirs;
+  size_t num_files;
+} NEPI_EDGE_Exec_Status_HB_Connection_t;
+
+// Parts of an exec status, as reported by NEPI_EDGE_RefreshExecStatus
+typedef enum NEPI_EDGE_EXEC_STATUS_PART
+{
+  NEPI_EDGE_EXEC_STATUS_PART_LB        = (1u << 0),
+  NEPI_EDGE_EXEC_STATUS_PART_HB        = (1u << 1),
+  NEPI_EDGE_EXEC_STATUS_PART_SW_UPDATE = (1u << 2)
+} NEPI_EDGE_EXEC_STATUS_PART_t;
+
 typedef void* NEPI_EDGE_Exec_Status_t;
 NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusCreate(NEPI_EDGE_Exec_Status_t *exec_status);
 NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusDestroy(NEPI_EDGE_Exec_Status_t exec_status);
 
+// Rereads every status file. A file that isn't complete JSON (e.g., caught mid-write) leaves its part empty and returns
+// NEPI_EDGE_RET_INVALID_FILE_FORMAT; the other parts are still read.
 NEPI_EDGE_RET_t NEPI_EDGE_ImportExecStatus(NEPI_EDGE_Exec_Status_t exec_status);
+NEPI_EDGE_RET_t NEPI_EDGE_ImportExecStatusCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Exec_Status_t exec_status);
+// Like NEPI_EDGE_ImportExecStatus, but only rereads the status files whose inode, size or mtime changed since this
+// exec status last read them, so it is cheap enough to poll. updated_parts is set to the NEPI_EDGE_EXEC_STATUS_PART_t
+// bits of whatever was reread or cleared; the rest, including strings already handed out from it, is untouched. A file
+// that isn't complete JSON is handled as for NEPI_EDGE_ImportExecStatus, still reported in updated_parts, and is reread
+// next time.
+NEPI_EDGE_RET_t NEPI_EDGE_RefreshExecStatus(NEPI_EDGE_Exec_Status_t exec_status, uint32_t *updated_parts);
+NEPI_EDGE_RET_t NEPI_EDGE_RefreshExecStatusCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Exec_Status_t exec_status,
+                                               uint32_t *updated_parts);
 NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetCounts(NEPI_EDGE_Exec_Status_t exec_status, size_t *lb_counts, size_t *hb_counts);
 NEPI_EDGE_RET_t NEPI_EDGE_SoftwareWasUpdated(NEPI_EDGE_Exec_Status_t exec_status, uint8_t *software_was_updated);
+// Everything the individual getters below report, for up to max_lb_conns/max_hb_conns entries in one call. The counts
+// are the number of entries filled in; either array may be NULL with a zero max.
+NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetConnections(NEPI_EDGE_Exec_Status_t exec_status,
+                                                   NEPI_EDGE_Exec_Status_LB_Connection_t *lb_conns, size_t max_lb_conns,
+                                                   size_t *lb_count,
+                                                   NEPI_EDGE_Exec_Status_HB_Connection_t *hb_conns, size_t max_hb_conns,
+                                                   size_t *hb_count);
 
 NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetLBCommsType(NEPI_EDGE_Exec_Status_t exec_status, size_t lb_index, char **comms_type);
 NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetLBCommsStatus(NEPI_EDGE_Exec_Status_t exec_status, size_t lb_index, NEPI_EDGE_COMMS_STATUS_t *comms_status);
@@ -76,4 +297,216 @@ NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetHBCommsGetError(NEPI_EDGE_Exec_Status_t e
 NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetHBCommsDirection(NEPI_EDGE_Exec_Status_t exec_status, size_t hb_index, NEPI_EDGE_HB_DIRECTION_t *direction);
 NEPI_EDGE_RET_t NEPI_EDGE_ExecStatusGetHBCommsStatistics(NEPI_EDGE_Exec_Status_t exec_status, size_t hb_index, size_t *datasent_kB, size_t *datareceived_kB);
 
+/* **************** Exec History API **************** */
+// A bounded record of the runs reported by exec status for each link (LB or HB comms_type), with throughput and
+// reliability aggregates to size timeouts and payloads from. Optionally persisted so it survives restarts.
+#define NEPI_EDGE_EXEC_HISTORY_MAX_LINKS     16 // Runs for further links aren't recorded
+#define NEPI_EDGE_EXEC_HISTORY_LENGTH        32 // Runs kept per link
+#define NEPI_EDGE_EXEC_HISTORY_EVENT_LENGTH  32
+#define NEPI_EDGE_MAX_COMMS_TYPE_LENGTH      32 // Including the terminator; runs of longer comms_types aren't recorded
+
+typedef enum NEPI_EDGE_LINK_TYPE
+{
+  NEPI_EDGE_LINK_TYPE_LB = 0,
+  NEPI_EDGE_LINK_TYPE_HB = 1
+} NEPI_EDGE_LINK_TYPE_t;
+
+// As of the link's latest run that was attempted, i.e., succeeded or failed to connect
+typedef enum NEPI_EDGE_LINK_STATE
+{
+  NEPI_EDGE_LINK_STATE_UNKNOWN = 0,
+  NEPI_EDGE_LINK_STATE_UP      = 1,
+  NEPI_EDGE_LINK_STATE_DOWN    = 2
+} NEPI_EDGE_LINK_STATE_t;
+
+// One connection entry of a recorded exec status. Counts the bot didn't report are 0.
+typedef struct
+{
+  uint64_t seq; // Order recorded, across all links
+  uint8_t has_times; // Whether timestart/timestop were both reported and parsed, so the two below are meaningful
+  int64_t start_time_ms; // Unix epoch
+  uint32_t duration_ms;
+  NEPI_EDGE_COMMS_STATUS_t status;
+  uint32_t warning_count;
+  uint32_t error_count;
+
+  // LB only
+  uint32_t msgs_sent;
+  uint32_t pkts_sent;
+  uint32_t msgs_rcvd;
+  uint32_t stat_msgs_sent;
+  uint32_t data_msgs_sent;
+  uint32_t gen_msgs_sent;
+  uint32_t cfg_msgs_rcvd;
+  uint32_t gen_msgs_rcvd;
+
+  // HB only
+  NEPI_EDGE_HB_DIRECTION_t direction;
+  uint32_t datasent_kB;
+  uint32_t datareceived_kB;
+  uint32_t num_dirs;
+  uint32_t num_files;
+} NEPI_EDGE_Exec_History_Run_t;
+
+// Aggregates over the runs a link has in the history. Rates and durations cover only successful runs with times,
+// since those are the sessions that actually moved data.
+typedef struct
+{
+  NEPI_EDGE_LINK_TYPE_t link_type;
+  char comms_type[NEPI_EDGE_MAX_COMMS_TYPE_LENGTH];
+  NEPI_EDGE_LINK_STATE_t state;
+
+  uint32_t run_count;
+  uint32_t attempt_count; // Runs that succeeded or failed to connect, as opposed to disabled or unknown
+  uint32_t success_count;
+  float success_ratio; // success_count / attempt_count, 0 with no attempts
+
+  uint32_t timed_run_count;
+  uint64_t total_duration_ms;
+  uint32_t duration_percentile_ms; // At the percentile requested of NEPI_EDGE_ExecHistoryGetLinkStats, nearest rank
+  uint32_t max_duration_ms;
+
+  double bytes_per_s; // HB: (datasent_kB + datareceived_kB) * 1024 per second of session. 0 for LB, which reports no sizes.
+  double pkts_per_s; // LB: pkts_sent per second of session
+  double msgs_per_s; // LB: msgs_sent + msgs_rcvd per second of session
+} NEPI_EDGE_Exec_History_Link_Stats_t;
+
+// A link going up or down. The first state seen for a link isn't a transition, so raises no event.
+typedef struct
+{
+  uint64_t seq; // One more than the previous event's, so pollers can tell which they've seen
+  NEPI_EDGE_LINK_TYPE_t link_type;
+  char comms_type[NEPI_EDGE_MAX_COMMS_TYPE_LENGTH];
+  NEPI_EDGE_LINK_STATE_t state; // The new state
+  int64_t time_ms; // Start of the run that showed it, Unix epoch; 0 if that run had no times
+} NEPI_EDGE_Exec_History_Event_t;
+
+typedef void* NEPI_EDGE_Exec_History_t;
+// persist_path NULL for a history that lives only in memory. Otherwise runs recorded there before are loaded (events
+// aren't kept) and each record rewrites the file. NEPI_EDGE_RET_INVALID_FILE_FORMAT if it exists but can't be read.
+NEPI_EDGE_RET_t NEPI_EDGE_ExecHistoryCreate(NEPI_EDGE_Exec_History_t *history, const char *persist_path);
+NEPI_EDGE_RET_t NEPI_EDGE_ExecHistoryDestroy(NEPI_EDGE_Exec_History_t history);
+// Adds each connection entry of the LB and HB parts of exec_status, as last imported or refreshed. A part read from
+// the same status file contents as one already recorded is skipped, so recording after every poll counts each bot
+// run once.
+NEPI_EDGE_RET_t NEPI_EDGE_ExecHistoryRecord(NEPI_EDGE_Exec_History_t history, NEPI_EDGE_Exec_Status_t exec_status);
+// percentile is 0-100 and selects duration_percentile_ms. Fills up to max_links entries, in the order links were
+// first seen.
+NEPI_EDGE_RET_t NEPI_EDGE_ExecHistoryGetLinkStats(NEPI_EDGE_Exec_History_t history, uint8_t percentile,
+                                                  NEPI_EDGE_Exec_History_Link_Stats_t *stats, size_t max_links,
+                                                  size_t *link_count);
+// Newest first. NEPI_EDGE_RET_PARAM_NOT_FOUND if the link has no runs recorded.
+NEPI_EDGE_RET_t NEPI_EDGE_ExecHistoryGetRuns(NEPI_EDGE_Exec_History_t history, NEPI_EDGE_LINK_TYPE_t link_type,
+                                             const char *comms_type, NEPI_EDGE_Exec_History_Run_t *runs, size_t max_runs,
+                                             size_t *run_count);
+// Newest first
+NEPI_EDGE_RET_t NEPI_EDGE_ExecHistoryGetEvents(NEPI_EDGE_Exec_History_t history, NEPI_EDGE_Exec_History_Event_t *events,
+                                               size_t max_events, size_t *event_count);
+
+/* **************** Bot Config API **************** */
+// A typed snapshot of the bot's cfg/bot/config.json, parsed once and again only when the file changes (inode, size or
+// mtime). A snapshot is immutable; it stays valid from Acquire to Release, whatever reloads happen meanwhile.
+// Settings the file leaves out are 0.
+#define NEPI_EDGE_BOT_CONFIG_MAX_LINKS        16 // Per conn order; further links are left out
+#define NEPI_EDGE_BOT_CONFIG_MAX_TYPE_LENGTH  16
+
+typedef struct
+{
+  float scor_wt;
+  float qual_wt;
+  float size_wt;
+  float time_wt;
+  float trig_wt;
+  float purge_rating;
+} NEPI_EDGE_Bot_Config_Pipo_t;
+
+typedef struct
+{
+  char name[NEPI_EDGE_MAX_COMMS_TYPE_LENGTH]; // As in the conn order and exec status comms_type, e.g., lb_iridium
+  char type[NEPI_EDGE_BOT_CONFIG_MAX_TYPE_LENGTH]; // e.g., iridium, ethernet
+  uint8_t enabled; // 0 also for a link the conn order names but the file has no settings for, which the bot skips
+  uint32_t tout_s;
+  uint32_t open_attm;
+  uint32_t open_tout_s;
+  uint32_t max_msg_size;
+  uint32_t packet_size;
+  NEPI_EDGE_Bot_Config_Pipo_t pipo; // LB: each the link's own if it sets it, else the top-level one
+} NEPI_EDGE_Bot_Config_Link_t;
+
+typedef struct
+{
+  uint8_t data_zlib;
+  uint8_t data_msgpack;
+  uint8_t lb_encrypted;
+  uint32_t fs_pct_used_warning;
+  NEPI_EDGE_Bot_Config_Pipo_t pipo;
+
+  // In lb_conn_order/hb_conn_order
+  NEPI_EDGE_Bot_Config_Link_t lb_links[NEPI_EDGE_BOT_CONFIG_MAX_LINKS];
+  size_t lb_link_count;
+  NEPI_EDGE_Bot_Config_Link_t hb_links[NEPI_EDGE_BOT_CONFIG_MAX_LINKS];
+  size_t hb_link_count;
+} NEPI_EDGE_Bot_Config_t;
+
+// Each acquired snapshot must be released. Returns the file open/format errors if the file can't be read; a snapshot
+// acquired earlier is unaffected.
+NEPI_EDGE_RET_t NEPI_EDGE_AcquireBotConfig(const NEPI_EDGE_Bot_Config_t **config);
+NEPI_EDGE_RET_t NEPI_EDGE_AcquireBotConfigCtx(NEPI_EDGE_Context_t context, const NEPI_EDGE_Bot_Config_t **config);
+NEPI_EDGE_RET_t NEPI_EDGE_ReleaseBotConfig(const NEPI_EDGE_Bot_Config_t *config);
+// NEPI_EDGE_RET_PARAM_NOT_FOUND if the link isn't in the conn order
+NEPI_EDGE_RET_t NEPI_EDGE_BotConfigGetLink(const NEPI_EDGE_Bot_Config_t *config, NEPI_EDGE_LINK_TYPE_t link_type,
+                                           const char *name, const NEPI_EDGE_Bot_Config_Link_t **link);
+
+/* **************** Bot Run Advisor API **************** */
+// Sizes StartBot timeouts from what is waiting to go out and what an exec history says the links carry.
+//
+// Each side (LB, HB) is advised for one link: the first enabled one in lb_conn_order/hb_conn_order of
+// cfg/bot/config.json that has a rate in the history and wasn't down as of its latest run, or failing that the first
+// with a rate at all. The enabled links ahead of it are assumed to fail first, each costing open_attm * open_tout
+// seconds, and the link itself open_tout to connect. LB bytes/second is the history's pkts_per_s times the payload of
+// a packet of a max_msg_size message; HB's is the history's bytes_per_s.
+//
+// The backlog is the size of the files under lb/data and lb/do-msg (LB) and hb/do/data (HB), as exported. The bot
+// compresses LB data before sending, so LB estimates err long.
+//
+// Every estimate is for a run in which the link connects. A run that fails to connect sends nothing however long its
+// timeout, so a link's success ratio is left for the caller to weigh, e.g., in how often to start the bot.
+typedef struct
+{
+  uint8_t estimated; // 0 if no enabled link has a rate in the history yet; then only the backlog fields are set
+  char comms_type[NEPI_EDGE_MAX_COMMS_TYPE_LENGTH]; // The link advised for
+  float success_ratio; // Of that link, from the history. Reported only; it doesn't change the timeouts or budget
+  double bytes_per_s;
+  uint32_t overhead_s; // Failing over to and connecting the link
+
+  uint64_t backlog_bytes;
+  uint32_t backlog_files;
+
+  uint32_t timeout_s;
+  uint8_t backlog_fits; // Whether the whole backlog is expected to go out within timeout_s
+  uint64_t budget_bytes; // Expected to go out within timeout_s
+} NEPI_EDGE_Link_Run_Advice_t;
+
+typedef struct
+{
+  NEPI_EDGE_Link_Run_Advice_t lb;
+  NEPI_EDGE_Link_Run_Advice_t hb;
+} NEPI_EDGE_Bot_Run_Advice_t;
+
+// Recommends the timeout for sending each side's whole backlog, with headroom_pct percent extra transfer time, but no
+// more than max_timeout_s (0 for no limit); backlog_fits is 0 where that cap cut it short.
+NEPI_EDGE_RET_t NEPI_EDGE_AdviseBotTimeouts(NEPI_EDGE_Exec_History_t history, uint8_t headroom_pct,
+                                            uint32_t max_timeout_s, NEPI_EDGE_Bot_Run_Advice_t *advice);
+NEPI_EDGE_RET_t NEPI_EDGE_AdviseBotTimeoutsCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Exec_History_t history,
+                                               uint8_t headroom_pct, uint32_t max_timeout_s,
+                                               NEPI_EDGE_Bot_Run_Advice_t *advice);
+// The other way around: how many bytes of export each side is expected to get out within the given timeouts, keeping
+// headroom_pct percent of the transfer time spare. timeout_s is set to the one given.
+NEPI_EDGE_RET_t NEPI_EDGE_AdviseExportBudget(NEPI_EDGE_Exec_History_t history, uint8_t headroom_pct,
+                                             uint32_t lb_timeout_s, uint32_t hb_timeout_s,
+                                             NEPI_EDGE_Bot_Run_Advice_t *advice);
+NEPI_EDGE_RET_t NEPI_EDGE_AdviseExportBudgetCtx(NEPI_EDGE_Context_t context, NEPI_EDGE_Exec_History_t history,
+                                                uint8_t headroom_pct, uint32_t lb_timeout_s, uint32_t hb_timeout_s,
+                                                NEPI_EDGE_Bot_Run_Advice_t *advice);
+
 #endif //__NEPI_EDGE_SDK_H